@@ -25,12 +25,141 @@
 #include <stddef.h>     // various variable types and macros: size_t, offsetof, NULL, ...
 #include <string.h>     // string operation: memset, memcpy
 #include <strings.h>    // strcasecmp
+#include <ctype.h>      // tolower, isxdigit
+#include <fcntl.h>      // open
+#include <unistd.h>     // close, ftruncate, pread
+#include <sys/mman.h>   // mmap, msync, munmap
+#include <sys/stat.h>   // fstat
+#include <time.h>       // clock_gettime
+#include <pthread.h>    // trace flush thread
+#include <stdatomic.h>  // trace ring buffer positions
+#if defined(__SSE2__)
+    #include <emmintrin.h>  // SSE2 intrinsics
+#endif
 /* Self */
 #include "spi_flash_model.h"    // function prototypes
 #include "spi_flash_types.h"    // supported spi flashes
 
 
 
+/** Longest .dif line: 8 address digits, colon, 16 data bytes, new line **/
+#define SFM_DIF_LINE_MAX    64
+
+/** Gather buffer of #sfm_iov, holds instruction, address and short status/id responses **/
+#define SFM_IOV_HDR         16
+
+/** Longest wait of trace flush thread until partially filled ring buffer is written **/
+#define SFM_TRACE_FLUSH_MS  100
+
+/** Forced inlining, part descriptor of #SFM_PARTS entry points is folded into the caller **/
+#if defined(__GNUC__)
+    #define SFM_INLINE      inline __attribute__((always_inline))
+#else
+    #define SFM_INLINE      inline
+#endif
+
+
+
+/** Instruction handler index, @see #t_sfm_desc::uint8IstHdl **/
+enum {
+    SFM_HDL_UNKNOWN = 0,    /**<  not supported instruction */
+    SFM_HDL_RD_ID,          /**<  Read Manufacturer / Device ID */
+    SFM_HDL_WR_ENA,         /**<  Write Enable */
+    SFM_HDL_WR_DIS,         /**<  Write Disable */
+    SFM_HDL_ERASE_BULK,     /**<  Chip Erase */
+    SFM_HDL_ERASE_SECTOR,   /**<  Sector Erase */
+    SFM_HDL_RD_STATE_REG,   /**<  Read Status Register */
+    SFM_HDL_RD_DATA,        /**<  Read Data, first read variant */
+    SFM_HDL_RD_FAST,        /**<  Fast Read */
+    SFM_HDL_RD_DUAL_OUT,    /**<  Fast Read Dual Output */
+    SFM_HDL_RD_QUAD_OUT,    /**<  Fast Read Quad Output */
+    SFM_HDL_RD_QUAD_IO,     /**<  Fast Read Quad I/O */
+    SFM_HDL_RD_DATA_4B,     /**<  Read Data with 4-Byte Address, last read variant */
+    SFM_HDL_WR_PAGE,        /**<  Page Program */
+    SFM_HDL_WR_PAGE_4B,     /**<  Page Program with 4-Byte Address, last instruction with data phase */
+    SFM_HDL_ERASE_SECTOR_4B,/**<  Sector Erase with 4-Byte Address */
+    SFM_HDL_ERASE_BLOCK,    /**<  Block Erase */
+    SFM_HDL_ERASE_BLOCK_4B, /**<  Block Erase with 4-Byte Address */
+    SFM_HDL_ADR_4B_ENTER,   /**<  Enter 4-Byte Address Mode */
+    SFM_HDL_ADR_4B_EXIT,    /**<  Exit 4-Byte Address Mode */
+    SFM_HDL_NUM             /**<  Number of handlers */
+};
+
+/** Address bytes of 4-Byte Address instructions and mode **/
+#define SFM_ADR_4B  (4)
+
+/** Numeric columns of catalog file, order of #t_sfm_type after name and ID, @see #sfm_catalog_load **/
+enum {
+    SFM_CAT_RD_ID,            /**<  Read ID */
+    SFM_CAT_WR_ENA,           /**<  Write Enable */
+    SFM_CAT_WR_DIS,           /**<  Write Disable */
+    SFM_CAT_ERASE_BULK,       /**<  Chip Erase */
+    SFM_CAT_ERASE_SECTOR,     /**<  Sector Erase */
+    SFM_CAT_RD_SR,            /**<  Read Status Register */
+    SFM_CAT_RD_DATA,          /**<  Read Data */
+    SFM_CAT_WR_PAGE,          /**<  Page Program */
+    SFM_CAT_RD_FAST,          /**<  Fast Read */
+    SFM_CAT_RD_DUAL_OUT,      /**<  Fast Read Dual Output */
+    SFM_CAT_RD_QUAD_OUT,      /**<  Fast Read Quad Output */
+    SFM_CAT_RD_QUAD_IO,       /**<  Fast Read Quad I/O */
+    SFM_CAT_ERASE_BLOCK,      /**<  Block Erase */
+    SFM_CAT_ADR_4B_ENTER,     /**<  Enter 4-Byte Address Mode */
+    SFM_CAT_ADR_4B_EXIT,      /**<  Exit 4-Byte Address Mode */
+    SFM_CAT_RD_DATA_4B,       /**<  Read Data with 4-Byte Address */
+    SFM_CAT_WR_PAGE_4B,       /**<  Page Program with 4-Byte Address */
+    SFM_CAT_ERASE_SECTOR_4B,  /**<  Sector Erase with 4-Byte Address */
+    SFM_CAT_ERASE_BLOCK_4B,   /**<  Block Erase with 4-Byte Address */
+    SFM_CAT_ADR_BYTES,        /**<  address bytes after power up */
+    SFM_CAT_SECTOR_SIZE,      /**<  sector size */
+    SFM_CAT_BLOCK_SIZE,       /**<  block size */
+    SFM_CAT_PAGE_SIZE,        /**<  page size */
+    SFM_CAT_TOTAL_SIZE,       /**<  total size */
+    SFM_CAT_RD_ID_DUMMY,      /**<  Read ID dummy bytes */
+    SFM_CAT_RD_FAST_DUMMY,    /**<  Fast/Dual/Quad Output Read dummy clocks */
+    SFM_CAT_RD_QUAD_IO_DUMMY, /**<  Quad I/O Read dummy clocks */
+    SFM_CAT_WIP_MSK,          /**<  WIP mask */
+    SFM_CAT_WR_ENA_MSK,       /**<  WEL mask */
+    SFM_CAT_T_PP,             /**<  tPP */
+    SFM_CAT_T_SE,             /**<  tSE */
+    SFM_CAT_T_BE,             /**<  tBE */
+    SFM_CAT_T_CE,             /**<  tCE */
+    SFM_CAT_NUM               /**<  Number of numeric columns */
+};
+
+
+
+/** SPI lanes per instruction phase as log2, f.e. 1-1-4: {0, 0, 2} **/
+typedef struct {
+    uint8_t     uint8Ist;   /**<  instruction lanes, log2 */
+    uint8_t     uint8Adr;   /**<  address and dummy lanes, log2 */
+    uint8_t     uint8Dat;   /**<  data lanes, log2 */
+} t_sfm_lanes;
+
+/** Lane usage of instruction handler, indexed by #t_sfm_desc::uint8IstHdl **/
+static const t_sfm_lanes SFM_HDL_LANES[SFM_HDL_NUM] = {
+    {0, 0, 0},  // SFM_HDL_UNKNOWN,         1-1-1
+    {0, 0, 0},  // SFM_HDL_RD_ID,           1-1-1
+    {0, 0, 0},  // SFM_HDL_WR_ENA,          1-1-1
+    {0, 0, 0},  // SFM_HDL_WR_DIS,          1-1-1
+    {0, 0, 0},  // SFM_HDL_ERASE_BULK,      1-1-1
+    {0, 0, 0},  // SFM_HDL_ERASE_SECTOR,    1-1-1
+    {0, 0, 0},  // SFM_HDL_RD_STATE_REG,    1-1-1
+    {0, 0, 0},  // SFM_HDL_RD_DATA,         1-1-1
+    {0, 0, 0},  // SFM_HDL_RD_FAST,         1-1-1
+    {0, 0, 1},  // SFM_HDL_RD_DUAL_OUT,     1-1-2
+    {0, 0, 2},  // SFM_HDL_RD_QUAD_OUT,     1-1-4
+    {0, 2, 2},  // SFM_HDL_RD_QUAD_IO,      1-4-4
+    {0, 0, 0},  // SFM_HDL_RD_DATA_4B,      1-1-1
+    {0, 0, 0},  // SFM_HDL_WR_PAGE,         1-1-1
+    {0, 0, 0},  // SFM_HDL_WR_PAGE_4B,      1-1-1
+    {0, 0, 0},  // SFM_HDL_ERASE_SECTOR_4B, 1-1-1
+    {0, 0, 0},  // SFM_HDL_ERASE_BLOCK,     1-1-1
+    {0, 0, 0},  // SFM_HDL_ERASE_BLOCK_4B,  1-1-1
+    {0, 0, 0},  // SFM_HDL_ADR_4B_ENTER,    1-1-1
+    {0, 0, 0}   // SFM_HDL_ADR_4B_EXIT,     1-1-1
+};
+
+
 
 /** @brief sfm_asciihex_to_uint8
  *
@@ -51,8 +180,8 @@ static int sfm_asciihex_to_uint8 (const char asciiHex[], uint8_t* vals, uint32_t
     char    hexByte[3];
     int     val;
 
-    /* get length of converted string */
-    if ( strlen(asciiHex) > max ) {
+    /* get length of converted string, two digits per byte */
+    if ( (strlen(asciiHex) + 1) / 2 > max ) {
         printf("  ERROR:%s: not enough memory\n", __FUNCTION__);
         return SFM_E_MALLOC;
     }
@@ -87,842 +216,5525 @@ static uint32_t sfm_spi_to_adr (uint8_t* vals, uint8_t len)
     /* convert to address */
     adr = 0;
     for ( uint8_t i = 0; i < len; i++ ) {
-        adr |= (uint32_t) (vals[i] << (len - i - 1) * 8);
+        adr |= (uint32_t) vals[i] << (len - i - 1) * 8;
     }
     return adr;
 }
 
 
 
-/** @brief sfm_adr_digits
+/** @brief min
  *
- *  determine number of digits for full address
+ *  return smaller number
  *
- *  @param[in]      adr             spi flash address
- *  @return         uint8_t         number of digits in asciihex converted address
+ *  @param[in]      val1            comparison value 1
+ *  @param[in]      val2            comparison value 2
+ *  @return         uint32_t        bigger number of both inputs
  *
  */
-static uint8_t sfm_adr_digits (uint32_t adr)
+static uint32_t sfm_min_uint32 (uint32_t val1, uint32_t val2)
 {
-    /** variables **/
-    char charHexAdr[10];    // adr converted to hexadecimal address
+    if ( val1 < val2 ) {
+        return val1;
+    }
+    return val2;
+}
 
-    /* determine number of digits for hex address */
-    charHexAdr[0] = '\0';   // empty string
-    snprintf( charHexAdr, sizeof(charHexAdr)/sizeof(charHexAdr[0]), "%x", adr );
-    return ((uint8_t) strlen(charHexAdr));  // zero padding at lower addresses
+
+
+/** @brief subtract
+ *
+ *  overflow save subtraction
+ *
+ *  @param[in]      minuend         value from which something is removed
+ *  @param[in]      subtrahend      the value of subtraction
+ *  @return         uint32_t        saturated difference of 'minuend - subtrahend'
+ *
+ */
+static uint32_t sfm_subtract_uint32 (uint32_t minuend, uint32_t subtrahend)
+{
+    /* underflow */
+    if ( subtrahend > minuend ) {
+        return (uint32_t) 0;
+    }
+    /* subtract */
+    return (uint32_t) (minuend - subtrahend);
 }
 
 
 
-/** @brief sfm_write_dif
+/** @brief sfm_cmp_scan
  *
- *  write buffer to file in dif format, differences to 0xff default are in 16 bytes lines written out
+ *  finds first byte position where buffers differ or match, compares 16 bytes per step
  *
- *  @param[in]      *buf            buffer to write out
- *  @param[in]      len             number of elements in buffer
- *  @param[in]      fileName[]      file name to file
- *  @return         int             state
- *  @retval         #SFM_OK         OKAY; @see #SFM_E
- *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *  @param[in]      *is             is buffer, NULL: empty flash 0xff
+ *  @param[in]      *exp            expected buffer
+ *  @param[in]      len             number of bytes
+ *  @param[in]      diff            1: search first mismatch, 0: search first match
+ *  @return         uint32_t        index of found position, len: not found
  *
  */
-static int sfm_write_dif (uint8_t *buf, uint32_t len, char fileName[])
+static uint32_t sfm_cmp_scan (const uint8_t *is, const uint8_t *exp, uint32_t len, int diff)
 {
     /** Variables **/
-    char        line[128];          // buffer line
-    char        charHex[5];         // hex digit
-    uint32_t    i, j;               // iterator
-    FILE*       fp;                 // file pointer
-    uint8_t     uint8AdrDigits;     // number of address digits
+    uint32_t    i = 0;  // iterator
 
-    /* determine number of hex digits for full address */
-    uint8AdrDigits = sfm_adr_digits( len );
-    if (uint8AdrDigits > 8) {   // limit size according to uint32_t for len
-        uint8AdrDigits = 8;
-    }
-    /* open file for write */
-    fp = fopen(fileName, "w+");
-    if ( NULL == fp ) {
-        return SFM_E_ACCESS;    // failed to open for write
+#if defined(__SSE2__)
+    const __m128i   empty = _mm_set1_epi8((char) 0xff); // erased flash
+    __m128i         vecIs;                              // is block
+    int             intEqMsk;                           // bytewise equal mask
+
+    for ( ; i + 16 <= len; i += 16 ) {
+        vecIs = (NULL == is) ? empty : _mm_loadu_si128((const __m128i*) (is + i));
+        intEqMsk = _mm_movemask_epi8(_mm_cmpeq_epi8(vecIs, _mm_loadu_si128((const __m128i*) (exp + i))));
+        if ( (0 != diff) ? (0xffff != intEqMsk) : (0 != intEqMsk) ) {
+            break;  // position in this block
+        }
     }
-    /* iterate over array in multiples of 16 */
-    for ( i = 0; i < len; i += 16 ) {
-        /* data write out required? */
-        for ( j = 0; j < 16; j++ ) {    // check for non empty fields
-            if ( 0xff != buf[i+j] ) {
-                break;  // write out data line
-            }
+#else
+    uint64_t    uint64Is[2];    // is block
+    uint64_t    uint64Exp[2];   // expected block
+    uint64_t    uint64Xor;      // differing bits
+
+    for ( ; i + 16 <= len; i += 16 ) {
+        if ( NULL == is ) {
+            uint64Is[0] = UINT64_MAX;
+            uint64Is[1] = UINT64_MAX;
+        } else {
+            memcpy(uint64Is, is + i, sizeof(uint64Is));
         }
-        if ( j >= 16 ) {
-            continue;   // go one with next 16 data bytes
+        memcpy(uint64Exp, exp + i, sizeof(uint64Exp));
+        if ( 0 != diff ) {
+            if ( (uint64Is[0] != uint64Exp[0]) || (uint64Is[1] != uint64Exp[1]) ) {
+                break;
+            }
+        } else {
+            /* any zero byte in xor is a match */
+            uint64Xor = uint64Is[0] ^ uint64Exp[0];
+            if ( 0 != ((uint64Xor - 0x0101010101010101ULL) & ~uint64Xor & 0x8080808080808080ULL) ) {
+                break;
+            }
+            uint64Xor = uint64Is[1] ^ uint64Exp[1];
+            if ( 0 != ((uint64Xor - 0x0101010101010101ULL) & ~uint64Xor & 0x8080808080808080ULL) ) {
+                break;
+            }
         }
-        /* write out data */
-        line[0] = '\0'; // empty line
-        snprintf( line, sizeof(line)/sizeof(line[0]), "%0*x:", uint8AdrDigits, i ); // write address to buffer line
-        for ( j = 0; j < 16; j++ ) {
-            charHex[0] = '\0';  // empty
-            snprintf( charHex, sizeof(charHex)/sizeof(charHex[0]), " %02x", buf[i+j] ); // convert to ascii
-            strncat( line, charHex, sizeof(line)/sizeof(line[0]) - strlen(line) - 1 );  // overflow save cat
+    }
+#endif
+    /* exact position in block and tail */
+    for ( ; i < len; i++ ) {
+        if ( (0 != diff) == (((NULL == is) ? 0xff : is[i]) != exp[i]) ) {
+            break;
         }
-        fprintf( fp, "%s\n", line );    // file write
     }
-    fclose(fp); // close file handle
-    /* finish function */
-    return SFM_OK;
+    return i;
 }
 
 
 
-/** @brief sfm_read_dif
+/** @brief sfm_and_uint8
  *
- *  read file into buffer in dif format
+ *  programs data into flash storage, bits can only change from 1 to 0
  *
- *  @param[in]      *buf            read in buffer
- *  @param[in]      len             number of elements in buffer
- *  @param[in]      fileName[]      file name to file
- *  @return         int             state
- *  @retval         #SFM_OK         OKAY; @see #SFM_E
- *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *  @param[in,out]  *dst            flash storage
+ *  @param[in]      *src            program data
+ *  @param[in]      len             number of bytes
  *
  */
-static int sfm_read_dif (uint8_t *buf, uint32_t len, char fileName[])
+static void sfm_and_uint8 (uint8_t *dst, const uint8_t *src, uint32_t len)
 {
     /** Variables **/
-    FILE*       fp;             // file pointer
-    char        *line = NULL;   // read buffer line
-    char        *sep = NULL;    // separated
-    size_t      lineLen = 0;    // number of elements in read buffer
-    uint8_t     vals[16];       // read values in line
-    uint32_t    adr;            // start address
-    uint32_t    i, j;           // iterator
-    int         intTemp;        // helper variable for sscanf
-    int         intNumChr;      // number read chars
+    uint32_t    i = 0;  // iterator
 
-    /* open file for read */
-    fp = fopen(fileName, "r");
-    if ( NULL == fp ) {
-        return SFM_E_ACCESS;    // failed to open for read
+#if defined(__SSE2__)
+    for ( ; i + 16 <= len; i += 16 ) {
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_and_si128(_mm_loadu_si128((const __m128i*) (dst + i)), _mm_loadu_si128((const __m128i*) (src + i))));
     }
-    /* make given buffer empty */
-    memset(buf, 0xff, len);
-    /* read line by line */
-    while( -1 != getline(&line, &lineLen, fp) ) {
-        /* prepare */
-        sep = line; // save anchto for processing
-        intNumChr = 0;
-        /* extract address */
-        sscanf(sep, "%x:%n", &intTemp, &intNumChr);
-        sep += intNumChr;   // go one with next element
-        adr = (uint32_t) intTemp;
-        /* extract data bytes */
-        memset(vals, 0xff, sizeof(vals)/sizeof(vals[0]));   // make empty
-        for ( i = 0; i < sizeof(vals)/sizeof(vals[0]); i++ ) {
-            /* line shorter then expected */
-            if ( 0 == strlen(sep) ) {
-                break;
-            }
-            /* get byte */
-            sscanf(sep, "%x%n", &intTemp, &intNumChr);
-            sep += intNumChr;                       // go one with next element
-            vals[i] = (uint8_t) (intTemp & 0xFF);   // cast to byte
-        }
-        /* check and write to big array */
-        if ( adr + i < len ) {
-            for ( j = 0; j < i; j++ ) {
-                buf[adr+j] = vals[j];
-            }
-        }
+#else
+    uint64_t    uint64Dst;  // flash word
+    uint64_t    uint64Src;  // data word
+
+    for ( ; i + 8 <= len; i += 8 ) {
+        memcpy(&uint64Dst, dst + i, sizeof(uint64Dst));
+        memcpy(&uint64Src, src + i, sizeof(uint64Src));
+        uint64Dst &= uint64Src;
+        memcpy(dst + i, &uint64Dst, sizeof(uint64Dst));
+    }
+#endif
+    for ( ; i < len; i++ ) {
+        dst[i] &= src[i];
     }
-    /* finish function */
-    return SFM_OK;
 }
 
 
 
-/** @brief min
+/** @brief sfm_mem_ready
  *
- *  return smaller number
+ *  checks for allocated flash emulation memory
  *
- *  @param[in]      val1            comparison value 1
- *  @param[in]      val2            comparison value 2
- *  @return         uint32_t        bigger number of both inputs
+ *  @param[in]      self            handle
+ *  @return         int             0: no memory, 1: flat or sparse memory allocated
  *
  */
-static uint32_t sfm_min_uint32 (uint32_t val1, uint32_t val2)
+static int sfm_mem_ready (t_sfm *self)
 {
-    if ( val1 < val2 ) {
-        return val1;
-    }
-    return val2;
+    return ( (NULL != self->uint8PtrMem) || (NULL != self->uint8PtrSector) );
 }
 
 
 
-/** @brief subtract
+/** @brief sfm_mem_used_init
  *
- *  overflow save subtraction
+ *  allocates sector state bitmap of flat memory
  *
- *  @param[in]      minuend         value from which something is removed
- *  @param[in]      subtrahend      the value of subtraction
- *  @return         uint32_t        saturated difference of 'minuend - subtrahend'
+ *  @param[in,out]  self            handle
+ *  @param[in]      num             number of leading sectors marked as written, remaining sectors are blank
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
  *
  */
-static uint32_t sfm_subtract_uint32 (uint32_t minuend, uint32_t subtrahend)
+static int sfm_mem_used_init (t_sfm *self, uint32_t num)
 {
-    /* underflow */
-    if ( subtrahend > minuend ) {
-        return (uint32_t) 0;
+    self->uint32PtrSecUsed = (uint32_t*) calloc((self->desc.uint32SectorNum + 31) / 32, sizeof(uint32_t));
+    if ( NULL == self->uint32PtrSecUsed ) {
+        return SFM_E_MALLOC;
     }
-    /* subtract */
-    return (uint32_t) (minuend - subtrahend);
+    for ( uint32_t i = 0; i < num; i++ ) {
+        self->uint32PtrSecUsed[i >> 5] |= (uint32_t) 1 << (i & 0x1f);
+    }
+    self->uint32SectorAlloc = num;
+    return SFM_OK;
 }
 
 
 
-/** @brief hexdump
+/** @brief sfm_mem_settle
  *
- *  dumps uint8 array to console with 16 values per row
+ *  applies pending Chip Erase to sector storage
  *
- *  @param[in,out]  *data           uint8 data to printed
- *  @param[in]      start           start address, aligned to multiples of 16
- *  @param[in]      stop            stop address, aligned to multiples of 16
- *  @param[in,out]  rowlead         leading string in each row of dump
- *  @return         uint32_t        saturated difference of 'minuend - subtrahend'
+ *  @param[in,out]  self            handle
+ *  @param[in]      sector          sector number
  *
  */
-static void sfm_hexdump_uint8 (uint8_t *data, uint32_t start, uint32_t stop, char rowlead[])
+static void sfm_mem_settle (t_sfm *self, uint32_t sector)
 {
-    /** Variables **/
-    uint32_t    uint32Start;
-    uint32_t    uint32Stop;
-    uint8_t     uint8AdrDigits;
-
-    /* check */
-    if ( start > stop ) {
+    /* sector is up to date */
+    if ( self->uint32PtrSecGen[sector] == self->uint32EraseGen ) {
         return;
     }
-    /* assign address to multiples of 16 */
-    uint32Start = start & (uint32_t) ~0xF;  // start at 0
-    uint32Stop = stop | (uint32_t) 0xF;     // stop at 15
-    /* leading zeros in adr */
-    uint8AdrDigits = sfm_adr_digits( uint32Stop );
-    /* dump to console */
-    for ( uint32_t i = uint32Start; i < uint32Stop; i += 16 ) {
-        /* address */
-        printf("%s%0*x: ", rowlead, uint8AdrDigits, i);  // memory address
-        /* 16 byte per row */
-        for ( uint32_t j = 0; j < 16; j++ ) {
-            /* hex number */
-            printf("%02x ", data[i+j]);
-            /* divide high/low bytes */
-            if ( 7 == j ) {
-                printf(" ");
-            }
+    self->uint32PtrSecGen[sector] = self->uint32EraseGen;
+    /* flat memory, written sector count was reset by Chip Erase */
+    if ( NULL != self->uint8PtrMem ) {
+        if ( 0 != (self->uint32PtrSecUsed[sector >> 5] & ((uint32_t) 1 << (sector & 0x1f))) ) {
+            memset(self->uint8PtrMem + ((size_t) sector << self->desc.uint8SectorShift), 0xff, self->flashType->uint32FlashTopoSectorSizeByte);
+            self->uint32PtrSecUsed[sector >> 5] &= ~((uint32_t) 1 << (sector & 0x1f));
         }
-        printf("\n");   // new row
+        return;
+    }
+    /* sparse memory */
+    if ( NULL != self->uint8PtrSector[sector] ) {
+        free(self->uint8PtrSector[sector]);
+        self->uint8PtrSector[sector] = NULL;
+        self->uint32SectorAlloc--;
     }
-    /* end */
-    return;
 }
 
 
 
-/**
- *  sfm_init
- *    initialises spi flash model handle
+/** @brief sfm_mem_settle_all
+ *
+ *  applies pending Chip Erase to all sectors
+ *
+ *  @param[in,out]  self            handle
+ *
  */
-int sfm_init (t_sfm *self, char flashType[])
+static void sfm_mem_settle_all (t_sfm *self)
 {
-    /** variables **/
-    uint32_t    i;  // iterator
-
-    /* init */
-    self->intMsgLevel = 0;                  // no messages
-    self->uint8PtrMem = NULL;               // not initialised
-    self->flashType = NULL;                 // no  memory selected
-    self->uint8StatusReg1 = 0;              // status register
-    self->uint8WipRdAfterWriteCnt = 0;      // ready for write access
-    /* determine SPI flash by name */
-    for ( i = 0; i < sizeof(SPI_FLASH)/sizeof(SPI_FLASH[0]) - 1; i++ ) {
-        if ( 0 == strcasecmp(flashType, SPI_FLASH[i].charFlashName) ) { // match
-            self->flashType = &SPI_FLASH[i];    // assign selected flash
-            break;
-        }
-    }
-    /* no memory found? */
-    if ( NULL == self->flashType ) {
-        return SFM_E_NO_FLASH;
-    }
-    /* allocate memory */
-    self->uint8PtrMem = (uint8_t*) malloc(self->flashType->uint32FlashTopoTotalSizeByte);
-    if ( NULL == self->uint8PtrMem ) {
-        return SFM_E_MALLOC;    // memory allocation fail
+    for ( uint32_t i = 0; i < self->desc.uint32SectorNum; i++ ) {
+        sfm_mem_settle(self, i);
     }
-    /* make memory empty */
-    memset(self->uint8PtrMem, 0xff, self->flashType->uint32FlashTopoTotalSizeByte);
-    /* finish function */
-    return SFM_OK;
 }
 
 
 
-/**
- *  sfm_dump
- *    dumps flash to console
+/** @brief sfm_mem_sector
+ *
+ *  storage of flash sector
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      sector          sector number
+ *  @param[in]      alloc           1: mark sector as written, allocates storage in sparse mode
+ *  @return         uint8_t*        sector storage, NULL: unwritten sector (reads as 0xff) or allocation failed
+ *
  */
-int sfm_dump (t_sfm *self, int32_t start, int32_t stop)
+static uint8_t* sfm_mem_sector (t_sfm *self, uint32_t sector, int alloc)
 {
     /** Variables **/
-    uint32_t    uint32Start;    // stop address
-    uint32_t    uint32Stop;     // start address
-
-
-    /* Function Call Message */
-    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
-
-    /* flash type selected */
-    if ( NULL == self->flashType ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); };
-        return SFM_E_NO_FLASH;;
-    }
-
-    /* memory allocated */
-    if ( NULL == self->uint8PtrMem ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); };
-        return SFM_E_MALLOC;
-    }
+    uint8_t*    uint8PtrSec;    // sector storage
 
-    /* default args */
-    uint32Start = (uint32_t) start;
-    uint32Stop = (uint32_t) stop;
-    if ( 0 > start ) {
-        uint32Start = 0;
+    /* pending Chip Erase, sector reads as erased until next write */
+    if ( self->uint32PtrSecGen[sector] != self->uint32EraseGen ) {
+        if ( 0 == alloc ) {
+            return NULL;
+        }
+        sfm_mem_settle(self, sector);
     }
-    if ( 0 > stop ) {
-        uint32Stop = self->flashType->uint32FlashTopoTotalSizeByte;
+    /* flat memory, blank sectors are already erased */
+    if ( NULL != self->uint8PtrMem ) {
+        if ( 0 == (self->uint32PtrSecUsed[sector >> 5] & ((uint32_t) 1 << (sector & 0x1f))) ) {
+            if ( 0 == alloc ) {
+                return NULL;
+            }
+            self->uint32PtrSecUsed[sector >> 5] |= (uint32_t) 1 << (sector & 0x1f);
+            self->uint32SectorAlloc++;
+        }
+        return self->uint8PtrMem + ((size_t) sector << self->desc.uint8SectorShift);
     }
-
-    /* inside address range */
-    if ( uint32Stop  > self->flashType->uint32FlashTopoTotalSizeByte - 1 ||
-         uint32Start > self->flashType->uint32FlashTopoTotalSizeByte - 1
-    ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: flash address out of range\n", __FUNCTION__); }
-        return SFM_E_ACCESS;
+    /* sparse memory */
+    uint8PtrSec = self->uint8PtrSector[sector];
+    if ( (NULL == uint8PtrSec) && (0 != alloc) ) {
+        uint8PtrSec = (uint8_t*) malloc(self->flashType->uint32FlashTopoSectorSizeByte);
+        if ( NULL != uint8PtrSec ) {
+            memset(uint8PtrSec, 0xff, self->flashType->uint32FlashTopoSectorSizeByte);
+            self->uint8PtrSector[sector] = uint8PtrSec;
+            self->uint32SectorAlloc++;
+        }
     }
-
-    /* dump flash to console */
-    sfm_hexdump_uint8 (self->uint8PtrMem, uint32Start, uint32Stop, "");
-
-    /* finish function */
-    return SFM_OK;
+    return uint8PtrSec;
 }
 
 
 
-/**
- *  sfm_store
- *    stores spi flash memory into file
- *    .dif -> difference to empty flash, full initialized with 0xff
+/** @brief sfm_mem_rd
+ *
+ *  copies flash content into buffer, unwritten sectors read as 0xff
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      adr             flash start address, adr+len inside flash
+ *  @param[out]     *dst            destination buffer
+ *  @param[in]      len             number of bytes
+ *
  */
-int sfm_store (t_sfm *self, char fileName[])
+static void sfm_mem_rd (t_sfm *self, uint32_t adr, uint8_t *dst, uint32_t len)
 {
     /** Variables **/
-    char*       charPtrFileExt;     // pointer to file extension
+    uint32_t        uint32Seg;      // bytes in current sector
+    const uint8_t*  uint8PtrSec;    // sector storage
 
+    while ( len > 0 ) {
+        uint32Seg = sfm_min_uint32(len, self->flashType->uint32FlashTopoSectorSizeByte - (adr & self->desc.uint32SectorMsk));
+        uint8PtrSec = sfm_mem_sector(self, adr >> self->desc.uint8SectorShift, 0);
+        if ( NULL == uint8PtrSec ) {
+            memset(dst, 0xff, uint32Seg);
+        } else {
+            memcpy(dst, uint8PtrSec + (adr & self->desc.uint32SectorMsk), uint32Seg);
+        }
+        adr += uint32Seg;
+        dst += uint32Seg;
+        len -= uint32Seg;
+    }
+}
 
-    /* Function Call Message */
-    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
 
-    /* flash type selected */
-    if ( NULL == self->flashType ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); }
-        return SFM_E_NO_FLASH;;
-    }
 
-    /* memory allocated */
-    if ( NULL == self->uint8PtrMem ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
-        return SFM_E_MALLOC;
+/** @brief sfm_mem_wr
+ *
+ *  overwrites flash content with buffer, empty data of unwritten sectors allocates no storage
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      adr             flash start address, adr+len inside flash
+ *  @param[in]      *src            source buffer
+ *  @param[in]      len             number of bytes
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   sector allocation failed; @see #SFM_E
+ *
+ */
+static int sfm_mem_wr (t_sfm *self, uint32_t adr, const uint8_t *src, uint32_t len)
+{
+    /** Variables **/
+    uint32_t    uint32Seg;      // bytes in current sector
+    uint8_t*    uint8PtrSec;    // sector storage
+
+    while ( len > 0 ) {
+        uint32Seg = sfm_min_uint32(len, self->flashType->uint32FlashTopoSectorSizeByte - (adr & self->desc.uint32SectorMsk));
+        uint8PtrSec = sfm_mem_sector(self, adr >> self->desc.uint8SectorShift, 0);
+        if ( NULL == uint8PtrSec ) {
+            if ( uint32Seg != sfm_cmp_scan(NULL, src, uint32Seg, 1) ) {  // empty data keeps sector unwritten
+                uint8PtrSec = sfm_mem_sector(self, adr >> self->desc.uint8SectorShift, 1);
+                if ( NULL == uint8PtrSec ) {
+                    return SFM_E_MALLOC;
+                }
+            }
+        }
+        if ( NULL != uint8PtrSec ) {
+            memcpy(uint8PtrSec + (adr & self->desc.uint32SectorMsk), src, uint32Seg);
+        }
+        adr += uint32Seg;
+        src += uint32Seg;
+        len -= uint32Seg;
+    }
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_mem_erase
+ *
+ *  erases flash sectors, blank sectors are skipped, sparse mode releases the sector storage
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      sector          first sector
+ *  @param[in]      num             number of sectors
+ *
+ */
+static void sfm_mem_erase (t_sfm *self, uint32_t sector, uint32_t num)
+{
+    /** Variables **/
+    uint8_t*    uint8PtrSec;    // sector storage
+
+    /* flat memory, only written sectors need an erase */
+    if ( NULL != self->uint8PtrMem ) {
+        for ( uint32_t i = sector; i < sector + num; i++ ) {
+            uint8PtrSec = sfm_mem_sector(self, i, 0);
+            if ( NULL != uint8PtrSec ) {
+                memset(uint8PtrSec, 0xff, self->flashType->uint32FlashTopoSectorSizeByte);
+                self->uint32PtrSecUsed[i >> 5] &= ~((uint32_t) 1 << (i & 0x1f));
+                self->uint32SectorAlloc--;
+            }
+        }
+        return;
+    }
+    /* sparse memory */
+    for ( uint32_t i = sector; i < sector + num; i++ ) {
+        if ( NULL != self->uint8PtrSector[i] ) {
+            free(self->uint8PtrSector[i]);
+            self->uint8PtrSector[i] = NULL;
+            self->uint32SectorAlloc--;
+        }
+    }
+}
+
+
+/** @brief sfm_mem_erase_all
+ *
+ *  erases complete flash in constant time, sectors are erased on next write
+ *
+ *  @param[in,out]  self            handle
+ *
+ */
+static void sfm_mem_erase_all (t_sfm *self)
+{
+    /* generation wrap, apply all pending erases first */
+    if ( UINT32_MAX == self->uint32EraseGen ) {
+        sfm_mem_settle_all(self);
+        memset(self->uint32PtrSecGen, 0, self->desc.uint32SectorNum * sizeof(uint32_t));
+        self->uint32EraseGen = 0;
+    }
+    self->uint32EraseGen++;
+    if ( NULL != self->uint8PtrMem ) {
+        self->uint32SectorAlloc = 0;    // sparse mode counts allocated storage
+    }
+}
+
+
+
+
+/** @brief sfm_adr_digits
+ *
+ *  determine number of digits for full address
+ *
+ *  @param[in]      adr             spi flash address
+ *  @return         uint8_t         number of digits in asciihex converted address
+ *
+ */
+static uint8_t sfm_adr_digits (uint32_t adr)
+{
+    /** variables **/
+    char charHexAdr[10];    // adr converted to hexadecimal address
+
+    /* determine number of digits for hex address */
+    charHexAdr[0] = '\0';   // empty string
+    snprintf( charHexAdr, sizeof(charHexAdr)/sizeof(charHexAdr[0]), "%x", adr );
+    return ((uint8_t) strlen(charHexAdr));  // zero padding at lower addresses
+}
+
+
+
+/** @brief sfm_file_ext
+ *
+ *  file extension
+ *
+ *  @param[in]      fileName[]      file name
+ *  @return         char*           file extension without dot, NULL: no extension
+ *
+ */
+static char* sfm_file_ext (char fileName[])
+{
+    /** Variables **/
+    char*   charPtrDot; // last dot in file name
+
+    charPtrDot = strrchr(fileName, '.');
+    if ( NULL == charPtrDot ) {
+        return NULL;
+    }
+    return charPtrDot + 1;
+}
+
+
+
+/** @brief sfm_fd_rd
+ *
+ *  reads from file until buffer is full or end of file
+ *
+ *  @param[in]      fd              file descriptor
+ *  @param[out]     *buf            read buffer
+ *  @param[in]      len             number of bytes to read
+ *  @return         ssize_t         number of read bytes, -1: read error
+ *
+ */
+static ssize_t sfm_fd_rd (int fd, uint8_t *buf, size_t len)
+{
+    /** Variables **/
+    size_t      pos = 0;    // read bytes
+    ssize_t     num;        // bytes of one read call
+
+    while ( pos < len ) {
+        num = read(fd, buf + pos, len - pos);
+        if ( 0 > num ) {
+            return -1;  // read error
+        }
+        if ( 0 == num ) {
+            break;      // end of file
+        }
+        pos += (size_t) num;
+    }
+    return (ssize_t) pos;
+}
+
+
+
+/** @brief sfm_fd_wr
+ *
+ *  writes complete buffer to file
+ *
+ *  @param[in]      fd              file descriptor
+ *  @param[in]      *buf            write buffer
+ *  @param[in]      len             number of bytes to write
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_fd_wr (int fd, const uint8_t *buf, size_t len)
+{
+    /** Variables **/
+    ssize_t     num;    // bytes of one write call
+
+    while ( len > 0 ) {
+        num = write(fd, buf, len);
+        if ( 0 >= num ) {
+            return SFM_E_ACCESS;
+        }
+        buf += num;
+        len -= (size_t) num;
+    }
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_dif_blank_line
+ *
+ *  checks 16 bytes dif line for erased state with wide compares
+ *
+ *  @param[in]      *data           line data
+ *  @return         int             0: line contains programmed bytes, 1: line is erased
+ *
+ */
+static int sfm_dif_blank_line (const uint8_t *data)
+{
+    /** Variables **/
+    uint64_t    uint64Lo, uint64Hi; // line halves
+
+    memcpy(&uint64Lo, data, sizeof(uint64Lo));      // alignment safe load, compiles to plain load
+    memcpy(&uint64Hi, data + 8, sizeof(uint64Hi));
+    return (UINT64_MAX == (uint64Lo & uint64Hi));
+}
+
+
+
+/** @brief sfm_dif_fmt_line
+ *
+ *  formats one 16 bytes dif line, f.e. '001020: 01 23 ... ef\n'
+ *
+ *  @param[out]     *line           output buffer, at least #SFM_DIF_LINE_MAX bytes
+ *  @param[in]      adr             line start address
+ *  @param[in]      digits          number of address digits
+ *  @param[in]      *data           line data
+ *  @return         uint32_t        number of written characters
+ *
+ */
+static uint32_t sfm_dif_fmt_line (char *line, uint32_t adr, uint8_t digits, const uint8_t *data)
+{
+    /** Variables **/
+    static const char   charHex[] = "0123456789abcdef";    // nibble to ascii
+    uint32_t            pos;                                // write position
+
+    /* address, zero padded */
+    for ( pos = digits; pos > 0; pos-- ) {
+        line[pos-1] = charHex[adr & 0xf];
+        adr >>= 4;
+    }
+    line[digits] = ':';
+    pos = (uint32_t) digits + 1;
+    /* data */
+    for ( uint8_t i = 0; i < 16; i++ ) {
+        line[pos]   = ' ';
+        line[pos+1] = charHex[data[i] >> 4];
+        line[pos+2] = charHex[data[i] & 0xf];
+        pos += 3;
+    }
+    line[pos++] = '\n';
+    return pos;
+}
+
+
+
+/** @brief sfm_write_dif
+ *
+ *  write flash to file in dif format, differences to 0xff default are in 16 bytes lines written out
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName[]      file name to file
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_write_dif (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    int         fd;                 // file descriptor
+    int         intRet = SFM_OK;    // return value
+    char*       buf;                // output buffer
+    uint32_t    uint32Len = 0;      // used output buffer
+    uint32_t    uint32BufSize;      // output buffer size
+    uint32_t    sec, i;             // iterator
+    uint8_t     uint8AdrDigits;     // number of address digits
+    uint8_t*    uint8PtrSec;        // sector storage
+
+    /* determine number of hex digits for full address */
+    uint8AdrDigits = sfm_adr_digits( self->flashType->uint32FlashTopoTotalSizeByte );
+    if (uint8AdrDigits > 8) {   // limit size according to uint32_t for len
+        uint8AdrDigits = 8;
+    }
+    /* output buffer, holds at least one line */
+    uint32BufSize = (uint32_t) SFM_IO_CHUNK_BYTE;
+    if ( uint32BufSize < SFM_DIF_LINE_MAX ) {
+        uint32BufSize = SFM_DIF_LINE_MAX;
+    }
+    buf = (char*) malloc(uint32BufSize);
+    if ( NULL == buf ) {
+        return SFM_E_MALLOC;
+    }
+    /* open file for write */
+    fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if ( 0 > fd ) {
+        free(buf);
+        return SFM_E_ACCESS;    // failed to open for write
+    }
+    /* iterate over sectors */
+    for ( sec = 0; (sec < self->desc.uint32SectorNum) && (SFM_OK == intRet); sec++ ) {
+        /* unwritten sector */
+        uint8PtrSec = sfm_mem_sector(self, sec, 0);
+        if ( NULL == uint8PtrSec ) {
+            continue;
+        }
+        /* iterate over sector in multiples of 16 */
+        for ( i = 0; i < self->flashType->uint32FlashTopoSectorSizeByte; i += 16 ) {
+            if ( 0 != sfm_dif_blank_line(uint8PtrSec + i) ) {
+                continue;   // go one with next 16 data bytes
+            }
+            /* flush buffer */
+            if ( uint32BufSize - uint32Len < SFM_DIF_LINE_MAX ) {
+                intRet = sfm_fd_wr(fd, (uint8_t*) buf, uint32Len);
+                uint32Len = 0;
+                if ( SFM_OK != intRet ) {
+                    break;
+                }
+            }
+            uint32Len += sfm_dif_fmt_line(buf + uint32Len, (sec << self->desc.uint8SectorShift) + i, uint8AdrDigits, uint8PtrSec + i);
+        }
+    }
+    /* write remaining */
+    if ( (SFM_OK == intRet) && (0 != uint32Len) ) {
+        intRet = sfm_fd_wr(fd, (uint8_t*) buf, uint32Len);
+    }
+    free(buf);
+    /* finish function */
+    if ( 0 != close(fd) ) {
+        return SFM_E_ACCESS;
+    }
+    return intRet;
+}
+
+
+
+/** @brief hex digit look up table
+ *
+ *  ASCII character to hex digit value plus one, zero marks a non hex character
+ */
+static const uint8_t SFM_HEX_LUT[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,  ['5'] = 6,  ['6'] = 7,  ['7'] = 8,
+    ['8'] = 9,  ['9'] = 10, ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16
+};
+
+
+
+/** @brief sfm_dif_line
+ *
+ *  decodes one dif line 'adr: xx xx ...' without terminating new line
+ *
+ *  @param[in]      *line           line start
+ *  @param[in]      *end            line end
+ *  @param[out]     *adr            line address
+ *  @param[out]     vals[]          data bytes, up to 16
+ *  @return         int             number of data bytes, -1: no dif line
+ *
+ */
+static int sfm_dif_line (const char *line, const char *end, uint32_t *adr, uint8_t vals[16])
+{
+    /** Variables **/
+    const uint8_t*  pos = (const uint8_t*) line;    // parse position
+    const uint8_t*  stop = (const uint8_t*) end;    // parse end
+    uint32_t        val;                            // decoded value
+    uint8_t         dig;                            // hex digit plus one
+    int             num = 0;                        // decoded bytes
+
+    /* address */
+    while ( (pos < stop) && ((' ' == *pos) || ('\t' == *pos)) ) {
+        pos++;
+    }
+    val = 0;
+    if ( (pos >= stop) || (0 == SFM_HEX_LUT[*pos]) ) {
+        return -1;
+    }
+    while ( (pos < stop) && (0 != (dig = SFM_HEX_LUT[*pos])) ) {
+        val = (val << 4) | (uint32_t) (dig - 1);
+        pos++;
+    }
+    if ( (pos >= stop) || (':' != *pos) ) {
+        return -1;
+    }
+    pos++;
+    *adr = val;
+    /* canonical line ' xx' * 16, decoded without separator search */
+    if ( (48 == stop - pos) || ((49 == stop - pos) && ('\r' == pos[48])) ) {
+        for ( num = 0; num < 16; num++ ) {
+            if ( (' ' != pos[3*num]) || (0 == SFM_HEX_LUT[pos[3*num+1]]) || (0 == SFM_HEX_LUT[pos[3*num+2]]) ) {
+                break;
+            }
+            vals[num] = (uint8_t) (((SFM_HEX_LUT[pos[3*num+1]] - 1) << 4) | (SFM_HEX_LUT[pos[3*num+2]] - 1));
+        }
+        if ( 16 == num ) {
+            return num;
+        }
+        num = 0;
+    }
+    /* generic line, whitespace separated values */
+    while ( num < 16 ) {
+        while ( (pos < stop) && ((' ' == *pos) || ('\t' == *pos) || ('\r' == *pos)) ) {
+            pos++;
+        }
+        if ( (pos >= stop) || (0 == SFM_HEX_LUT[*pos]) ) {
+            break;
+        }
+        val = 0;
+        while ( (pos < stop) && (0 != (dig = SFM_HEX_LUT[*pos])) ) {
+            val = (val << 4) | (uint32_t) (dig - 1);
+            pos++;
+        }
+        vals[num++] = (uint8_t) (val & 0xff);
+    }
+    return num;
+}
+
+
+
+/** @brief dif line callback
+ *
+ *  called by #sfm_dif_parse for every decoded line
+ *
+ *  @param[in,out]  ctx             user context
+ *  @param[in]      adr             line address
+ *  @param[in]      vals[]          data bytes
+ *  @param[in]      num             number of data bytes
+ *  @return         int             #SFM_OK to continue parsing, otherwise parsing is stopped with this value
+ */
+typedef int (*t_sfm_dif_cb) (void *ctx, uint32_t adr, const uint8_t vals[], uint32_t num);
+
+
+
+/** @brief sfm_dif_parse
+ *
+ *  streaming dif decoder, file is read in large blocks and split at new lines
+ *
+ *  @param[in]      fd              opened dif file
+ *  @param[in]      cb              line callback
+ *  @param[in,out]  ctx             user context of line callback
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS   read error; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   no read buffer; @see #SFM_E
+ *
+ */
+static int sfm_dif_parse (int fd, t_sfm_dif_cb cb, void *ctx)
+{
+    /** Variables **/
+    char*       buf;                // read buffer
+    char*       line;               // line start
+    char*       eol;                // line end
+    char*       end;                // end of valid data in buffer
+    size_t      carry = 0;          // bytes of incomplete line from last block
+    ssize_t     num;                // read bytes
+    uint8_t     vals[16];           // line data
+    uint32_t    adr;                // line address
+    int         intNum;             // decoded bytes in line
+    int         intRet = SFM_OK;    // return value
+
+    buf = (char*) malloc(SFM_IO_CHUNK_BYTE);
+    if ( NULL == buf ) {
+        return SFM_E_MALLOC;
+    }
+    while ( SFM_OK == intRet ) {
+        /* fill buffer behind incomplete line */
+        num = sfm_fd_rd(fd, (uint8_t*) buf + carry, SFM_IO_CHUNK_BYTE - carry);
+        if ( 0 > num ) {
+            intRet = SFM_E_ACCESS;
+            break;
+        }
+        end = buf + carry + num;
+        /* decode complete lines, last line of file without new line */
+        for ( line = buf; line < end; line = (eol < end) ? eol + 1 : end ) {
+            eol = (char*) memchr(line, '\n', (size_t) (end - line));
+            if ( NULL == eol ) {
+                if ( (0 != num) && (line != buf) ) {
+                    break;  // incomplete line, continue with next block
+                }
+                eol = end;  // end of file or line exceeds buffer
+            }
+            intNum = sfm_dif_line(line, eol, &adr, vals);
+            if ( 0 < intNum ) {
+                intRet = cb(ctx, adr, vals, (uint32_t) intNum);
+                if ( SFM_OK != intRet ) {
+                    break;
+                }
+            }
+        }
+        /* end of file */
+        if ( 0 == num ) {
+            break;
+        }
+        carry = (size_t) (end - line);
+        memmove(buf, line, carry);
+    }
+    free(buf);
+    return intRet;
+}
+
+
+
+/** @brief sfm_dif_ld_line
+ *
+ *  dif line callback, writes line into flash, lines outside of flash are ignored
+ *
+ *  @param[in,out]  ctx             handle
+ *  @param[in]      adr             line address
+ *  @param[in]      vals[]          data bytes
+ *  @param[in]      num             number of data bytes
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   sector allocation failed; @see #SFM_E
+ *
+ */
+static int sfm_dif_ld_line (void *ctx, uint32_t adr, const uint8_t vals[], uint32_t num)
+{
+    /** Variables **/
+    t_sfm*  self = (t_sfm*) ctx;    // handle
+
+    if ( (uint64_t) adr + num > self->flashType->uint32FlashTopoTotalSizeByte ) {
+        return SFM_OK;
+    }
+    return sfm_mem_wr(self, adr, vals, num);
+}
+
+
+
+/** dif decode target buffer, @see #sfm_dif_buf_line **/
+typedef struct {
+    uint8_t*    uint8PtrBuf;    /**<  buffer */
+    uint32_t    uint32Len;      /**<  buffer size */
+} t_sfm_dif_buf;
+
+
+
+/** @brief sfm_dif_buf_line
+ *
+ *  dif line callback, writes line into buffer, lines outside of buffer are ignored
+ *
+ *  @param[in,out]  ctx             buffer, #t_sfm_dif_buf
+ *  @param[in]      adr             line address
+ *  @param[in]      vals[]          data bytes
+ *  @param[in]      num             number of data bytes
+ *  @return         int             #SFM_OK
+ *
+ */
+static int sfm_dif_buf_line (void *ctx, uint32_t adr, const uint8_t vals[], uint32_t num)
+{
+    /** Variables **/
+    t_sfm_dif_buf*  buf = (t_sfm_dif_buf*) ctx; // target buffer
+
+    if ( (uint64_t) adr + num <= buf->uint32Len ) {
+        memcpy(buf->uint8PtrBuf + adr, vals, num);
+    }
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_read_dif
+ *
+ *  read dif file into flash, flash locations not part of the file are empty
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName[]      file name to file
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_read_dif (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    int     fd;         // file descriptor
+    int     intRet;     // return value
+
+    /* open file for read */
+    fd = open(fileName, O_RDONLY);
+    if ( 0 > fd ) {
+        return SFM_E_ACCESS;    // failed to open for read
+    }
+    /* make flash empty and decode straight into flash */
+    sfm_mem_erase_all(self);
+    intRet = sfm_dif_parse(fd, sfm_dif_ld_line, self);
+    close(fd);
+    return intRet;
+}
+
+
+
+/** @brief sfm_io_chunk
+ *
+ *  file block size, multiple of sector size
+ *
+ *  @param[in]      self            handle
+ *  @return         uint32_t        block size in bytes
+ *
+ */
+static uint32_t sfm_io_chunk (t_sfm *self)
+{
+    /** Variables **/
+    uint32_t    uint32Chunk;    // block size
+
+    uint32Chunk = (uint32_t) SFM_IO_CHUNK_BYTE & ~self->desc.uint32SectorMsk;
+    if ( uint32Chunk < self->flashType->uint32FlashTopoSectorSizeByte ) {
+        uint32Chunk = self->flashType->uint32FlashTopoSectorSizeByte;
+    }
+    return sfm_min_uint32(uint32Chunk, self->flashType->uint32FlashTopoTotalSizeByte);
+}
+
+
+
+/** @brief sfm_write_bin
+ *
+ *  write flash to file as raw image
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName[]      file name to file
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_write_bin (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    int         fd;                     // file descriptor
+    int         intRet = SFM_OK;        // return value
+    uint8_t*    uint8PtrEmpty = NULL;   // empty sector
+    uint8_t*    uint8PtrSec;            // sector storage
+
+    /* open file for write */
+    fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if ( 0 > fd ) {
+        return SFM_E_ACCESS;
+    }
+    /* flat memory, write out in one go */
+    if ( NULL != self->uint8PtrMem ) {
+        sfm_mem_settle_all(self);
+        intRet = sfm_fd_wr(fd, self->uint8PtrMem, self->flashType->uint32FlashTopoTotalSizeByte);
+    /* sparse memory, unwritten sectors from empty buffer */
+    } else {
+        uint8PtrEmpty = (uint8_t*) malloc(self->flashType->uint32FlashTopoSectorSizeByte);
+        if ( NULL == uint8PtrEmpty ) {
+            close(fd);
+            return SFM_E_MALLOC;
+        }
+        memset(uint8PtrEmpty, 0xff, self->flashType->uint32FlashTopoSectorSizeByte);
+        for ( uint32_t sec = 0; (sec < self->desc.uint32SectorNum) && (SFM_OK == intRet); sec++ ) {
+            uint8PtrSec = sfm_mem_sector(self, sec, 0);
+            intRet = sfm_fd_wr(fd, (NULL != uint8PtrSec) ? uint8PtrSec : uint8PtrEmpty, self->flashType->uint32FlashTopoSectorSizeByte);
+        }
+        free(uint8PtrEmpty);
+    }
+    /* finish function */
+    if ( 0 != close(fd) ) {
+        return SFM_E_ACCESS;
+    }
+    return intRet;
+}
+
+
+
+/** @brief sfm_read_bin
+ *
+ *  read raw image file into flash, flash locations behind image are empty
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName[]      file name to file
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_read_bin (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    int         fd;                 // file descriptor
+    int         intRet = SFM_OK;    // return value
+    struct stat st;                 // file status
+    uint32_t    uint32Chunk;        // block size
+    uint32_t    adr;                // flash address
+    ssize_t     num;                // read bytes
+    uint8_t*    uint8PtrBuf;        // read buffer
+
+    /* open file for read */
+    fd = open(fileName, O_RDONLY);
+    if ( 0 > fd ) {
+        return SFM_E_ACCESS;
+    }
+    if ( (0 != fstat(fd, &st)) || ((uint64_t) st.st_size > self->flashType->uint32FlashTopoTotalSizeByte) ) {
+        close(fd);
+        return SFM_E_ACCESS;    // image does not fit into flash
+    }
+    /* make flash empty, flat memory is written directly and needs the erase applied */
+    sfm_mem_erase_all(self);
+    if ( NULL != self->uint8PtrMem ) {
+        sfm_mem_settle_all(self);
+    }
+    /* flat memory, read straight into flash */
+    if ( NULL != self->uint8PtrMem ) {
+        if ( st.st_size != sfm_fd_rd(fd, self->uint8PtrMem, (size_t) st.st_size) ) {
+            intRet = SFM_E_ACCESS;
+        }
+        for ( adr = 0; adr < (uint32_t) st.st_size; adr += self->flashType->uint32FlashTopoSectorSizeByte ) {    // mark programmed sectors
+            uint32Chunk = sfm_min_uint32(self->flashType->uint32FlashTopoSectorSizeByte, (uint32_t) st.st_size - adr);
+            if ( uint32Chunk != sfm_cmp_scan(NULL, self->uint8PtrMem + adr, uint32Chunk, 1) ) {
+                sfm_mem_sector(self, adr >> self->desc.uint8SectorShift, 1);
+            }
+        }
+    /* sparse memory, empty blocks allocate no sectors */
+    } else {
+        uint32Chunk = sfm_io_chunk(self);
+        uint8PtrBuf = (uint8_t*) malloc(uint32Chunk);
+        if ( NULL == uint8PtrBuf ) {
+            close(fd);
+            return SFM_E_MALLOC;
+        }
+        for ( adr = 0; (adr < (uint32_t) st.st_size) && (SFM_OK == intRet); adr += (uint32_t) num ) {
+            num = sfm_fd_rd(fd, uint8PtrBuf, uint32Chunk);
+            if ( 0 >= num ) {
+                intRet = SFM_E_ACCESS;
+                break;
+            }
+            intRet = sfm_mem_wr(self, adr, uint8PtrBuf, (uint32_t) num);
+        }
+        free(uint8PtrBuf);
+    }
+    /* finish function */
+    close(fd);
+    return intRet;
+}
+
+
+
+/** mismatch report, @see #sfm_cmp_ranges **/
+typedef struct {
+    t_sfm_range*    ranges;         /**<  range list, NULL: only count */
+    uint32_t        uint32Max;      /**<  capacity of ranges */
+    uint32_t        uint32Num;      /**<  number of found ranges */
+    t_sfm_range     last;           /**<  most recent range */
+    uint32_t        uint32First;    /**<  first mismatching address */
+    uint8_t         uint8Exp;       /**<  expected value at first mismatch */
+} t_sfm_cmp_rpt;
+
+
+
+/** @brief sfm_cmp_rpt_add
+ *
+ *  adds mismatch to report, merges with adjacent previous range
+ *
+ *  @param[in,out]  rpt             mismatch report
+ *  @param[in]      start           first differing address
+ *  @param[in]      stop            last differing address
+ *  @param[in]      exp             expected value at start
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_CMP      report full, stop compare; @see #SFM_E
+ *
+ */
+static int sfm_cmp_rpt_add (t_sfm_cmp_rpt *rpt, uint32_t start, uint32_t stop, uint8_t exp)
+{
+    /* extend previous range */
+    if ( (0 != rpt->uint32Num) && ((uint64_t) rpt->last.uint32Stop + 1 == start) ) {
+        rpt->last.uint32Stop = stop;
+        if ( NULL != rpt->ranges ) {
+            rpt->ranges[rpt->uint32Num-1].uint32Stop = stop;
+        }
+        return SFM_OK;
+    }
+    /* new range */
+    if ( (NULL != rpt->ranges) && (rpt->uint32Num >= rpt->uint32Max) ) {
+        return SFM_E_CMP;
+    }
+    if ( 0 == rpt->uint32Num ) {
+        rpt->uint32First = start;
+        rpt->uint8Exp = exp;
+    }
+    rpt->last.uint32Start = start;
+    rpt->last.uint32Stop = stop;
+    if ( NULL != rpt->ranges ) {
+        rpt->ranges[rpt->uint32Num] = rpt->last;
+    }
+    rpt->uint32Num++;
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_cmp_mem
+ *
+ *  compares flash memory with expected data, mismatches are added to report
+ *
+ *  @param[in]      self            handle
+ *  @param[in]      adr             start address
+ *  @param[in]      *exp            expected data, NULL: empty flash 0xff
+ *  @param[in]      len             number of bytes
+ *  @param[in,out]  rpt             mismatch report
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_CMP      report full, stop compare; @see #SFM_E
+ *
+ */
+static int sfm_cmp_mem (t_sfm *self, uint32_t adr, const uint8_t *exp, uint32_t len, t_sfm_cmp_rpt *rpt)
+{
+    /** Variables **/
+    uint32_t        uint32Seg;  // bytes in sector
+    uint32_t        i, j;       // iterator
+    uint8_t*        uint8PtrIs; // flash data, NULL: empty sector
+    const uint8_t*  uint8PtrA;  // compare buffer, NULL: empty
+    const uint8_t*  uint8PtrB;  // compare buffer
+    int             intRet;     // return value
+
+    while ( 0 != len ) {
+        uint32Seg = sfm_min_uint32(len, self->flashType->uint32FlashTopoSectorSizeByte - (adr & self->desc.uint32SectorMsk));
+        uint8PtrIs = sfm_mem_sector(self, adr >> self->desc.uint8SectorShift, 0);
+        if ( NULL != uint8PtrIs ) {
+            uint8PtrIs += adr & self->desc.uint32SectorMsk;
+        }
+        /* empty against empty is always equal, equal data is skipped with library speed */
+        if ( ((NULL != uint8PtrIs) || (NULL != exp)) && ((NULL == uint8PtrIs) || (NULL == exp) || (0 != memcmp(uint8PtrIs, exp, uint32Seg))) ) {
+            uint8PtrA = (NULL != exp) ? uint8PtrIs : NULL;
+            uint8PtrB = (NULL != exp) ? exp : uint8PtrIs;
+            for ( i = 0; i < uint32Seg; i = j ) {
+                i += sfm_cmp_scan((NULL != uint8PtrA) ? uint8PtrA + i : NULL, uint8PtrB + i, uint32Seg - i, 1);
+                if ( i >= uint32Seg ) {
+                    break;
+                }
+                j = i + sfm_cmp_scan((NULL != uint8PtrA) ? uint8PtrA + i : NULL, uint8PtrB + i, uint32Seg - i, 0);
+                intRet = sfm_cmp_rpt_add(rpt, adr + i, adr + j - 1, (NULL != exp) ? exp[i] : 0xff);
+                if ( SFM_OK != intRet ) {
+                    return intRet;
+                }
+            }
+        }
+        adr += uint32Seg;
+        len -= uint32Seg;
+        if ( NULL != exp ) {
+            exp += uint32Seg;
+        }
+    }
+    return SFM_OK;
+}
+
+
+
+/** dif compare state, @see #sfm_dif_cmp_line **/
+typedef struct {
+    t_sfm*          self;           /**<  flash handle */
+    t_sfm_cmp_rpt*  rpt;            /**<  mismatch report */
+    uint32_t        uint32Pos;      /**<  next not compared address */
+    int             intUnsorted;    /**<  file lines not in ascending address order */
+} t_sfm_dif_cmp;
+
+
+
+/** @brief sfm_dif_cmp_line
+ *
+ *  dif line callback, compares gap to previous line against empty and line against flash
+ *
+ *  @param[in,out]  ctx             compare state, #t_sfm_dif_cmp
+ *  @param[in]      adr             line address
+ *  @param[in]      vals[]          data bytes
+ *  @param[in]      num             number of data bytes
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_CMP      report full or unsorted file, stop compare; @see #SFM_E
+ *
+ */
+static int sfm_dif_cmp_line (void *ctx, uint32_t adr, const uint8_t vals[], uint32_t num)
+{
+    /** Variables **/
+    t_sfm_dif_cmp*  cmp = (t_sfm_dif_cmp*) ctx; // compare state
+    int             intRet;                     // return value
+
+    /* ignore lines outside of flash */
+    if ( (uint64_t) adr + num > cmp->self->flashType->uint32FlashTopoTotalSizeByte ) {
+        return SFM_OK;
+    }
+    /* overlapping or descending lines need random access */
+    if ( adr < cmp->uint32Pos ) {
+        cmp->intUnsorted = 1;
+        return SFM_E_CMP;
+    }
+    intRet = sfm_cmp_mem(cmp->self, cmp->uint32Pos, NULL, adr - cmp->uint32Pos, cmp->rpt);
+    if ( SFM_OK != intRet ) {
+        return intRet;
+    }
+    cmp->uint32Pos = adr + num;
+    return sfm_cmp_mem(cmp->self, adr, vals, num, cmp->rpt);
+}
+
+
+
+/** @brief sfm_cmp_dif
+ *
+ *  compares dif file with flash, flash locations not part of the file are expected empty.
+ *  Files in ascending address order are streamed, otherwise decoded into a full size buffer
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName[]      file name to file
+ *  @param[in,out]  rpt             mismatch report
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY, compare done; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_cmp_dif (t_sfm *self, char fileName[], t_sfm_cmp_rpt *rpt)
+{
+    /** Variables **/
+    int             fd;                 // file descriptor
+    int             intRet;             // return value
+    t_sfm_dif_cmp   cmp;                // streaming compare state
+    t_sfm_dif_buf   ldBuf;              // file content, unsorted fallback
+
+    /* open file for read */
+    fd = open(fileName, O_RDONLY);
+    if ( 0 > fd ) {
+        return SFM_E_ACCESS;
+    }
+    /* stream compare */
+    cmp.self = self;
+    cmp.rpt = rpt;
+    cmp.uint32Pos = 0;
+    cmp.intUnsorted = 0;
+    intRet = sfm_dif_parse(fd, sfm_dif_cmp_line, &cmp);
+    if ( SFM_OK == intRet ) {
+        intRet = sfm_cmp_mem(self, cmp.uint32Pos, NULL, self->flashType->uint32FlashTopoTotalSizeByte - cmp.uint32Pos, rpt);
+    }
+    /* unsorted file, restart with random access buffer */
+    if ( 0 != cmp.intUnsorted ) {
+        rpt->uint32Num = 0;
+        ldBuf.uint32Len = self->flashType->uint32FlashTopoTotalSizeByte;
+        ldBuf.uint8PtrBuf = (uint8_t*) malloc(ldBuf.uint32Len);
+        if ( NULL == ldBuf.uint8PtrBuf ) {
+            close(fd);
+            return SFM_E_MALLOC;
+        }
+        memset(ldBuf.uint8PtrBuf, 0xff, ldBuf.uint32Len);
+        if ( 0 > lseek(fd, 0, SEEK_SET) ) {
+            intRet = SFM_E_ACCESS;
+        } else {
+            intRet = sfm_dif_parse(fd, sfm_dif_buf_line, &ldBuf);
+        }
+        if ( SFM_OK == intRet ) {
+            intRet = sfm_cmp_mem(self, 0, ldBuf.uint8PtrBuf, ldBuf.uint32Len, rpt);
+        }
+        free(ldBuf.uint8PtrBuf);
+    }
+    close(fd);
+    /* full report is a finished compare */
+    if ( SFM_E_CMP == intRet ) {
+        intRet = SFM_OK;
+    }
+    return intRet;
+}
+
+
+
+/** @brief sfm_cmp_bin
+ *
+ *  compares raw image file blockwise with flash, flash locations behind image are expected empty
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName[]      file name to file
+ *  @param[in,out]  rpt             mismatch report
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY, compare done; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS   FAIL; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_cmp_bin (t_sfm *self, char fileName[], t_sfm_cmp_rpt *rpt)
+{
+    /** Variables **/
+    int         fd;                 // file descriptor
+    int         intRet = SFM_OK;    // return value
+    struct stat st;                 // file status
+    uint32_t    uint32Chunk;        // block size
+    uint32_t    uint32Len;          // bytes in current block
+    uint32_t    uint32Adr;          // block address
+    ssize_t     num;                // read bytes
+    uint8_t*    uint8PtrBuf;        // read buffer
+
+    /* open file for read */
+    fd = open(fileName, O_RDONLY);
+    if ( 0 > fd ) {
+        return SFM_E_ACCESS;
+    }
+    if ( (0 != fstat(fd, &st)) || ((uint64_t) st.st_size > self->flashType->uint32FlashTopoTotalSizeByte) ) {
+        close(fd);
+        return SFM_E_ACCESS;    // image does not fit into flash
+    }
+    uint32Chunk = sfm_io_chunk(self);
+    uint8PtrBuf = (uint8_t*) malloc(uint32Chunk);
+    if ( NULL == uint8PtrBuf ) {
+        close(fd);
+        return SFM_E_MALLOC;
+    }
+    /* compare blockwise */
+    for ( uint32Adr = 0; (uint32Adr < self->flashType->uint32FlashTopoTotalSizeByte) && (SFM_OK == intRet); uint32Adr += uint32Len ) {
+        uint32Len = sfm_min_uint32(uint32Chunk, self->flashType->uint32FlashTopoTotalSizeByte - uint32Adr);
+        num = sfm_fd_rd(fd, uint8PtrBuf, uint32Len);
+        if ( 0 > num ) {
+            intRet = SFM_E_ACCESS;
+            break;
+        }
+        intRet = sfm_cmp_mem(self, uint32Adr, uint8PtrBuf, (uint32_t) num, rpt);
+        if ( SFM_OK == intRet ) {   // behind image
+            intRet = sfm_cmp_mem(self, uint32Adr + (uint32_t) num, NULL, uint32Len - (uint32_t) num, rpt);
+        }
+    }
+    /* finish function */
+    free(uint8PtrBuf);
+    close(fd);
+    /* full report is a finished compare */
+    if ( SFM_E_CMP == intRet ) {
+        intRet = SFM_OK;
+    }
+    return intRet;
+}
+
+
+
+/** @brief hexdump
+ *
+ *  dumps uint8 array to console with 16 values per row
+ *
+ *  @param[in,out]  self            handle, if not NULL rows are read from flash emulation memory instead of *data
+ *  @param[in,out]  *data           uint8 data to printed
+ *  @param[in]      start           start address, aligned to multiples of 16
+ *  @param[in]      stop            stop address, aligned to multiples of 16
+ *  @param[in,out]  rowlead         leading string in each row of dump
+ *  @return         uint32_t        saturated difference of 'minuend - subtrahend'
+ *
+ */
+static void sfm_hexdump_uint8 (t_sfm *self, uint8_t *data, uint32_t start, uint32_t stop, char rowlead[])
+{
+    /** Variables **/
+    uint32_t    uint32Start;
+    uint32_t    uint32Stop;
+    uint8_t     uint8AdrDigits;
+    uint8_t     row[16];
+    uint8_t*    uint8PtrRow;
+
+    /* check */
+    if ( start > stop ) {
+        return;
+    }
+    /* assign address to multiples of 16 */
+    uint32Start = start & (uint32_t) ~0xF;  // start at 0
+    uint32Stop = stop | (uint32_t) 0xF;     // stop at 15
+    /* leading zeros in adr */
+    uint8AdrDigits = sfm_adr_digits( uint32Stop );
+    /* dump to console */
+    for ( uint32_t i = uint32Start; i < uint32Stop; i += 16 ) {
+        /* address */
+        printf("%s%0*x: ", rowlead, uint8AdrDigits, i);  // memory address
+        /* row data */
+        if ( NULL != self ) {
+            sfm_mem_rd(self, i, row, sizeof(row));
+            uint8PtrRow = row;
+        } else {
+            uint8PtrRow = data + i;
+        }
+        /* 16 byte per row */
+        for ( uint32_t j = 0; j < 16; j++ ) {
+            /* hex number */
+            printf("%02x ", uint8PtrRow[j]);
+            /* divide high/low bytes */
+            if ( 7 == j ) {
+                printf(" ");
+            }
+        }
+        printf("\n");   // new row
+    }
+    /* end */
+    return;
+}
+
+
+
+/** @brief sfm_log2_uint32
+ *
+ *  binary logarithm of power of two
+ *
+ *  @param[in]      val             power of two
+ *  @return         uint8_t         log2(val)
+ *
+ */
+static uint8_t sfm_log2_uint32 (uint32_t val)
+{
+    /** Variables **/
+    uint8_t     uint8Log2 = 0;
+
+    while ( val > 1 ) {
+        val >>= 1;
+        uint8Log2++;
+    }
+    return uint8Log2;
+}
+
+
+
+/** @brief sfm_desc_ist_opt
+ *
+ *  assigns optional instruction to handler
+ *
+ *  @param[in,out]  desc            runtime descriptor
+ *  @param[in]      ist             instruction, 0: not supported by flash
+ *  @param[in]      hdl             instruction handler
+ *
+ */
+static void sfm_desc_ist_opt (t_sfm_desc *desc, uint8_t ist, uint8_t hdl)
+{
+    if ( 0 != ist ) {
+        desc->uint8IstHdl[ist] = hdl;
+    }
+}
+
+
+
+/** @brief sfm_desc_adr_mode
+ *
+ *  packet lengths of address mode
+ *
+ *  @param[in,out]  desc            runtime descriptor
+ *  @param[in]      flash           selected flash
+ *  @param[in]      adrBytes        address bytes of mode
+ *
+ */
+static void sfm_desc_adr_mode (t_sfm_desc *desc, const t_sfm_type *flash, uint8_t adrBytes)
+{
+    desc->uint8AdrBytes = adrBytes;
+    desc->uint32AdrIstLen = (uint32_t) (1 + adrBytes);
+    desc->uint32RdFastLen = desc->uint32AdrIstLen + flash->uint8FlashTopoRdFastDummyCyc / 8u;              // dummy clocks on one lane
+    desc->uint32RdQuadIoLen = desc->uint32AdrIstLen + 1 + flash->uint8FlashTopoRdQuadIoDummyCyc / 2u;    // mode and dummy clocks on four lanes
+}
+
+
+
+/** @brief sfm_desc_compile
+ *
+ *  compiles selected flash type into runtime descriptor
+ *
+ *  @param[in,out]  self            handle
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   ID does not fit into descriptor; @see #SFM_E
+ *
+ */
+static int sfm_desc_compile (t_sfm *self)
+{
+    /** Variables **/
+    const t_sfm_type*   flash = self->flashType;    // selected flash
+    t_sfm_desc*         desc = &self->desc;         // runtime descriptor
+    uint32_t            uint32IdLen;                // ID length
+
+    /* instruction dispatch, lowest priority first, so that first match of former if/else chain wins */
+    memset(desc->uint8IstHdl, SFM_HDL_UNKNOWN, sizeof(desc->uint8IstHdl));
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstAdr4BExit, SFM_HDL_ADR_4B_EXIT);     // optional instructions, 0: not supported
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstAdr4BEnter, SFM_HDL_ADR_4B_ENTER);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstEraseBlock4B, SFM_HDL_ERASE_BLOCK_4B);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstEraseBlock, SFM_HDL_ERASE_BLOCK);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstEraseSector4B, SFM_HDL_ERASE_SECTOR_4B);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstWrPage4B, SFM_HDL_WR_PAGE_4B);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstRdData4B, SFM_HDL_RD_DATA_4B);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstRdQuadIo, SFM_HDL_RD_QUAD_IO);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstRdQuadOut, SFM_HDL_RD_QUAD_OUT);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstRdDualOut, SFM_HDL_RD_DUAL_OUT);
+    sfm_desc_ist_opt(desc, flash->uint8FlashIstRdFast, SFM_HDL_RD_FAST);
+    desc->uint8IstHdl[flash->uint8FlashIstWrPage]       = SFM_HDL_WR_PAGE;
+    desc->uint8IstHdl[flash->uint8FlashIstRdData]       = SFM_HDL_RD_DATA;
+    desc->uint8IstHdl[flash->uint8FlashIstRdStateReg]   = SFM_HDL_RD_STATE_REG;
+    desc->uint8IstHdl[flash->uint8FlashIstEraseSector]  = SFM_HDL_ERASE_SECTOR;
+    desc->uint8IstHdl[flash->uint8FlashIstEraseBulk]    = SFM_HDL_ERASE_BULK;
+    desc->uint8IstHdl[flash->uint8FlashIstWrDisable]    = SFM_HDL_WR_DIS;
+    desc->uint8IstHdl[flash->uint8FlashIstWrEnable]     = SFM_HDL_WR_ENA;
+    desc->uint8IstHdl[flash->uint8FlashIstRdID]         = SFM_HDL_RD_ID;
+    /* binary ID */
+    if ( SFM_OK != sfm_asciihex_to_uint8(flash->charFlashIdHex, desc->uint8Id, &uint32IdLen, sizeof(desc->uint8Id)/sizeof(desc->uint8Id[0])) ) {
+        return SFM_E_MALLOC;
+    }
+    desc->uint8IdLen = (uint8_t) uint32IdLen;
+    /* packet length */
+    desc->uint32RdIdLen = (uint32_t) (1 + flash->uint8FlashTopoRdIdDummyByte + desc->uint8IdLen);
+    sfm_desc_adr_mode(desc, flash, flash->uint8FlashTopoAdrBytes);  // power up address mode
+    /* topology */
+    desc->uint8PageShift = sfm_log2_uint32(flash->uint32FlashTopoPageSizeByte);
+    desc->uint8SectorShift = sfm_log2_uint32(flash->uint32FlashTopoSectorSizeByte);
+    desc->uint32PageMsk = flash->uint32FlashTopoPageSizeByte - 1;
+    desc->uint32SectorMsk = flash->uint32FlashTopoSectorSizeByte - 1;
+    desc->uint32TotalMsk = flash->uint32FlashTopoTotalSizeByte - 1;
+    desc->uint32SectorNum = flash->uint32FlashTopoTotalSizeByte >> desc->uint8SectorShift;
+    desc->uint32BlockMsk = (0 != flash->uint32FlashTopoBlockSizeByte) ? (flash->uint32FlashTopoBlockSizeByte - 1) : desc->uint32SectorMsk;
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/**
+ *  @typedef t_sfm_catalog_part
+ *
+ *  @brief  catalog entry
+ *
+ *  part with hash keys of #t_sfm_catalog index
+ */
+typedef struct {
+    const t_sfm_type*   type;               /**<  part, #SPI_FLASH entry or loaded part */
+    uint32_t            uint32NameHash;     /**<  hash of case folded name */
+    uint32_t            uint32IdHash;       /**<  hash of binary ID */
+    uint8_t             uint8Id[10];        /**<  Manufacturer / Device ID, binary */
+    uint8_t             uint8IdLen;         /**<  Number of bytes in uint8Id */
+} t_sfm_catalog_part;
+
+
+
+/**
+ *  @typedef t_sfm_catalog
+ *
+ *  @brief  part catalog
+ *
+ *  compiled in #SPI_FLASH and parts of #sfm_catalog_load, open addressing hash
+ *  index by name and by ID, slot holds part number + 1, 0: empty slot. Parts
+ *  added later replace parts with same name or ID in the index
+ */
+typedef struct {
+    t_sfm_catalog_part* parts;              /**<  catalog entries */
+    uint32_t            uint32Num;          /**<  number of entries */
+    uint32_t            uint32Max;          /**<  allocated entries */
+    uint32_t*           uint32PtrName;      /**<  name index */
+    uint32_t*           uint32PtrId;        /**<  ID index */
+    uint32_t            uint32Msk;          /**<  index slots - 1 */
+    pthread_mutex_t     mutex;              /**<  guards catalog */
+} t_sfm_catalog;
+
+/** Part catalog of all handles, built on first lookup **/
+static t_sfm_catalog sfmCatalog = {NULL, 0, 0, NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER};
+
+
+
+/** @brief sfm_catalog_hash
+ *
+ *  FNV-1a hash
+ *
+ *  @param[in]      *key            key bytes
+ *  @param[in]      len             number of key bytes
+ *  @param[in]      fold            1: case folded
+ *  @return         uint32_t        hash
+ *
+ */
+static uint32_t sfm_catalog_hash (const uint8_t *key, size_t len, int fold)
+{
+    /** Variables **/
+    uint32_t    uint32Hash = 2166136261u;   // offset basis
+
+    for ( size_t i = 0; i < len; i++ ) {
+        uint32Hash ^= (0 != fold) ? (uint32_t) tolower(key[i]) : key[i];
+        uint32Hash *= 16777619u;
+    }
+    return uint32Hash;
+}
+
+
+
+/** @brief sfm_catalog_slot
+ *
+ *  inserts entry into hash index, entry with same key is replaced
+ *
+ *  @param[in,out]  *cat            catalog
+ *  @param[in,out]  *idx            name or ID index
+ *  @param[in]      part            entry number
+ *  @param[in]      byName          1: name index, 0: ID index
+ *
+ */
+static void sfm_catalog_slot (t_sfm_catalog *cat, uint32_t *idx, uint32_t part, int byName)
+{
+    /** Variables **/
+    const t_sfm_catalog_part*   ins = &cat->parts[part];    // inserted entry
+    const t_sfm_catalog_part*   cur;                        // entry in slot
+    uint32_t                    uint32Slot;                 // probed slot
+
+    uint32Slot = ((0 != byName) ? ins->uint32NameHash : ins->uint32IdHash) & cat->uint32Msk;
+    while ( 0 != idx[uint32Slot] ) {
+        cur = &cat->parts[idx[uint32Slot] - 1];
+        if ( (0 != byName) ? (0 == strcasecmp(cur->type->charFlashName, ins->type->charFlashName))
+                           : ((cur->uint8IdLen == ins->uint8IdLen) && (0 == memcmp(cur->uint8Id, ins->uint8Id, ins->uint8IdLen))) ) {
+            break;
+        }
+        uint32Slot = (uint32Slot + 1) & cat->uint32Msk;
+    }
+    idx[uint32Slot] = part + 1;
+}
+
+
+
+/** @brief sfm_catalog_add
+ *
+ *  appends part to catalog and index, index grows at half load
+ *
+ *  @param[in,out]  *cat            catalog
+ *  @param[in]      type            part, stays valid while catalog exists
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_catalog_add (t_sfm_catalog *cat, const t_sfm_type *type)
+{
+    /** Variables **/
+    t_sfm_catalog_part* part;       // new entry
+    void*               ptr;        // reallocated memory
+    uint32_t*           name;       // new name index
+    uint32_t*           id;         // new ID index
+    uint32_t            uint32Len;  // ID length
+    uint32_t            uint32Slots;// index slots
+
+    /* entry */
+    if ( cat->uint32Num == cat->uint32Max ) {
+        ptr = realloc(cat->parts, (size_t) (2 * cat->uint32Max + 16) * sizeof(t_sfm_catalog_part));
+        if ( NULL == ptr ) {
+            return SFM_E_MALLOC;
+        }
+        cat->parts = (t_sfm_catalog_part*) ptr;
+        cat->uint32Max = 2 * cat->uint32Max + 16;
+    }
+    part = &cat->parts[cat->uint32Num];
+    part->type = type;
+    if ( SFM_OK != sfm_asciihex_to_uint8(type->charFlashIdHex, part->uint8Id, &uint32Len, sizeof(part->uint8Id)) ) {
+        return SFM_E_MALLOC;
+    }
+    part->uint8IdLen = (uint8_t) uint32Len;
+    part->uint32NameHash = sfm_catalog_hash((const uint8_t*) type->charFlashName, strlen(type->charFlashName), 1);
+    part->uint32IdHash = sfm_catalog_hash(part->uint8Id, part->uint8IdLen, 0);
+    cat->uint32Num++;
+    /* grow index, rebuild in catalog order */
+    if ( 2 * cat->uint32Num > cat->uint32Msk ) {
+        uint32Slots = 2 * (cat->uint32Msk + 1);
+        if ( 64 > uint32Slots ) {
+            uint32Slots = 64;
+        }
+        name = (uint32_t*) calloc(uint32Slots, sizeof(uint32_t));
+        id = (uint32_t*) calloc(uint32Slots, sizeof(uint32_t));
+        if ( (NULL == name) || (NULL == id) ) {
+            free(name);
+            free(id);
+            cat->uint32Num--;
+            return SFM_E_MALLOC;
+        }
+        free(cat->uint32PtrName);
+        free(cat->uint32PtrId);
+        cat->uint32PtrName = name;
+        cat->uint32PtrId = id;
+        cat->uint32Msk = uint32Slots - 1;
+        for ( uint32_t i = 0; i < cat->uint32Num - 1; i++ ) {
+            sfm_catalog_slot(cat, cat->uint32PtrName, i, 1);
+            sfm_catalog_slot(cat, cat->uint32PtrId, i, 0);
+        }
+    }
+    sfm_catalog_slot(cat, cat->uint32PtrName, cat->uint32Num - 1, 1);
+    sfm_catalog_slot(cat, cat->uint32PtrId, cat->uint32Num - 1, 0);
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_catalog_ready
+ *
+ *  adds compiled in #SPI_FLASH parts on first use, caller holds catalog lock
+ *
+ *  @param[in,out]  *cat            catalog
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_catalog_ready (t_sfm_catalog *cat)
+{
+    if ( 0 != cat->uint32Num ) {
+        return SFM_OK;
+    }
+    for ( uint32_t i = 0; i < sizeof(SPI_FLASH)/sizeof(SPI_FLASH[0]) - 1; i++ ) {
+        if ( SFM_OK != sfm_catalog_add(cat, &SPI_FLASH[i]) ) {
+            return SFM_E_MALLOC;
+        }
+    }
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_catalog_name
+ *
+ *  looks up part by case insensitive name
+ *
+ *  @param[in]      name            part name
+ *  @return         t_sfm_type*     part, NULL: unknown
+ *
+ */
+static const t_sfm_type* sfm_catalog_name (const char name[])
+{
+    /** Variables **/
+    t_sfm_catalog*      cat = &sfmCatalog;  // catalog
+    const t_sfm_type*   type = NULL;        // found part
+    uint32_t            uint32Slot;         // probed slot
+
+    pthread_mutex_lock(&cat->mutex);
+    if ( SFM_OK == sfm_catalog_ready(cat) ) {
+        uint32Slot = sfm_catalog_hash((const uint8_t*) name, strlen(name), 1) & cat->uint32Msk;
+        while ( 0 != cat->uint32PtrName[uint32Slot] ) {
+            if ( 0 == strcasecmp(name, cat->parts[cat->uint32PtrName[uint32Slot] - 1].type->charFlashName) ) {
+                type = cat->parts[cat->uint32PtrName[uint32Slot] - 1].type;
+                break;
+            }
+            uint32Slot = (uint32Slot + 1) & cat->uint32Msk;
+        }
+    }
+    pthread_mutex_unlock(&cat->mutex);
+    return type;
+}
+
+
+
+/** @brief sfm_catalog_hex
+ *
+ *  checks ASCII hex ID of catalog file
+ *
+ *  @param[in]      hex             ID string
+ *  @return         int             1: valid, 0: invalid
+ *
+ */
+static int sfm_catalog_hex (const char hex[])
+{
+    /** Variables **/
+    size_t  len = strlen(hex);  // number of digits
+
+    if ( (0 == len) || (0 != (len & 1)) || (len >= sizeof(((t_sfm_type*) 0)->charFlashIdHex)) ) {
+        return 0;
+    }
+    for ( size_t i = 0; i < len; i++ ) {
+        if ( 0 == isxdigit((unsigned char) hex[i]) ) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+
+/** @brief sfm_catalog_pow2
+ *
+ *  @param[in]      val             value
+ *  @return         int             1: power of two, 0: otherwise
+ *
+ */
+static int sfm_catalog_pow2 (unsigned long val)
+{
+    return (0 != val) && (0 == (val & (val - 1)));
+}
+
+
+
+/** @brief sfm_catalog_line
+ *
+ *  decodes one catalog file line, fields in order of #t_sfm_type
+ *
+ *  @param[in,out]  *line           text line, tokenized
+ *  @param[out]     *part           decoded part
+ *  @return         int             1: part, 0: empty or comment line, -1: malformed
+ *
+ */
+static int sfm_catalog_line (char *line, t_sfm_type *part)
+{
+    /** Variables **/
+    char*           tok;        // field
+    char*           save;       // tokenizer state
+    char*           end;        // end of number
+    unsigned long   val[SFM_CAT_NUM];   // numeric fields
+    unsigned long   adrMax;     // address bytes, 4-byte address instructions included
+
+    /* name and ID */
+    tok = strtok_r(line, " \t\r\n", &save);
+    if ( (NULL == tok) || ('#' == tok[0]) ) {
+        return 0;
+    }
+    if ( strlen(tok) >= sizeof(part->charFlashName) ) {
+        return -1;
+    }
+    memset(part, 0, sizeof(*part));
+    strcpy(part->charFlashName, tok);
+    tok = strtok_r(NULL, " \t\r\n", &save);
+    if ( (NULL == tok) || (0 == sfm_catalog_hex(tok)) ) {
+        return -1;
+    }
+    strcpy(part->charFlashIdHex, tok);
+    /* numbers, decimal or 0x prefixed hex */
+    for ( uint32_t i = 0; i < sizeof(val)/sizeof(val[0]); i++ ) {
+        tok = strtok_r(NULL, " \t\r\n", &save);
+        if ( NULL == tok ) {
+            return -1;
+        }
+        val[i] = strtoul(tok, &end, 0);
+        if ( ('\0' != *end) || (0xffffffffUL < val[i]) ) {
+            return -1;
+        }
+        if ( ((i <= SFM_CAT_ADR_BYTES) || ((i >= SFM_CAT_RD_ID_DUMMY) && (i <= SFM_CAT_WR_ENA_MSK))) && (0xff < val[i]) ) {  // byte fields
+            return -1;
+        }
+    }
+    tok = strtok_r(NULL, " \t\r\n", &save);
+    if ( (NULL != tok) && ('#' != tok[0]) ) {
+        return -1;
+    }
+    /* topology */
+    adrMax = ((0 != val[SFM_CAT_ADR_4B_ENTER]) || (0 != val[SFM_CAT_RD_DATA_4B]) || (0 != val[SFM_CAT_WR_PAGE_4B]) || (0 != val[SFM_CAT_ERASE_SECTOR_4B])
+              || (0 != val[SFM_CAT_ERASE_BLOCK_4B])) ? SFM_ADR_4B : val[SFM_CAT_ADR_BYTES];
+    if ( (val[SFM_CAT_ADR_BYTES] < 1) || (val[SFM_CAT_ADR_BYTES] > SFM_ADR_4B) || (0 == sfm_catalog_pow2(val[SFM_CAT_SECTOR_SIZE]))
+         || (0 == sfm_catalog_pow2(val[SFM_CAT_PAGE_SIZE])) || (0 == sfm_catalog_pow2(val[SFM_CAT_TOTAL_SIZE]))
+         || (val[SFM_CAT_PAGE_SIZE] > val[SFM_CAT_SECTOR_SIZE]) || (val[SFM_CAT_SECTOR_SIZE] > val[SFM_CAT_TOTAL_SIZE])
+         || ((unsigned long long) val[SFM_CAT_TOTAL_SIZE] > (1ULL << (8 * adrMax))) || (0 == val[SFM_CAT_WIP_MSK]) || (0 == val[SFM_CAT_WR_ENA_MSK]) ) {
+        return -1;
+    }
+    /* block, only with Block Erase */
+    if ( ((0 != val[SFM_CAT_ERASE_BLOCK]) || (0 != val[SFM_CAT_ERASE_BLOCK_4B]) || (0 != val[SFM_CAT_BLOCK_SIZE]))
+         && ((0 == sfm_catalog_pow2(val[SFM_CAT_BLOCK_SIZE])) || (val[SFM_CAT_SECTOR_SIZE] > val[SFM_CAT_BLOCK_SIZE]) || (val[SFM_CAT_BLOCK_SIZE] > val[SFM_CAT_TOTAL_SIZE])) ) {
+        return -1;
+    }
+    /* dummy clocks, whole bytes on the lanes and header fits the chip select packet buffer */
+    if ( (0 != (val[SFM_CAT_RD_FAST_DUMMY] % 8)) || (0 != (val[SFM_CAT_RD_QUAD_IO_DUMMY] % 2))
+         || ((2 + adrMax + val[SFM_CAT_RD_FAST_DUMMY] / 8) > SFM_CS_PKT_MAX) || ((2 + adrMax + val[SFM_CAT_RD_QUAD_IO_DUMMY] / 2) > SFM_CS_PKT_MAX) ) {
+        return -1;
+    }
+    part->uint8FlashIstRdID = (uint8_t) val[SFM_CAT_RD_ID];
+    part->uint8FlashIstWrEnable = (uint8_t) val[SFM_CAT_WR_ENA];
+    part->uint8FlashIstWrDisable = (uint8_t) val[SFM_CAT_WR_DIS];
+    part->uint8FlashIstEraseBulk = (uint8_t) val[SFM_CAT_ERASE_BULK];
+    part->uint8FlashIstEraseSector = (uint8_t) val[SFM_CAT_ERASE_SECTOR];
+    part->uint8FlashIstRdStateReg = (uint8_t) val[SFM_CAT_RD_SR];
+    part->uint8FlashIstRdData = (uint8_t) val[SFM_CAT_RD_DATA];
+    part->uint8FlashIstWrPage = (uint8_t) val[SFM_CAT_WR_PAGE];
+    part->uint8FlashIstRdFast = (uint8_t) val[SFM_CAT_RD_FAST];
+    part->uint8FlashIstRdDualOut = (uint8_t) val[SFM_CAT_RD_DUAL_OUT];
+    part->uint8FlashIstRdQuadOut = (uint8_t) val[SFM_CAT_RD_QUAD_OUT];
+    part->uint8FlashIstRdQuadIo = (uint8_t) val[SFM_CAT_RD_QUAD_IO];
+    part->uint8FlashIstEraseBlock = (uint8_t) val[SFM_CAT_ERASE_BLOCK];
+    part->uint8FlashIstAdr4BEnter = (uint8_t) val[SFM_CAT_ADR_4B_ENTER];
+    part->uint8FlashIstAdr4BExit = (uint8_t) val[SFM_CAT_ADR_4B_EXIT];
+    part->uint8FlashIstRdData4B = (uint8_t) val[SFM_CAT_RD_DATA_4B];
+    part->uint8FlashIstWrPage4B = (uint8_t) val[SFM_CAT_WR_PAGE_4B];
+    part->uint8FlashIstEraseSector4B = (uint8_t) val[SFM_CAT_ERASE_SECTOR_4B];
+    part->uint8FlashIstEraseBlock4B = (uint8_t) val[SFM_CAT_ERASE_BLOCK_4B];
+    part->uint8FlashTopoAdrBytes = (uint8_t) val[SFM_CAT_ADR_BYTES];
+    part->uint32FlashTopoSectorSizeByte = (uint32_t) val[SFM_CAT_SECTOR_SIZE];
+    part->uint32FlashTopoBlockSizeByte = (uint32_t) val[SFM_CAT_BLOCK_SIZE];
+    part->uint32FlashTopoPageSizeByte = (uint32_t) val[SFM_CAT_PAGE_SIZE];
+    part->uint32FlashTopoTotalSizeByte = (uint32_t) val[SFM_CAT_TOTAL_SIZE];
+    part->uint8FlashTopoRdIdDummyByte = (uint8_t) val[SFM_CAT_RD_ID_DUMMY];
+    part->uint8FlashTopoRdFastDummyCyc = (uint8_t) val[SFM_CAT_RD_FAST_DUMMY];
+    part->uint8FlashTopoRdQuadIoDummyCyc = (uint8_t) val[SFM_CAT_RD_QUAD_IO_DUMMY];
+    part->uint8FlashMngWipMsk = (uint8_t) val[SFM_CAT_WIP_MSK];
+    part->uint8FlashMngWrEnaMsk = (uint8_t) val[SFM_CAT_WR_ENA_MSK];
+    part->uint32FlashTimePageProgUs = (uint32_t) val[SFM_CAT_T_PP];
+    part->uint32FlashTimeSectorEraseUs = (uint32_t) val[SFM_CAT_T_SE];
+    part->uint32FlashTimeBlockEraseUs = (uint32_t) val[SFM_CAT_T_BE];
+    part->uint32FlashTimeChipEraseUs = (uint32_t) val[SFM_CAT_T_CE];
+    return 1;
+}
+
+
+
+/**
+ *  sfm_catalog_load
+ *    adds parts of catalog file
+ */
+int sfm_catalog_load (char fileName[])
+{
+    /** Variables **/
+    FILE*           fp;             // catalog file
+    char*           line = NULL;    // text line
+    size_t          lineLen = 0;    // allocated line buffer
+    uint32_t        uint32Line = 0; // line number
+    t_sfm_type*     parts = NULL;   // parsed parts
+    uint32_t        uint32Num = 0;  // number of parsed parts
+    uint32_t        uint32Max = 0;  // allocated parts
+    void*           ptr;            // reallocated memory
+    int             intRet = SFM_OK;// return value
+    int             intLine;        // line state
+
+    /* parse complete file, catalog stays unchanged on error */
+    fp = fopen(fileName, "r");
+    if ( NULL == fp ) {
+        printf("  ERROR:%s: can't open '%s'\n", __FUNCTION__, fileName);
+        return SFM_E_ACCESS;
+    }
+    while ( -1 != getline(&line, &lineLen, fp) ) {
+        uint32Line++;
+        if ( uint32Num == uint32Max ) {
+            ptr = realloc(parts, (size_t) (2 * uint32Max + 16) * sizeof(t_sfm_type));
+            if ( NULL == ptr ) {
+                intRet = SFM_E_MALLOC;
+                break;
+            }
+            parts = (t_sfm_type*) ptr;
+            uint32Max = 2 * uint32Max + 16;
+        }
+        intLine = sfm_catalog_line(line, &parts[uint32Num]);
+        if ( 0 > intLine ) {
+            printf("  ERROR:%s: %s:%u: malformed part\n", __FUNCTION__, fileName, uint32Line);
+            intRet = SFM_E_ACCESS;
+            break;
+        }
+        uint32Num += (uint32_t) intLine;
+    }
+    free(line);
+    fclose(fp);
+    if ( (SFM_OK != intRet) || (0 == uint32Num) ) {
+        free(parts);
+        return intRet;
+    }
+    /* parts are referenced by handles, stay allocated until process end */
+    pthread_mutex_lock(&sfmCatalog.mutex);
+    intRet = sfm_catalog_ready(&sfmCatalog);
+    for ( uint32_t i = 0; (SFM_OK == intRet) && (i < uint32Num); i++ ) {
+        intRet = sfm_catalog_add(&sfmCatalog, &parts[i]);
+    }
+    pthread_mutex_unlock(&sfmCatalog.mutex);
+    return intRet;
+}
+
+
+
+/**
+ *  sfm_catalog_id
+ *    part name of Manufacturer / Device ID
+ */
+const char* sfm_catalog_id (const uint8_t id[], uint32_t len)
+{
+    /** Variables **/
+    t_sfm_catalog*              cat = &sfmCatalog;  // catalog
+    const t_sfm_catalog_part*   part;               // entry in slot
+    const char*                 name = NULL;        // found part
+    uint32_t                    uint32Slot;         // probed slot
+
+    pthread_mutex_lock(&cat->mutex);
+    if ( SFM_OK == sfm_catalog_ready(cat) ) {
+        uint32Slot = sfm_catalog_hash(id, len, 0) & cat->uint32Msk;
+        while ( 0 != cat->uint32PtrId[uint32Slot] ) {
+            part = &cat->parts[cat->uint32PtrId[uint32Slot] - 1];
+            if ( (part->uint8IdLen == len) && (0 == memcmp(part->uint8Id, id, len)) ) {
+                name = part->type->charFlashName;
+                break;
+            }
+            uint32Slot = (uint32Slot + 1) & cat->uint32Msk;
+        }
+    }
+    pthread_mutex_unlock(&cat->mutex);
+    return name;
+}
+
+
+
+/** @brief sfm_wear_prog_free
+ *
+ *  releases program cycle counters of all sectors, sector directory is kept
+ *
+ *  @param[in,out]  self            handle
+ *
+ */
+static void sfm_wear_prog_free (t_sfm *self)
+{
+    for ( uint32_t i = 0; (NULL != self->wear.uint32PtrProg) && (0 != self->wear.uint32ProgAlloc) && (i < self->desc.uint32SectorNum); i++ ) {
+        if ( NULL != self->wear.uint32PtrProg[i] ) {
+            free(self->wear.uint32PtrProg[i]);
+            self->wear.uint32PtrProg[i] = NULL;
+            self->wear.uint32ProgAlloc--;
+        }
+    }
+}
+
+
+
+/** @brief sfm_init_fail
+ *
+ *  releases all memory of a failed initialisation, handle has no flash selected afterwards
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      ret             failure state
+ *  @return         int             ret
+ *
+ */
+static int sfm_init_fail (t_sfm *self, int ret)
+{
+    sfm_free(self);
+    self->flashType = NULL;
+    return ret;
+}
+
+
+
+/** @brief sfm_init_type
+ *
+ *  resets handle, selects flash type and allocates sector erase generations, no flash memory is allocated
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      flashType       name of emulated flash, see #SPI_FLASH and #sfm_catalog_load
+ *  @return         int             state
+ *  @retval         #SFM_OK         OKAY; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH no memory selected or unknown; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   FAIL; @see #SFM_E
+ *
+ */
+static int sfm_init_type (t_sfm *self, const char flashType[])
+{
+    /* init */
+    self->intMsgLevel = 0;                  // no messages
+    self->uint8PtrMem = NULL;               // not initialised
+    self->uint8PtrSector = NULL;            // no sparse memory
+    self->uint32PtrSecUsed = NULL;          // no sector state
+    self->uint32PtrSecGen = NULL;           // no erase generations
+    self->uint32EraseGen = 0;               // all sectors up to date
+    self->uint32SectorAlloc = 0;            // no sector allocated
+    self->intMmap = -1;                     // no memory mapped image
+    self->flashType = NULL;                 // no  memory selected
+    self->uint8StatusReg1 = 0;              // status register
+    self->uint8WipRdAfterWriteCnt = 0;      // ready for write access
+    self->intTimeMode = SFM_TIME_POLL;      // busy time in status polls
+    self->uint64TimeNs = 0;                 // virtual clock
+    self->uint64WipDoneNs = 0;              // no write in progress
+    self->bus.uint32SckHz = SFM_SCK_HZ;     // SPI clock
+    self->bus.uint64NsPerCycle = (1000000000ULL << 32) / SFM_SCK_HZ;
+    self->bus.uint64CycFast = (UINT64_MAX - 0xffffffffULL) / self->bus.uint64NsPerCycle;
+    self->bus.uint64NsFrac = 0;
+    self->bus.uint64Cycles = 0;             // no transfer
+    self->bus.uint64DataByte = 0;
+    memset(self->bus.uint64LaneByte, 0, sizeof(self->bus.uint64LaneByte));
+    self->cs.intActive = 0;                 // chip select released
+    self->wear.uint32PtrErase = NULL;       // no wear tracking
+    self->wear.uint32PtrProg = NULL;
+    self->wear.uint32ProgAlloc = 0;
+    self->wear.uint32EraseChip = 0;
+    self->wear.uint32EraseMax = 0;
+    self->wear.uint32Limit = 0;             // unlimited endurance
+#if SFM_TRACE
+    self->trace = NULL;                     // no transaction trace
+#endif
+#if SFM_STATS
+    memset(&self->stats, 0, sizeof(self->stats));  // no requests
+#endif
+    /* determine SPI flash by name */
+    self->flashType = sfm_catalog_name(flashType);
+    /* no memory found? */
+    if ( NULL == self->flashType ) {
+        return SFM_E_NO_FLASH;
+    }
+    /* runtime descriptor */
+    if ( SFM_OK != sfm_desc_compile(self) ) {
+        self->flashType = NULL;
+        return SFM_E_NO_FLASH;
+    }
+    /* erase generation and erase cycles per sector, directory of program cycles */
+    self->uint32PtrSecGen = (uint32_t*) calloc(self->desc.uint32SectorNum, sizeof(uint32_t));
+    self->wear.uint32PtrErase = (uint32_t*) calloc(self->desc.uint32SectorNum, sizeof(uint32_t));
+    self->wear.uint32PtrProg = (uint32_t**) calloc(self->desc.uint32SectorNum, sizeof(uint32_t*));
+    if ( (NULL == self->uint32PtrSecGen) || (NULL == self->wear.uint32PtrErase) || (NULL == self->wear.uint32PtrProg) ) {
+        return sfm_init_fail(self, SFM_E_MALLOC);
+    }
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_mem_sparse_init
+ *
+ *  allocates sector directory of sparse memory, all sectors unwritten
+ *
+ *  @param[in,out]  self            handle
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_MALLOC   memory allocation failed; @see #SFM_E
+ *
+ */
+static int sfm_mem_sparse_init (t_sfm *self)
+{
+    self->uint8PtrSector = (uint8_t**) calloc(self->desc.uint32SectorNum, sizeof(uint8_t*));
+    if ( NULL == self->uint8PtrSector ) {
+        return SFM_E_MALLOC;    // memory allocation fail
+    }
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_init
+ *    initialises spi flash model handle
+ */
+int sfm_init (t_sfm *self, const char flashType[])
+{
+    /** variables **/
+    int     intRet; // return value
+
+    /* select flash */
+    intRet = sfm_init_type(self, flashType);
+    if ( SFM_OK != intRet ) {
+        return intRet;
+    }
+    /* large flash, sectors allocated on first write instead of one blank image */
+    if ( self->flashType->uint32FlashTopoTotalSizeByte > SFM_FLAT_MAX_BYTE ) {
+        if ( SFM_OK != sfm_mem_sparse_init(self) ) {
+            return sfm_init_fail(self, SFM_E_MALLOC);
+        }
+        return SFM_OK;
+    }
+    /* allocate memory, all sectors blank */
+    if ( SFM_OK != sfm_mem_used_init(self, 0) ) {
+        return sfm_init_fail(self, SFM_E_MALLOC);
+    }
+    self->uint8PtrMem = (uint8_t*) malloc(self->flashType->uint32FlashTopoTotalSizeByte);
+    if ( NULL == self->uint8PtrMem ) {
+        return sfm_init_fail(self, SFM_E_MALLOC);   // memory allocation fail
+    }
+    /* make memory empty */
+    memset(self->uint8PtrMem, 0xff, self->flashType->uint32FlashTopoTotalSizeByte);
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_init_sparse
+ *    initialises spi flash model handle with sparse memory
+ */
+int sfm_init_sparse (t_sfm *self, const char flashType[])
+{
+    /** variables **/
+    int     intRet; // return value
+
+    /* select flash */
+    intRet = sfm_init_type(self, flashType);
+    if ( SFM_OK != intRet ) {
+        return intRet;
+    }
+    /* allocate sector directory, all sectors unwritten */
+    if ( SFM_OK != sfm_mem_sparse_init(self) ) {
+        return sfm_init_fail(self, SFM_E_MALLOC);
+    }
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_init_mmap
+ *    initialises spi flash model handle with memory mapped flash image
+ */
+int sfm_init_mmap (t_sfm *self, const char flashType[], char fileName[], int mode)
+{
+    /** variables **/
+    int         intRet;     // return value
+    int         fd;         // image file
+    struct stat st;         // file status
+    size_t      total;      // flash size
+    void*       mem;        // mapped memory
+
+    /* select flash */
+    intRet = sfm_init_type(self, flashType);
+    if ( SFM_OK != intRet ) {
+        return intRet;
+    }
+    total = self->flashType->uint32FlashTopoTotalSizeByte;
+    /* open image */
+    fd = open(fileName, (SFM_MMAP_PRIVATE == mode) ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    if ( 0 > fd ) {
+        if ( SFM_MMAP_PRIVATE != mode ) {
+            return sfm_init_fail(self, SFM_E_ACCESS);
+        }
+        st.st_size = 0; // throwaway run without image, empty flash
+    } else if ( 0 != fstat(fd, &st) ) {
+        close(fd);
+        return sfm_init_fail(self, SFM_E_ACCESS);
+    }
+    if ( (size_t) st.st_size > total ) {
+        if ( 0 <= fd ) {
+            close(fd);
+        }
+        return sfm_init_fail(self, SFM_E_ACCESS);   // image does not fit to flash type
+    }
+    /* map image */
+    if ( SFM_MMAP_PRIVATE != mode ) {
+        if ( ((size_t) st.st_size < total) && (0 != ftruncate(fd, (off_t) total)) ) {
+            close(fd);
+            return sfm_init_fail(self, SFM_E_ACCESS);
+        }
+        mem = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    } else if ( (size_t) st.st_size == total ) {
+        mem = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    } else {    // short image, private copy with padding
+        mem = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if ( (MAP_FAILED != mem) && (0 < st.st_size) && (st.st_size != pread(fd, mem, (size_t) st.st_size, 0)) ) {
+            munmap(mem, total);
+            close(fd);
+            return sfm_init_fail(self, SFM_E_ACCESS);
+        }
+    }
+    if ( 0 <= fd ) {
+        close(fd);  // mapping keeps file referenced
+    }
+    if ( MAP_FAILED == mem ) {
+        return sfm_init_fail(self, SFM_E_MALLOC);
+    }
+    /* image content is unknown, padding is blank */
+    if ( SFM_OK != sfm_mem_used_init(self, (uint32_t) (((size_t) st.st_size + self->desc.uint32SectorMsk) >> self->desc.uint8SectorShift)) ) {
+        munmap(mem, total);
+        return sfm_init_fail(self, SFM_E_MALLOC);
+    }
+    /* pad short image with empty flash */
+    memset((uint8_t*) mem + st.st_size, 0xff, total - (size_t) st.st_size);
+    self->uint8PtrMem = (uint8_t*) mem;
+    self->intMmap = (SFM_MMAP_PRIVATE == mode) ? SFM_MMAP_PRIVATE : SFM_MMAP_SHARED;
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_flush
+ *    synchronizes memory mapped flash image
+ */
+int sfm_flush (t_sfm *self)
+{
+    /* flash type selected */
+    if ( NULL == self->flashType ) {
+        return SFM_E_NO_FLASH;
+    }
+    /* pending erases */
+    if ( 0 != sfm_mem_ready(self) ) {
+        sfm_mem_settle_all(self);
+    }
+    /* write back */
+    if ( SFM_MMAP_SHARED == self->intMmap ) {
+        if ( 0 != msync(self->uint8PtrMem, self->flashType->uint32FlashTopoTotalSizeByte, MS_SYNC) ) {
+            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: msync failed\n", __FUNCTION__); }
+            return SFM_E_ACCESS;
+        }
+    }
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_free
+ *    releases flash emulation memory
+ */
+int sfm_free (t_sfm *self)
+{
+#if SFM_TRACE
+    /* pending trace */
+    sfm_trace_close(self);
+#endif
+    /* sparse memory */
+    if ( NULL != self->uint8PtrSector ) {
+        sfm_mem_erase(self, 0, self->desc.uint32SectorNum);
+        free(self->uint8PtrSector);
+        self->uint8PtrSector = NULL;
+    }
+    /* memory mapped image */
+    if ( 0 <= self->intMmap ) {
+        sfm_flush(self);
+        munmap(self->uint8PtrMem, self->flashType->uint32FlashTopoTotalSizeByte);
+        self->uint8PtrMem = NULL;
+        self->intMmap = -1;
+    }
+    /* flat memory */
+    free(self->uint8PtrMem);
+    self->uint8PtrMem = NULL;
+    free(self->uint32PtrSecUsed);
+    self->uint32PtrSecUsed = NULL;
+    free(self->uint32PtrSecGen);
+    self->uint32PtrSecGen = NULL;
+    free(self->wear.uint32PtrErase);
+    self->wear.uint32PtrErase = NULL;
+    sfm_wear_prog_free(self);
+    free(self->wear.uint32PtrProg);
+    self->wear.uint32PtrProg = NULL;
+    self->uint32SectorAlloc = 0;
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_mem_usage
+ *    allocated memory for flash emulation
+ */
+int sfm_mem_usage (t_sfm *self, size_t *used)
+{
+    /* flash type selected */
+    if ( NULL == self->flashType ) {
+        return SFM_E_NO_FLASH;
+    }
+    /* allocated bytes */
+    *used = 0;
+    if ( NULL != self->uint8PtrMem ) {
+        *used = self->flashType->uint32FlashTopoTotalSizeByte + ((self->desc.uint32SectorNum + 31) / 32) * sizeof(uint32_t);
+    } else if ( NULL != self->uint8PtrSector ) {
+        *used = self->desc.uint32SectorNum * sizeof(uint8_t*) + (size_t) self->uint32SectorAlloc * self->flashType->uint32FlashTopoSectorSizeByte;
+    }
+    /* erase generations, erase and program cycles */
+    *used += self->desc.uint32SectorNum * (2 * sizeof(uint32_t) + sizeof(uint32_t*));
+    *used += ((size_t) self->wear.uint32ProgAlloc * sizeof(uint32_t)) << (self->desc.uint8SectorShift - self->desc.uint8PageShift);
+    /* report */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:%s: %zu of %u bytes allocated, %u of %u sectors written\n", __FUNCTION__, *used, self->flashType->uint32FlashTopoTotalSizeByte, self->uint32SectorAlloc, self->desc.uint32SectorNum);
+    }
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_blank_check
+ *    checks flash range for erased state
+ */
+int sfm_blank_check (t_sfm *self, uint32_t adr, uint32_t len, uint32_t *used)
+{
+    /** Variables **/
+    uint32_t    uint32Seg;      // bytes in current sector
+    uint32_t    i;              // programmed byte in sector
+    uint8_t*    uint8PtrSec;    // sector storage
+
+    /* flash type selected */
+    if ( NULL == self->flashType ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); }
+        return SFM_E_NO_FLASH;
+    }
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+        return SFM_E_MALLOC;
+    }
+    /* range inside flash */
+    if ( (uint64_t) adr + len > self->flashType->uint32FlashTopoTotalSizeByte ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: range 0x%x+0x%x exceeds flash\n", __FUNCTION__, adr, len); }
+        return SFM_E_ACCESS;
+    }
+    /* blank sectors are skipped, written sectors are scanned */
+    while ( len > 0 ) {
+        uint32Seg = sfm_min_uint32(len, self->flashType->uint32FlashTopoSectorSizeByte - (adr & self->desc.uint32SectorMsk));
+        uint8PtrSec = sfm_mem_sector(self, adr >> self->desc.uint8SectorShift, 0);
+        if ( NULL != uint8PtrSec ) {
+            i = sfm_cmp_scan(NULL, uint8PtrSec + (adr & self->desc.uint32SectorMsk), uint32Seg, 1);
+            if ( i < uint32Seg ) {
+                if ( NULL != used ) {
+                    *used = adr + i;
+                }
+                return SFM_E_CMP;
+            }
+        }
+        adr += uint32Seg;
+        len -= uint32Seg;
+    }
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_dump
+ *    dumps flash to console
+ */
+int sfm_dump (t_sfm *self, uint32_t start, uint32_t stop)
+{
+    /** Variables **/
+    uint32_t    uint32Start;    // stop address
+    uint32_t    uint32Stop;     // start address
+
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* flash type selected */
+    if ( NULL == self->flashType ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); };
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); };
+        return SFM_E_MALLOC;
+    }
+
+    /* default args */
+    uint32Start = start;
+    uint32Stop = stop;
+    if ( UINT32_MAX == start ) {
+        uint32Start = 0;
+    }
+    if ( UINT32_MAX == stop ) {
+        uint32Stop = self->flashType->uint32FlashTopoTotalSizeByte - 1;
+    }
+
+    /* inside address range */
+    if ( uint32Stop  > self->flashType->uint32FlashTopoTotalSizeByte - 1 ||
+         uint32Start > self->flashType->uint32FlashTopoTotalSizeByte - 1
+    ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: flash address out of range\n", __FUNCTION__); }
+        return SFM_E_ACCESS;
+    }
+
+    /* dump flash to console */
+    sfm_hexdump_uint8 (self, NULL, uint32Start, uint32Stop, "");
+
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+#if SFM_STATS
+/** Error code names of #t_sfm_stats::uint64Err **/
+static const char* const SFM_STATS_ERR_NAME[SFM_STATS_ERR_NUM] = {
+    "SFM_E_NO_FLASH",
+    "SFM_E_MALLOC",
+    "SFM_E_ACCESS",
+    "SFM_E_IST_FLASH",
+    "SFM_E_WP_FLASH",
+    "SFM_E_WIP_FLASH",
+    "SFM_E_CMP",
+    "SFM_E_CS",
+    "SFM_E_WEAR"
+};
+
+/** File operation names of #t_sfm_stats::file **/
+static const char* const SFM_STATS_FILE_NAME[SFM_STATS_FILE_NUM] = {
+    "load",
+    "store",
+    "cmp"
+};
+
+
+
+/** @brief sfm_stats_cnt
+ *
+ *  counts one request
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  cnt             request counter
+ *  @param[in]      len             request length
+ *  @param[in]      ret             request state, @see #SFM_E
+ *
+ */
+static void sfm_stats_cnt (t_sfm *self, t_sfm_stats_cnt *cnt, uint32_t len, int ret)
+{
+    if ( (0 == cnt->uint64Calls) || (len < cnt->uint32LenMin) ) {
+        cnt->uint32LenMin = len;
+    }
+    if ( len > cnt->uint32LenMax ) {
+        cnt->uint32LenMax = len;
+    }
+    cnt->uint64Calls++;
+    cnt->uint64Bytes += len;
+    if ( SFM_OK != ret ) {
+        cnt->uint64Errors++;
+        for ( uint8_t i = 0; i < SFM_STATS_ERR_NUM; i++ ) {
+            if ( 0 != (ret & (1 << i)) ) {
+                self->stats.uint64Err[i]++;
+            }
+        }
+    }
+}
+
+
+
+/** @brief sfm_stats_ist
+ *
+ *  counts spi packet
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      ist             instruction
+ *  @param[in]      len             spi packet length
+ *  @param[in]      ret             packet state, @see #SFM_E
+ *
+ */
+static inline void sfm_stats_ist (t_sfm *self, uint8_t ist, uint32_t len, int ret)
+{
+    sfm_stats_cnt(self, &self->stats.ist[ist], len, ret);
+}
+
+
+
+/** @brief sfm_stats_file
+ *
+ *  counts file operation, bytes are the file size
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      op              operation, #SFM_STATS_FILE
+ *  @param[in]      fileName        path to file
+ *  @param[in]      ret             operation state, @see #SFM_E
+ *
+ */
+static void sfm_stats_file (t_sfm *self, int op, const char fileName[], int ret)
+{
+    /** Variables **/
+    struct stat     st;             // file state
+    uint32_t        uint32Len = 0;  // file size
+
+    if ( (NULL != fileName) && (0 == stat(fileName, &st)) && (st.st_size > 0) ) {
+        uint32Len = (st.st_size > (off_t) UINT32_MAX) ? UINT32_MAX : (uint32_t) st.st_size;
+    }
+    sfm_stats_cnt(self, &self->stats.file[op], uint32Len, ret);
+}
+#else
+/* compiled out */
+static inline void sfm_stats_ist (t_sfm *self, uint8_t ist, uint32_t len, int ret) { (void) self; (void) ist; (void) len; (void) ret; }
+static inline void sfm_stats_file (t_sfm *self, int op, const char fileName[], int ret) { (void) self; (void) op; (void) fileName; (void) ret; }
+#endif
+
+
+
+/** @brief sfm_store_img
+ *
+ *  stores flash into file, format selected by file extension
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName        path to file
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *
+ */
+static int sfm_store_img (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    char*       charPtrFileExt;     // pointer to file extension
+    int         intRet;             // return value
+
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* flash type selected */
+    if ( NULL == self->flashType ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); }
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+        return SFM_E_MALLOC;
+    }
+
+    /* check desired file extension */
+    charPtrFileExt = sfm_file_ext(fileName);
+    /* no file extension */
+    if ( !charPtrFileExt ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: No file name\n", __FUNCTION__); }
+        return SFM_E_ACCESS;
+
+    /* dif extension */
+    } else if ( 0 == strcasecmp("dif", charPtrFileExt) ) {
+        /* entry message */
+        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
+        /* File write */
+        if ( 0 != sfm_write_dif ( self, fileName ) ) {
+            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: failed to open file '%s'\n", __FUNCTION__, fileName); }
+            return SFM_E_ACCESS;
+        }
+
+    /* bin extension */
+    } else if ( 0 == strcasecmp("bin", charPtrFileExt) ) {
+        /* entry message */
+        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
+        /* File write */
+        intRet = sfm_write_bin ( self, fileName );
+        if ( SFM_OK != intRet ) {
+            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: failed to write file '%s'\n", __FUNCTION__, fileName); }
+            return intRet;
+        }
+
+    /* Unknown file extension */
+    } else {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: unsupported file type '%s'\n", __FUNCTION__, charPtrFileExt); }
+        return SFM_E_ACCESS;
+    }
+
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_store
+ *    stores spi flash memory into file
+ *    .dif -> difference to empty flash, full initialized with 0xff
+ */
+int sfm_store (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    int     intRet; // return value
+
+    intRet = sfm_store_img(self, fileName);
+    sfm_stats_file(self, SFM_STATS_STORE, fileName, intRet);
+    return intRet;
+}
+
+
+
+/** @brief sfm_load_img
+ *
+ *  loads file into flash, format selected by file extension
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName        path to file
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *
+ */
+static int sfm_load_img (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    char*       charPtrFileExt;         // pointer to file extension
+    int         intRet;                 // return value
+
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* flash type selected */
+    if ( NULL == self->flashType ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); }
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+        return SFM_E_MALLOC;
+    }
+
+    /* check desired file extension */
+    charPtrFileExt = sfm_file_ext(fileName);
+    /* no file extension */
+    if ( !charPtrFileExt ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: No file name\n", __FUNCTION__); }
+        return SFM_E_ACCESS;
+
+    /* dif extension */
+    } else if ( 0 == strcasecmp("dif", charPtrFileExt) ) {
+        /* entry message */
+        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
+        /* File read */
+        intRet = sfm_read_dif ( self, fileName );
+        if ( SFM_OK != intRet ) {
+            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: failed to read file '%s'\n", __FUNCTION__, fileName); }
+            return intRet;
+        }
+
+    /* bin extension */
+    } else if ( 0 == strcasecmp("bin", charPtrFileExt) ) {
+        /* entry message */
+        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
+        /* File read */
+        intRet = sfm_read_bin ( self, fileName );
+        if ( SFM_OK != intRet ) {
+            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: failed to read file '%s'\n", __FUNCTION__, fileName); }
+            return intRet;
+        }
+
+    /* Unknown file extension */
+    } else {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: unsupported file type '%s'\n", __FUNCTION__, charPtrFileExt); }
+        return SFM_E_ACCESS;
+    }
+
+    /* finish function */
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_load
+ *    loads file into flash
+ *    .dif -> difference to empty flash, full initialised with 0xff
+ */
+int sfm_load (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    int     intRet; // return value
+
+    intRet = sfm_load_img(self, fileName);
+    sfm_stats_file(self, SFM_STATS_LOAD, fileName, intRet);
+    return intRet;
+}
+
+
+
+/**
+ *  sfm_cmp
+ *    compares file with internal spi buffer
+ */
+int sfm_cmp (t_sfm *self, char fileName[])
+{
+    /** Variables **/
+    t_sfm_range     range;  // first mismatch
+    uint32_t        num;    // number of ranges
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* stop at first differing range */
+    return sfm_cmp_ranges(self, fileName, &range, 1, &num);
+}
+
+
+
+/** @brief sfm_cmp_img
+ *
+ *  compares file with flash, format selected by file extension
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      fileName        path to file
+ *  @param[out]     ranges          differing ranges, NULL: count only
+ *  @param[in]      max             size of ranges
+ *  @param[out]     *num            number of differing ranges
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *
+ */
+static int sfm_cmp_img (t_sfm *self, char fileName[], t_sfm_range ranges[], uint32_t max, uint32_t *num)
+{
+    /** Variables **/
+    char*           charPtrFileExt; // pointer to file extension
+    uint8_t         uint8Is;        // flash value
+    int             intRet;         // return value
+    t_sfm_cmp_rpt   rpt;            // mismatch report
+
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* empty report */
+    *num = 0;
+    rpt.ranges = (0 != max) ? ranges : NULL;
+    rpt.uint32Max = max;
+    rpt.uint32Num = 0;
+
+    /* flash type selected */
+    if ( NULL == self->flashType ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); }
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+        return SFM_E_MALLOC;
+    }
+
+    /* check desired file extension */
+    charPtrFileExt = sfm_file_ext(fileName);
+    /* no file extension */
+    if ( !charPtrFileExt ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: No file name\n", __FUNCTION__); }
+        return SFM_E_ACCESS;
+
+    /* dif extension */
+    } else if ( 0 == strcasecmp("dif", charPtrFileExt) ) {
+        /* entry message */
+        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
+        /* streaming compare */
+        intRet = sfm_cmp_dif ( self, fileName, &rpt );
+
+    /* bin extension */
+    } else if ( 0 == strcasecmp("bin", charPtrFileExt) ) {
+        /* entry message */
+        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
+        /* blockwise compare */
+        intRet = sfm_cmp_bin ( self, fileName, &rpt );
+
+    /* Unknown file extension */
+    } else {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: unsupported file type '%s'\n", __FUNCTION__, charPtrFileExt); }
+        return SFM_E_ACCESS;
+    }
+
+    /* compare failed */
+    if ( SFM_OK != intRet ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: failed to read file '%s'\n", __FUNCTION__, fileName); }
+        return intRet;
+    }
+
+    /* mismatch report */
+    *num = rpt.uint32Num;
+    if ( 0 == rpt.uint32Num ) {
+        return SFM_OK;
+    }
+    if ( 0 != self->intMsgLevel ) {
+        printf("  ERROR:%s: %u mismatching ranges\n", __FUNCTION__, rpt.uint32Num);
+        for ( uint32_t i = 0; (NULL != rpt.ranges) && (i < rpt.uint32Num); i++ ) {
+            printf("  ERROR:%s: mismatch in 0x%x - 0x%x\n", __FUNCTION__, rpt.ranges[i].uint32Start, rpt.ranges[i].uint32Stop);
+        }
+        sfm_mem_rd(self, rpt.uint32First, &uint8Is, 1);
+        printf("  ERROR:%s: mismatch at 0x%x: is=0x%02x, exp=0x%02x\n", __FUNCTION__, rpt.uint32First, uint8Is, rpt.uint8Exp);
+        printf("  ERROR:%s: IS dump\n", __FUNCTION__);
+        sfm_hexdump_uint8 (self, NULL, sfm_subtract_uint32(rpt.uint32First, 16), sfm_min_uint32(rpt.uint32First+16, self->flashType->uint32FlashTopoTotalSizeByte - 1), "    ");
+    }
+    return SFM_E_CMP;   // mismatch to file
+}
+
+
+
+/**
+ *  sfm_cmp_ranges
+ *    compares file with flash and reports differing ranges
+ */
+int sfm_cmp_ranges (t_sfm *self, char fileName[], t_sfm_range ranges[], uint32_t max, uint32_t *num)
+{
+    /** Variables **/
+    int     intRet; // return value
+
+    intRet = sfm_cmp_img(self, fileName, ranges, max, num);
+    sfm_stats_file(self, SFM_STATS_CMP, fileName, intRet);
+    return intRet;
+}
+
+
+
+/** @brief sfm_wip_busy
+ *
+ *  write in progress pending
+ *
+ *  @param[in]      self            handle
+ *  @return         int             0: ready, otherwise busy
+ *
+ */
+static int sfm_wip_busy (const t_sfm *self)
+{
+    if ( SFM_TIME_VIRTUAL == self->intTimeMode ) {
+        return self->uint64TimeNs < self->uint64WipDoneNs;
+    }
+    return 0 != self->uint8WipRdAfterWriteCnt;
+}
+
+
+
+/** @brief sfm_wip_check
+ *
+ *  rejects write access while write in progress
+ *
+ *  @param[in]      self            handle
+ *  @return         int             state
+ *  @retval         #SFM_OK             ready; @see #SFM_E
+ *  @retval         #SFM_E_WIP_FLASH    write in progress; @see #SFM_E
+ *
+ */
+static int sfm_wip_check (const t_sfm *self)
+{
+    if ( 0 == sfm_wip_busy(self) ) {
+        return SFM_OK;
+    }
+    if ( 0 != self->intMsgLevel ) {
+        if ( SFM_TIME_VIRTUAL == self->intTimeMode ) {
+            printf("  ERROR:sfm: WIP still in progress, %llu ns left for write access\n", (unsigned long long) (self->uint64WipDoneNs - self->uint64TimeNs));
+        } else {
+            printf("  ERROR:sfm: WIP still in progress, read %i times for write access\n", self->uint8WipRdAfterWriteCnt);
+        }
+    }
+    return SFM_E_WIP_FLASH; // Write in progress
+}
+
+
+
+/** @brief sfm_wip_start
+ *
+ *  starts write in progress after Page Program or Erase
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      us              flash timing in us, used on virtual clock
+ *
+ */
+static void sfm_wip_start (t_sfm *self, uint32_t us)
+{
+    self->uint8WipRdAfterWriteCnt = SFM_WIP_RETRY_IDLE;
+    self->uint64WipDoneNs = self->uint64TimeNs + (uint64_t) us * 1000;
+}
+
+
+
+/** @brief sfm_wip_poll
+ *
+ *  Read Status Register, updates WIP flag
+ *
+ *  @param[in,out]  self            handle
+ *  @return         uint8_t         status register
+ *
+ */
+static uint8_t sfm_wip_poll (t_sfm *self)
+{
+    if ( 0 != sfm_wip_busy(self) ) {
+        if ( SFM_TIME_POLL == self->intTimeMode ) {
+            --(self->uint8WipRdAfterWriteCnt);  // no write (erase/page programm) possible, more WIP polls are necessary
+        }
+        self->uint8StatusReg1 |= (uint8_t) (self->flashType->uint8FlashMngWipMsk);  // set WIP
+    } else {
+        self->uint8StatusReg1 &= (uint8_t) ~(self->flashType->uint8FlashMngWipMsk); // clear WIP flag
+    }
+    return self->uint8StatusReg1;
+}
+
+
+
+/** @brief sfm_wear_erase
+ *
+ *  counts erase cycle of sectors, rejects if any sector is worn out
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      sector          first sector number
+ *  @param[in]      num             number of sectors
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_WEAR     endurance limit reached; @see #SFM_E
+ *
+ */
+static int sfm_wear_erase (t_sfm *self, uint32_t sector, uint32_t num)
+{
+    /** Variables **/
+    uint32_t    uint32Cycles;   // erase cycles of sector
+
+    for ( uint32_t i = sector; (0 != self->wear.uint32Limit) && (i < sector + num); i++ ) {
+        uint32Cycles = self->wear.uint32PtrErase[i] + self->wear.uint32EraseChip;
+        if ( uint32Cycles >= self->wear.uint32Limit ) {
+            if ( 0 != self->intMsgLevel ) {
+                printf("  ERROR:sfm: Sector %u worn out, %u erase cycles\n", i, uint32Cycles);
+            }
+            return SFM_E_WEAR;
+        }
+    }
+    for ( uint32_t i = sector; i < sector + num; i++ ) {
+        if ( ++(self->wear.uint32PtrErase[i]) > self->wear.uint32EraseMax ) {
+            self->wear.uint32EraseMax = self->wear.uint32PtrErase[i];
+        }
+    }
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_wear_prog
+ *
+ *  program cycle counter of page, counters of sector are allocated on first use
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      adr             flash address in page
+ *  @return         uint32_t*       program cycles of page, NULL: allocation failed
+ *
+ */
+static uint32_t* sfm_wear_prog (t_sfm *self, uint32_t adr)
+{
+    /** Variables **/
+    uint32_t    sector = adr >> self->desc.uint8SectorShift;    // sector number
+    uint32_t**  uint32PtrSec = &self->wear.uint32PtrProg[sector];
+
+    if ( NULL == *uint32PtrSec ) {
+        *uint32PtrSec = (uint32_t*) calloc((size_t) 1 << (self->desc.uint8SectorShift - self->desc.uint8PageShift), sizeof(uint32_t));
+        if ( NULL == *uint32PtrSec ) {
+            return NULL;
+        }
+        self->wear.uint32ProgAlloc++;
+    }
+    return *uint32PtrSec + ((adr & self->desc.uint32SectorMsk) >> self->desc.uint8PageShift);
+}
+
+
+
+
+
+
+/** @brief sfm_wear_erase_all
+ *
+ *  counts Chip Erase cycle, rejects if any sector is worn out
+ *
+ *  @param[in,out]  self            handle
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_WEAR     endurance limit reached; @see #SFM_E
+ *
+ */
+static int sfm_wear_erase_all (t_sfm *self)
+{
+    if ( (0 != self->wear.uint32Limit) && (self->wear.uint32EraseMax + self->wear.uint32EraseChip >= self->wear.uint32Limit) ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Chip worn out, %u erase cycles\n", self->wear.uint32EraseMax + self->wear.uint32EraseChip);
+        }
+        return SFM_E_WEAR;
+    }
+    self->wear.uint32EraseChip++;
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_bus_cycles_ns
+ *
+ *  SCK cycles to time
+ *
+ *  @param[in]      self            handle
+ *  @param[in]      cycles          SCK cycles
+ *  @return         uint64_t        time in ns
+ *
+ */
+static uint64_t sfm_bus_cycles_ns (const t_sfm *self, uint64_t cycles)
+{
+    return (cycles / self->bus.uint32SckHz) * 1000000000ULL + ((cycles % self->bus.uint32SckHz) * 1000000000ULL) / self->bus.uint32SckHz;
+}
+
+
+
+/** @brief sfm_hdl_hdr_len
+ *
+ *  instruction, address and dummy bytes in front of data phase
+ *
+ *  @param[in]      self            handle
+ *  @param[in]      hdl             instruction handler
+ *  @return         uint32_t        header length
+ *
+ */
+static inline uint32_t sfm_hdl_hdr_len (const t_sfm *self, uint8_t hdl)
+{
+    switch ( hdl ) {
+        case SFM_HDL_RD_DATA:
+        case SFM_HDL_WR_PAGE:
+        case SFM_HDL_ERASE_SECTOR:
+        case SFM_HDL_ERASE_BLOCK:
+            return self->desc.uint32AdrIstLen;
+        case SFM_HDL_RD_DATA_4B:
+        case SFM_HDL_WR_PAGE_4B:
+        case SFM_HDL_ERASE_SECTOR_4B:
+        case SFM_HDL_ERASE_BLOCK_4B:
+            return 1 + SFM_ADR_4B;
+        case SFM_HDL_RD_FAST:
+        case SFM_HDL_RD_DUAL_OUT:
+        case SFM_HDL_RD_QUAD_OUT:
+            return self->desc.uint32RdFastLen;
+        case SFM_HDL_RD_QUAD_IO:
+            return self->desc.uint32RdQuadIoLen;
+        case SFM_HDL_RD_ID:
+            return self->desc.uint32RdIdLen - self->desc.uint8IdLen;
+        default:
+            return 1;
+    }
+}
+
+
+
+/** @brief sfm_hdl_rd
+ *
+ *  @param[in]      hdl             instruction handler
+ *  @return         int             1: Read Data or fast read variant
+ *
+ */
+static inline int sfm_hdl_rd (uint8_t hdl)
+{
+    return (SFM_HDL_RD_DATA <= hdl) && (SFM_HDL_RD_DATA_4B >= hdl);
+}
+
+
+
+/** @brief sfm_hdl_data
+ *
+ *  @param[in]      hdl             instruction handler
+ *  @return         int             1: instruction with data phase, read variant or Page Program
+ *
+ */
+static inline int sfm_hdl_data (uint8_t hdl)
+{
+    return (SFM_HDL_RD_DATA <= hdl) && (SFM_HDL_WR_PAGE_4B >= hdl);
+}
+
+
+
+/** @brief sfm_hdl_wr_page
+ *
+ *  @param[in]      hdl             instruction handler
+ *  @return         int             1: Page Program, 3- or 4-byte address
+ *
+ */
+static inline int sfm_hdl_wr_page (uint8_t hdl)
+{
+    return (SFM_HDL_WR_PAGE == hdl) || (SFM_HDL_WR_PAGE_4B == hdl);
+}
+
+
+
+/** @brief sfm_hdl_adr_bytes
+ *
+ *  @param[in]      self            handle
+ *  @param[in]      hdl             instruction handler
+ *  @return         uint8_t         address bytes of instruction, 0: without address
+ *
+ */
+static inline uint8_t sfm_hdl_adr_bytes (const t_sfm *self, uint8_t hdl)
+{
+    switch ( hdl ) {
+        case SFM_HDL_RD_DATA_4B:
+        case SFM_HDL_WR_PAGE_4B:
+        case SFM_HDL_ERASE_SECTOR_4B:
+        case SFM_HDL_ERASE_BLOCK_4B:
+            return SFM_ADR_4B;
+        case SFM_HDL_ERASE_SECTOR:
+        case SFM_HDL_ERASE_BLOCK:
+            return self->desc.uint8AdrBytes;
+        default:
+            return (0 != sfm_hdl_data(hdl)) ? self->desc.uint8AdrBytes : 0;
+    }
+}
+
+
+
+/** @brief sfm_bus_charge_hdr
+ *
+ *  charges SCK cycles of one transaction with known header length
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      hdl             instruction handler
+ *  @param[in]      hdr             instruction, address and dummy bytes, @see #sfm_hdl_hdr_len
+ *  @param[in]      len             spi packet length
+ *
+ */
+static SFM_INLINE void sfm_bus_charge_hdr (t_sfm *self, uint8_t hdl, uint32_t hdr, uint32_t len)
+{
+    /** Variables **/
+    uint32_t    uint32Hdr;  // instruction, address and dummy bytes
+    uint64_t    uint64Cyc;  // transaction cycles
+    uint64_t    uint64Fp;   // time, 32.32 fixed point ns
+
+    /* header length */
+    uint32Hdr = sfm_min_uint32(hdr, len);
+    /* cycles per phase */
+    uint64Cyc = (uint64_t) (8 >> SFM_HDL_LANES[hdl].uint8Ist)
+                + (((uint64_t) (uint32Hdr - 1) * 8) >> SFM_HDL_LANES[hdl].uint8Adr)
+                + (((uint64_t) (len - uint32Hdr) * 8) >> SFM_HDL_LANES[hdl].uint8Dat);
+    self->bus.uint64Cycles += uint64Cyc;
+    if ( 0 != sfm_hdl_data(hdl) ) {
+        self->bus.uint64DataByte += len - uint32Hdr;
+        self->bus.uint64LaneByte[SFM_HDL_LANES[hdl].uint8Dat] += len - uint32Hdr;
+    }
+    /* virtual clock */
+    if ( SFM_TIME_VIRTUAL == self->intTimeMode ) {
+        if ( uint64Cyc <= self->bus.uint64CycFast ) {   // fraction and product fit in 64 bits
+            uint64Fp = self->bus.uint64NsFrac + uint64Cyc * self->bus.uint64NsPerCycle;
+            self->uint64TimeNs += uint64Fp >> 32;
+            self->bus.uint64NsFrac = uint64Fp & 0xffffffffULL;
+        } else {
+            self->uint64TimeNs += sfm_bus_cycles_ns(self, uint64Cyc);
+        }
+    }
+}
+
+
+
+/** @brief sfm_bus_charge
+ *
+ *  charges SCK cycles of one transaction, in #SFM_TIME_VIRTUAL the clock runs with the bus
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      hdl             instruction handler
+ *  @param[in]      len             spi packet length
+ *
+ */
+static void sfm_bus_charge (t_sfm *self, uint8_t hdl, uint32_t len)
+{
+    sfm_bus_charge_hdr(self, hdl, sfm_hdl_hdr_len(self, hdl), len);
+}
+
+
+
+#if SFM_TRACE
+/**
+ *  @typedef t_sfm_trace
+ *
+ *  @brief  trace recorder
+ *
+ *  single producer ring buffer, positions count bytes and wrap only on buffer access
+ */
+struct t_sfm_trace {
+    uint8_t*            uint8PtrRing;   /**<  ring buffer */
+    uint64_t            uint64Msk;      /**<  ring buffer size - 1 */
+    _Atomic uint64_t    uint64Head;     /**<  written by model */
+    uint64_t            uint64TailSeen; /**<  model copy of uint64Tail, reloaded on full ring buffer */
+    uint64_t            uint64Kick;     /**<  head on last flush thread wake up */
+    uint64_t            uint64Start;    /**<  virtual clock at start of current transaction */
+    uint64_t            uint64Drop;     /**<  dropped transactions */
+    uint32_t            uint32Seq;      /**<  next transaction number */
+    int                 intMode;        /**<  recorded content, #SFM_TRACE_MODE */
+    int                 intFd;          /**<  trace file */
+    int                 intStop;        /**<  flush thread termination request */
+    int                 intErr;         /**<  trace file write failed */
+    pthread_t           thread;         /**<  flush thread */
+    pthread_mutex_t     mutex;          /**<  guards intStop and wake up */
+    pthread_cond_t      cond;           /**<  wakes flush thread */
+    _Alignas(64) _Atomic uint64_t   uint64Tail; /**<  written by flush thread, own cache line */
+};
+
+
+
+/** @brief sfm_trace_put
+ *
+ *  copies into ring buffer, source NULL writes zeros
+ *
+ *  @param[in,out]  trc             trace recorder
+ *  @param[in]      pos             ring buffer position
+ *  @param[in]      src             source
+ *  @param[in]      len             number of bytes
+ *
+ */
+static void sfm_trace_put (t_sfm_trace *trc, uint64_t pos, const void *src, uint32_t len)
+{
+    /** Variables **/
+    uint64_t    uint64Off = pos & trc->uint64Msk;                               // start in ring buffer
+    uint32_t    uint32Piece = (uint32_t) sfm_min_uint32(len, (uint32_t) (trc->uint64Msk + 1 - uint64Off)); // bytes until buffer end
+
+    if ( NULL == src ) {
+        memset(trc->uint8PtrRing + uint64Off, 0, uint32Piece);
+        memset(trc->uint8PtrRing, 0, len - uint32Piece);
+    } else {
+        memcpy(trc->uint8PtrRing + uint64Off, src, uint32Piece);
+        memcpy(trc->uint8PtrRing, (const uint8_t*) src + uint32Piece, len - uint32Piece);
+    }
+}
+
+
+
+/** @brief sfm_trace_rec
+ *
+ *  appends transaction to ring buffer, dropped on full ring buffer
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      ist             instruction
+ *  @param[in]      adr             flash address
+ *  @param[in]      pkt             spi packet after processing, NULL: data phase not available
+ *  @param[in]      len             spi packet length
+ *  @param[in]      ret             transaction state, @see #SFM_E
+ *
+ */
+static void sfm_trace_rec (t_sfm *self, uint8_t ist, uint32_t adr, const uint8_t *pkt, uint32_t len, int ret)
+{
+    /** Variables **/
+    t_sfm_trace*        trc = self->trace;  // trace recorder
+    t_sfm_trace_rec     rec;                // transaction record
+    uint32_t            uint32Hdr;          // bytes in front of data phase
+    uint32_t            uint32Dat = 0;      // data phase bytes
+    uint64_t            uint64Head;         // ring buffer write position
+    uint64_t            uint64Need;         // record with data phase and padding
+
+    /* record */
+    rec.uint64TimeNs = trc->uint64Start;
+    rec.uint32Seq = trc->uint32Seq++;
+    rec.uint32Adr = adr;
+    rec.uint32Len = len;
+    rec.uint16Ret = (uint16_t) ret;
+    rec.uint8Ist = ist;
+    rec.uint8Flags = 0;
+    rec.uint32Hash = 0;
+    rec.uint32Data = 0;
+    if ( NULL != pkt ) {
+        uint32Hdr = sfm_min_uint32(sfm_hdl_hdr_len(self, self->desc.uint8IstHdl[ist]), len);
+        uint32Dat = len - uint32Hdr;
+        pkt += uint32Hdr;
+        rec.uint8Flags = SFM_TRACE_REC_DATA;
+        if ( 0 != (trc->intMode & SFM_TRACE_HASH) ) {
+            rec.uint32Hash = sfm_trace_hash(pkt, uint32Dat);
+        }
+        if ( 0 != (trc->intMode & SFM_TRACE_DATA) ) {
+            rec.uint32Data = uint32Dat;
+        }
+    }
+    /* free space, tail only moves forward */
+    uint64Head = atomic_load_explicit(&trc->uint64Head, memory_order_relaxed);
+    uint64Need = sizeof(rec) + (((uint64_t) rec.uint32Data + 7) & ~7ULL);
+    if ( uint64Need > trc->uint64Msk + 1 - (uint64Head - trc->uint64TailSeen) ) {
+        trc->uint64TailSeen = atomic_load_explicit(&trc->uint64Tail, memory_order_acquire);
+        if ( uint64Need > trc->uint64Msk + 1 - (uint64Head - trc->uint64TailSeen) ) {
+            trc->uint64Drop++;
+            return;
+        }
+    }
+    /* append */
+    sfm_trace_put(trc, uint64Head, &rec, sizeof(rec));
+    if ( 0 != rec.uint32Data ) {
+        sfm_trace_put(trc, uint64Head + sizeof(rec), pkt, rec.uint32Data);
+        sfm_trace_put(trc, uint64Head + sizeof(rec) + rec.uint32Data, NULL, (uint32_t) (uint64Need - sizeof(rec) - rec.uint32Data));
+    }
+    uint64Head += uint64Need;
+    atomic_store_explicit(&trc->uint64Head, uint64Head, memory_order_release);
+    /* wake flush thread every quarter ring buffer */
+    if ( uint64Head - trc->uint64Kick > (trc->uint64Msk >> 2) ) {
+        trc->uint64Kick = uint64Head;
+        pthread_mutex_lock(&trc->mutex);
+        pthread_cond_signal(&trc->cond);
+        pthread_mutex_unlock(&trc->mutex);
+    }
+}
+
+
+
+/** @brief sfm_trace_drain
+ *
+ *  writes filled ring buffer to trace file
+ *
+ *  @param[in,out]  trc             trace recorder
+ *
+ */
+static void sfm_trace_drain (t_sfm_trace *trc)
+{
+    /** Variables **/
+    uint64_t    uint64Head = atomic_load_explicit(&trc->uint64Head, memory_order_acquire);  // filled until
+    uint64_t    uint64Tail = atomic_load_explicit(&trc->uint64Tail, memory_order_relaxed);  // written until
+    uint64_t    uint64Off;      // start in ring buffer
+    uint64_t    uint64Piece;    // bytes until buffer end
+
+    while ( uint64Tail != uint64Head ) {
+        uint64Off = uint64Tail & trc->uint64Msk;
+        uint64Piece = uint64Head - uint64Tail;
+        if ( uint64Piece > trc->uint64Msk + 1 - uint64Off ) {
+            uint64Piece = trc->uint64Msk + 1 - uint64Off;
+        }
+        if ( SFM_OK != sfm_fd_wr(trc->intFd, trc->uint8PtrRing + uint64Off, (size_t) uint64Piece) ) {
+            trc->intErr = 1;
+        }
+        uint64Tail += uint64Piece;
+        atomic_store_explicit(&trc->uint64Tail, uint64Tail, memory_order_release);
+    }
+}
+
+
+
+/** @brief sfm_trace_flush
+ *
+ *  flush thread, writes ring buffer on wake up or at latest after #SFM_TRACE_FLUSH_MS
+ *
+ *  @param[in,out]  arg             trace recorder
+ *  @return         void*           NULL
+ *
+ */
+static void* sfm_trace_flush (void *arg)
+{
+    /** Variables **/
+    t_sfm_trace*    trc = (t_sfm_trace*) arg;   // trace recorder
+    struct timespec ts;                         // wake up time
+
+    pthread_mutex_lock(&trc->mutex);
+    while ( 0 == trc->intStop ) {
+        /* sleep if less than a quarter ring buffer filled, wake up is sent under lock */
+        if ( atomic_load_explicit(&trc->uint64Head, memory_order_acquire) - atomic_load_explicit(&trc->uint64Tail, memory_order_relaxed) <= (trc->uint64Msk >> 2) ) {
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += SFM_TRACE_FLUSH_MS * 1000000L;
+            if ( ts.tv_nsec >= 1000000000L ) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&trc->cond, &trc->mutex, &ts);
+        }
+        pthread_mutex_unlock(&trc->mutex);
+        sfm_trace_drain(trc);
+        pthread_mutex_lock(&trc->mutex);
+    }
+    pthread_mutex_unlock(&trc->mutex);
+    sfm_trace_drain(trc);   // remaining transactions
+    return NULL;
+}
+
+
+
+/** @brief sfm_trace_start
+ *
+ *  transaction start, called before bus time is charged
+ *
+ *  @param[in]      self            handle
+ *  @param[in]      pkt             spi packet before processing
+ *  @param[in]      len             spi packet length
+ *  @return         uint32_t        flash address, 0: no trace or instruction without address
+ *
+ */
+static inline uint32_t sfm_trace_start (const t_sfm *self, const uint8_t *pkt, uint32_t len)
+{
+    /** Variables **/
+    uint8_t     uint8AdrBytes;  // address bytes of instruction
+
+    if ( NULL == self->trace ) {
+        return 0;
+    }
+    self->trace->uint64Start = self->uint64TimeNs;
+    if ( 0 == len ) {
+        return 0;
+    }
+    uint8AdrBytes = sfm_hdl_adr_bytes(self, self->desc.uint8IstHdl[pkt[0]]);
+    if ( (0 == uint8AdrBytes) || (len < 1u + uint8AdrBytes) ) {
+        return 0;
+    }
+    return sfm_spi_to_adr((uint8_t*) pkt+1, uint8AdrBytes);
+}
+
+
+
+/** @brief sfm_trace_pkt
+ *
+ *  records transaction if trace is started
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      ist             instruction
+ *  @param[in]      adr             flash address, @see #sfm_trace_start
+ *  @param[in]      pkt             spi packet after processing, NULL: data phase not available
+ *  @param[in]      len             spi packet length
+ *  @param[in]      ret             transaction state, @see #SFM_E
+ *
+ */
+static inline void sfm_trace_pkt (t_sfm *self, uint8_t ist, uint32_t adr, const uint8_t *pkt, uint32_t len, int ret)
+{
+    if ( NULL != self->trace ) {
+        sfm_trace_rec(self, ist, adr, pkt, len, ret);
+    }
+}
+#else
+/* compiled out */
+static inline uint32_t sfm_trace_start (const t_sfm *self, const uint8_t *pkt, uint32_t len) { (void) self; (void) pkt; (void) len; return 0; }
+static inline void sfm_trace_pkt (t_sfm *self, uint8_t ist, uint32_t adr, const uint8_t *pkt, uint32_t len, int ret) { (void) self; (void) ist; (void) adr; (void) pkt; (void) len; (void) ret; }
+#endif
+
+
+
+/** @brief sfm_ist_unknown
+ *
+ *  handler for not supported instructions
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_E_IST_FLASH    unknown instruction; @see #SFM_E
+ *
+ */
+static int sfm_ist_unknown (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    (void) len;
+    if ( 0 != self->intMsgLevel ) {
+        printf("  ERROR:sfm: Unknown Instruction '0x%02x'\n", spi[0]);
+    };
+    return SFM_E_IST_FLASH; // malformed instruction
+}
+
+
+
+/** @brief sfm_ist_rd_id
+ *
+ *  Read Manufacturer / Device ID
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *
+ */
+static int sfm_ist_rd_id (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, Read Manufacturer / Device ID\n", self->flashType->uint8FlashIstRdID);
+    }
+    /* check length */
+    if ( len != self->desc.uint32RdIdLen ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed 'Read Manufacturer / Device ID' instruction, expLen=%d, isLen=%d\n", self->desc.uint32RdIdLen, len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* response: instruction and dummy bytes are zero, followed by ID */
+    memset(spi, 0, (size_t) (len - self->desc.uint8IdLen));
+    memcpy(spi + len - self->desc.uint8IdLen, self->desc.uint8Id, self->desc.uint8IdLen);
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_ist_wr_ena
+ *
+ *  Write Enable (06h)
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *
+ */
+static int sfm_ist_wr_ena (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, Write Enable\n", self->flashType->uint8FlashIstWrEnable);
+    }
+    /* check length */
+    if ( 1 != len ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed 'Write Enable' instruction, expLen=1, isLen=%d\n", len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* set write enable */
+    self->uint8StatusReg1 |= self->flashType->uint8FlashMngWrEnaMsk;
+    /* spi response */
+    spi[0] = 0;
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_ist_wr_dis
+ *
+ *  Write Disable (04h)
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *
+ */
+static int sfm_ist_wr_dis (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, Write Disable\n", self->flashType->uint8FlashIstWrDisable);
+    }
+    /* check length */
+    if ( 1 != len ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed 'Write Disable' instruction, expLen=1, isLen=%d\n", len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* clear write enable */
+    self->uint8StatusReg1 &= (uint8_t) ~(self->flashType->uint8FlashMngWrEnaMsk);
+    /* spi response */
+    spi[0] = 0;
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_ist_erase_bulk
+ *
+ *  Chip Erase
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *  @retval         #SFM_E_WP_FLASH     write enable bit not set; @see #SFM_E
+ *  @retval         #SFM_E_WIP_FLASH    write in progress; @see #SFM_E
+ *
+ */
+static int sfm_ist_erase_bulk (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, Chip Erase\n", self->flashType->uint8FlashIstEraseBulk);
+    }
+    /* check length */
+    if ( 1 != len ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed 'Chip Erase' instruction, expLen=1, isLen=%d\n", len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* check for write enable */
+    if ( 0 == (self->uint8StatusReg1 & self->flashType->uint8FlashMngWrEnaMsk) ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Chip erase while write protection\n");
+        }
+        return SFM_E_WP_FLASH;  // write protected
+    }
+    /* Write in progress? */
+    if ( SFM_OK != sfm_wip_check(self) ) {
+        return SFM_E_WIP_FLASH; // Write in progress
+    }
+    /* endurance */
+    if ( SFM_OK != sfm_wear_erase_all(self) ) {
+        return SFM_E_WEAR;
+    }
+    /* erase */
+    sfm_mem_erase_all(self);
+    /* clear write enable */
+    self->uint8StatusReg1 &= (uint8_t) ~(self->flashType->uint8FlashMngWrEnaMsk);
+    /* spi response */
+    spi[0] = 0;
+    /* set wait for write in progres */
+    sfm_wip_start(self, self->flashType->uint32FlashTimeChipEraseUs);
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_erase_adr
+ *
+ *  Sector or Block Erase, erased area is aligned to its size
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @param[in]      size            erase size in bytes, power of two
+ *  @param[in]      timeUs          erase time
+ *  @param[in]      name            instruction name of messages
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *  @retval         #SFM_E_WP_FLASH     write enable bit not set; @see #SFM_E
+ *  @retval         #SFM_E_WIP_FLASH    write in progress; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       address out of range; @see #SFM_E
+ *
+ */
+static int sfm_erase_adr (t_sfm *self, uint8_t* spi, uint32_t len, uint32_t size, uint32_t timeUs, const char *name)
+{
+    /** Variables **/
+    uint8_t     hdl;        // instruction handler
+    uint32_t    flashAdr;   // address in flash
+
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, %s\n", spi[0], name);
+    }
+    /* check length */
+    hdl = self->desc.uint8IstHdl[spi[0]];
+    if ( sfm_hdl_hdr_len(self, hdl) != len ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed '%s' instruction, expLen=%d, isLen=%d\n", name, sfm_hdl_hdr_len(self, hdl), len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* check for write enable */
+    if ( 0 == (self->uint8StatusReg1 & self->flashType->uint8FlashMngWrEnaMsk) ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: %s while write protection\n", name);
+        }
+        return SFM_E_WP_FLASH;  // write protected
+    }
+    /* Write in progress? */
+    if ( SFM_OK != sfm_wip_check(self) ) {
+        return SFM_E_WIP_FLASH; // Write in progress
+    }
+    /* assemble address */
+    flashAdr = sfm_spi_to_adr (spi+1, sfm_hdl_adr_bytes(self, hdl));   // spi packet to address
+    flashAdr &= ~(size - 1);                                            // align to erase size
+    /* in memory? */
+    if ( self->flashType->uint32FlashTopoTotalSizeByte < (uint64_t) flashAdr + size ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Address (0x%x) exceeds flash size (0x%x)\n", flashAdr, self->flashType->uint32FlashTopoTotalSizeByte);
+        }
+        return SFM_E_ACCESS;    // address exceeds flash
+    }
+    /* endurance */
+    if ( SFM_OK != sfm_wear_erase(self, flashAdr >> self->desc.uint8SectorShift, size >> self->desc.uint8SectorShift) ) {
+        return SFM_E_WEAR;
+    }
+    /* erase */
+    sfm_mem_erase(self, flashAdr >> self->desc.uint8SectorShift, size >> self->desc.uint8SectorShift);
+    /* clear write enable */
+    self->uint8StatusReg1 &= (uint8_t) ~(self->flashType->uint8FlashMngWrEnaMsk);
+    /* spi response */
+    memset(spi, 0, len);
+    /* set wait for write in progres */
+    sfm_wip_start(self, timeUs);
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_ist_erase_sector
+ *
+ *  Sector Erase, 3- or 4-byte address
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state, @see #sfm_erase_adr
+ *
+ */
+static int sfm_ist_erase_sector (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    return sfm_erase_adr(self, spi, len, self->flashType->uint32FlashTopoSectorSizeByte, self->flashType->uint32FlashTimeSectorEraseUs, "Sector Erase");
+}
+
+
+
+/** @brief sfm_ist_erase_block
+ *
+ *  Block Erase, 3- or 4-byte address
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state, @see #sfm_erase_adr
+ *
+ */
+static int sfm_ist_erase_block (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    return sfm_erase_adr(self, spi, len, self->desc.uint32BlockMsk + 1, self->flashType->uint32FlashTimeBlockEraseUs, "Block Erase");
+}
+
+
+
+/** @brief sfm_ist_adr_4b
+ *
+ *  Enter/Exit 4-Byte Address Mode (B7h/E9h), instructions without 4-byte
+ *  opcode take the address width of the mode
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *
+ */
+static int sfm_ist_adr_4b (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /** Variables **/
+    const int   intEnter = (SFM_HDL_ADR_4B_ENTER == self->desc.uint8IstHdl[spi[0]]);   // 1: enter, 0: exit
+
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, %s 4-Byte Address Mode\n", spi[0], (0 != intEnter) ? "Enter" : "Exit");
+    }
+    /* check length */
+    if ( 1 != len ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed '4-Byte Address Mode' instruction, expLen=1, isLen=%d\n", len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* address mode, exit returns to power up mode */
+    sfm_desc_adr_mode(&self->desc, self->flashType, (0 != intEnter) ? SFM_ADR_4B : self->flashType->uint8FlashTopoAdrBytes);
+    /* spi response */
+    spi[0] = 0;
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_ist_rd_state_reg
+ *
+ *  Read Status Register-1 (05h)
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *
+ */
+static int sfm_ist_rd_state_reg (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, Read Status Register\n", self->flashType->uint8FlashIstRdStateReg);
+    }
+    /* check length */
+    if ( 2 != len ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed 'Read Status Register' instruction, expLen=2, isLen=%d\n", len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* response, state reg 1 has WIP flag */
+    spi[0] = 0;
+    spi[1] = sfm_wip_poll(self);
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** spi packet segment cursor, @see #sfm_iov_next **/
+typedef struct {
+    const t_sfm_iov*    iov;        /**<  segments */
+    uint32_t            uint32Num;  /**<  number of segments */
+    uint32_t            uint32Idx;  /**<  current segment */
+    uint32_t            uint32Off;  /**<  offset in current segment */
+} t_sfm_iov_cur;
+
+
+
+/** @brief sfm_iov_next
+ *
+ *  next contiguous piece of spi packet, empty segments are skipped
+ *
+ *  @param[in,out]  cur             segment cursor
+ *  @param[in]      max             maximum piece length
+ *  @param[out]     *len            piece length
+ *  @return         uint8_t*        piece start, NULL: end of packet
+ *
+ */
+static uint8_t* sfm_iov_next (t_sfm_iov_cur *cur, uint32_t max, uint32_t *len)
+{
+    /** Variables **/
+    uint8_t*    uint8PtrPiece;  // piece start
+
+    while ( (cur->uint32Idx < cur->uint32Num) && (cur->uint32Off >= cur->iov[cur->uint32Idx].uint32Len) ) {
+        cur->uint32Idx++;
+        cur->uint32Off = 0;
+    }
+    if ( cur->uint32Idx >= cur->uint32Num ) {
+        *len = 0;
+        return NULL;
+    }
+    *len = sfm_min_uint32(max, cur->iov[cur->uint32Idx].uint32Len - cur->uint32Off);
+    uint8PtrPiece = cur->iov[cur->uint32Idx].uint8PtrBuf + cur->uint32Off;
+    cur->uint32Off += *len;
+    return uint8PtrPiece;
+}
+
+
+
+/** @brief sfm_iov_put
+ *
+ *  writes into spi packet segments, f.e. clears instruction and address part of response
+ *
+ *  @param[in,out]  cur             segment cursor, points behind written part afterwards
+ *  @param[in]      *src            source data, NULL: zeros
+ *  @param[in]      len             number of bytes
+ *
+ */
+static void sfm_iov_put (t_sfm_iov_cur *cur, const uint8_t *src, uint32_t len)
+{
+    /** Variables **/
+    uint8_t*    uint8PtrPiece;  // piece start
+    uint32_t    uint32Piece;    // piece length
+
+    while ( len > 0 ) {
+        uint8PtrPiece = sfm_iov_next(cur, len, &uint32Piece);
+        if ( NULL == uint8PtrPiece ) {
+            break;
+        }
+        if ( NULL == src ) {
+            memset(uint8PtrPiece, 0, uint32Piece);
+        } else {
+            memcpy(uint8PtrPiece, src, uint32Piece);
+            src += uint32Piece;
+        }
+        len -= uint32Piece;
+    }
+}
+
+
+
+/** @brief sfm_iov_skip
+ *
+ *  moves segment cursor forward
+ *
+ *  @param[in,out]  cur             segment cursor
+ *  @param[in]      len             number of bytes
+ *
+ */
+static void sfm_iov_skip (t_sfm_iov_cur *cur, uint32_t len)
+{
+    /** Variables **/
+    uint32_t    uint32Piece;    // piece length
+
+    while ( (len > 0) && (NULL != sfm_iov_next(cur, len, &uint32Piece)) ) {
+        len -= uint32Piece;
+    }
+}
+
+
+
+/** @brief sfm_rd_data
+ *
+ *  Read Data and fast read variants, data phase is written to spi packet segments.
+ *  Lanes only count for bus time, the spi packet holds the bytes of the transfer
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      *hdr            instruction and address bytes
+ *  @param[in]      len             spi packet length
+ *  @param[in,out]  rx              response segments, NULL: response discarded
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *
+ */
+static int sfm_rd_data (t_sfm *self, const uint8_t *hdr, uint32_t len, t_sfm_iov_cur *rx)
+{
+    /** Variables **/
+    uint8_t     hdl;            // read variant
+    uint32_t    uint32Hdr;      // instruction, address, mode and dummy bytes
+    uint32_t    flashAdr;       // address in flash
+    uint32_t    uint32Piece;    // bytes in contiguous piece
+    uint8_t*    uint8PtrPiece;  // contiguous piece of packet
+
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, Read Data\n", hdr[0]);
+    }
+    /* check length */
+    hdl = self->desc.uint8IstHdl[hdr[0]];
+    uint32Hdr = sfm_hdl_hdr_len(self, hdl);
+    if ( len < uint32Hdr ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed 'Read Data' instruction, expLen>%d, isLen=%d\n", uint32Hdr, len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* Quad I/O mode bits, M5-4 = 10b enters not emulated continuous read mode */
+    if ( (SFM_HDL_RD_QUAD_IO == hdl) && (0x20 == (hdr[self->desc.uint32AdrIstLen] & 0x30)) ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Continuous read mode not supported, mode=0x%02x\n", hdr[self->desc.uint32AdrIstLen]);
+        }
+        return SFM_E_IST_FLASH;
+    }
+    /* spi packet to address */
+    flashAdr = sfm_spi_to_adr ((uint8_t*) hdr+1, sfm_hdl_adr_bytes(self, hdl)) & self->desc.uint32TotalMsk;
+    /* nobody listens */
+    if ( NULL == rx ) {
+        return SFM_OK;
+    }
+    /* clear start of spi packet */
+    sfm_iov_put(rx, NULL, uint32Hdr);
+    /* fetch out the data, pieces end at latest on flash end */
+    while ( NULL != (uint8PtrPiece = sfm_iov_next(rx, self->flashType->uint32FlashTopoTotalSizeByte - flashAdr, &uint32Piece)) ) {
+        sfm_mem_rd(self, flashAdr, uint8PtrPiece, uint32Piece);
+        flashAdr = (flashAdr + uint32Piece) & self->desc.uint32TotalMsk;    // address overoll
+    }
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_wr_page
+ *
+ *  Page Program, data phase is read from spi packet segments. The response
+ *  is the request with cleared instruction and address, like #sfm in place
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in]      *hdr            instruction and address bytes
+ *  @param[in]      len             spi packet length
+ *  @param[in,out]  tx              request segments
+ *  @param[in,out]  rx              response segments, same as tx: in place; NULL: response discarded
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *  @retval         #SFM_E_WP_FLASH     write enable bit not set; @see #SFM_E
+ *  @retval         #SFM_E_WIP_FLASH    write in progress; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       sector allocation failed; @see #SFM_E
+ *
+ */
+static int sfm_wr_page (t_sfm *self, const uint8_t *hdr, uint32_t len, t_sfm_iov_cur *tx, t_sfm_iov_cur *rx)
+{
+    /** Variables **/
+    uint8_t     hdl;            // 3- or 4-byte address variant
+    uint32_t    uint32Hdr;      // instruction and address bytes
+    uint32_t    flashAdr;       // in page address
+    uint32_t    flashAdrBase;   // page base address
+    uint32_t    uint32Piece;    // bytes in contiguous piece
+    uint8_t*    uint8PtrPiece;  // contiguous piece of packet
+    uint8_t*    uint8PtrPage;   // page storage
+    uint32_t*   uint32PtrProg;  // program cycles of page
+
+    /* entry message */
+    if ( 0 != self->intMsgLevel ) {
+        printf("  INFO:sfm: IST=0x%02x, Page Program\n", hdr[0]);
+    }
+    /* check length */
+    hdl = self->desc.uint8IstHdl[hdr[0]];
+    uint32Hdr = sfm_hdl_hdr_len(self, hdl);
+    if ( len < uint32Hdr ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed 'Page Program' instruction, expLen>%d, isLen=%d\n", uint32Hdr, len);
+        }
+        return SFM_E_IST_FLASH; // malformed instruction
+    }
+    /* check for write enable */
+    if ( 0 == (self->uint8StatusReg1 & self->flashType->uint8FlashMngWrEnaMsk) ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Page Program while write protection\n");
+        }
+        return SFM_E_WP_FLASH;  // write protected
+    }
+    /* Write in progress? */
+    if ( SFM_OK != sfm_wip_check(self) ) {
+        return SFM_E_WIP_FLASH; // Write in progress
+    }
+    /* spi packet to address */
+    flashAdr     = sfm_spi_to_adr ((uint8_t*) hdr+1, sfm_hdl_adr_bytes(self, hdl)) & self->desc.uint32TotalMsk;  // upper address bits ignored
+    flashAdrBase = flashAdr & ~self->desc.uint32PageMsk;    // base address, aligned to pages
+    flashAdr     &= self->desc.uint32PageMsk;               // in page address
+    /* page storage and program cycle counter, page is part of one sector */
+    uint8PtrPage = sfm_mem_sector(self, flashAdrBase >> self->desc.uint8SectorShift, 1);
+    uint32PtrProg = (NULL != uint8PtrPage) ? sfm_wear_prog(self, flashAdrBase) : NULL;
+    if ( NULL == uint32PtrProg ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Sector allocation failed\n");
+        }
+        return SFM_E_MALLOC;
+    }
+    uint8PtrPage += flashAdrBase & self->desc.uint32SectorMsk;
+    /* clear start of spi packet */
+    if ( tx != rx ) {
+        sfm_iov_skip(tx, uint32Hdr);
+    }
+    if ( NULL != rx ) {
+        sfm_iov_put(rx, NULL, uint32Hdr);
+    }
+    /* page write, pieces end at latest on page end, then page overroll */
+    while ( NULL != (uint8PtrPiece = sfm_iov_next(tx, self->flashType->uint32FlashTopoPageSizeByte - flashAdr, &uint32Piece)) ) {
+        sfm_and_uint8(uint8PtrPage + flashAdr, uint8PtrPiece, uint32Piece);     // in flash can only bits swapped from 1s -> 0s, otherwise erase
+        if ( (tx != rx) && (NULL != rx) ) {
+            sfm_iov_put(rx, uint8PtrPiece, uint32Piece);    // data phase echoed like in place
+        }
+        flashAdr = (flashAdr + uint32Piece) & self->desc.uint32PageMsk;
+    }
+    /* program cycle */
+    (*uint32PtrProg)++;
+    /* set wait for write in progres */
+    sfm_wip_start(self, self->flashType->uint32FlashTimePageProgUs);
+    /* exit */
+    return SFM_OK;
+}
+
+
+
+/** @brief sfm_ist_rd_data
+ *
+ *  Read Data
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *
+ */
+static int sfm_ist_rd_data (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /** Variables **/
+    t_sfm_iov       iov = {spi, len};       // packet as single segment
+    t_sfm_iov_cur   cur = {&iov, 1, 0, 0};  // segment cursor
+
+    return sfm_rd_data(self, spi, len, &cur);
+}
+
+
+
+/** @brief sfm_ist_wr_page
+ *
+ *  Page Program
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @return         int             state
+ *  @retval         #SFM_OK         @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    malformed instruction; @see #SFM_E
+ *  @retval         #SFM_E_WP_FLASH     write enable bit not set; @see #SFM_E
+ *  @retval         #SFM_E_WIP_FLASH    write in progress; @see #SFM_E
+ *
+ */
+static int sfm_ist_wr_page (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /** Variables **/
+    t_sfm_iov       iov = {spi, len};       // packet as single segment
+    t_sfm_iov_cur   cur = {&iov, 1, 0, 0};  // segment cursor
+
+    return sfm_wr_page(self, spi, len, &cur, &cur);
+}
+
+
+
+/** Instruction handler, indexed by #t_sfm_desc::uint8IstHdl **/
+static int (* const SFM_IST_HDL[SFM_HDL_NUM])(t_sfm*, uint8_t*, uint32_t) = {
+    sfm_ist_unknown,        // SFM_HDL_UNKNOWN
+    sfm_ist_rd_id,          // SFM_HDL_RD_ID
+    sfm_ist_wr_ena,         // SFM_HDL_WR_ENA
+    sfm_ist_wr_dis,         // SFM_HDL_WR_DIS
+    sfm_ist_erase_bulk,     // SFM_HDL_ERASE_BULK
+    sfm_ist_erase_sector,   // SFM_HDL_ERASE_SECTOR
+    sfm_ist_rd_state_reg,   // SFM_HDL_RD_STATE_REG
+    sfm_ist_rd_data,        // SFM_HDL_RD_DATA
+    sfm_ist_rd_data,        // SFM_HDL_RD_FAST
+    sfm_ist_rd_data,        // SFM_HDL_RD_DUAL_OUT
+    sfm_ist_rd_data,        // SFM_HDL_RD_QUAD_OUT
+    sfm_ist_rd_data,        // SFM_HDL_RD_QUAD_IO
+    sfm_ist_rd_data,        // SFM_HDL_RD_DATA_4B
+    sfm_ist_wr_page,        // SFM_HDL_WR_PAGE
+    sfm_ist_wr_page,        // SFM_HDL_WR_PAGE_4B
+    sfm_ist_erase_sector,   // SFM_HDL_ERASE_SECTOR_4B
+    sfm_ist_erase_block,    // SFM_HDL_ERASE_BLOCK
+    sfm_ist_erase_block,    // SFM_HDL_ERASE_BLOCK_4B
+    sfm_ist_adr_4b,         // SFM_HDL_ADR_4B_ENTER
+    sfm_ist_adr_4b          // SFM_HDL_ADR_4B_EXIT
+};
+
+
+
+/**
+ *  sfm
+ *    access SPI Flash Model
+ */
+int sfm (t_sfm *self, uint8_t* spi, uint32_t len)
+{
+    /** Variables **/
+    int         intRet;     // return value
+    uint8_t     ist;        // instruction
+    uint32_t    uint32Adr;  // traced address
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* flash type selected */
+    if ( NULL == self->flashType) {
+        printf("  ERROR:%s: no flash selected\n", __FUNCTION__);
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+        return SFM_E_MALLOC;
+    }
+
+    /* empty SPI packet */
+    if ( 0 == len ) {
+        return SFM_OK;
+    }
+
+    /* dispatch instruction */
+    ist = spi[0];
+    uint32Adr = sfm_trace_start(self, spi, len);
+    sfm_bus_charge(self, self->desc.uint8IstHdl[ist], len);
+    intRet = SFM_IST_HDL[self->desc.uint8IstHdl[ist]](self, spi, len);
+    sfm_stats_ist(self, ist, len, intRet);
+    sfm_trace_pkt(self, ist, uint32Adr, spi, len, intRet);
+    return intRet;
+}
+
+
+
+/** @brief sfm_part_rd_data
+ *
+ *  Read Data of #sfm_part, geometry is compile time constant
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, at least instruction and address
+ *  @param[in]      len             spi packet length
+ *  @param[in]      part            flash type of handle
+ *
+ */
+static SFM_INLINE void sfm_part_rd_data (t_sfm *self, uint8_t* spi, uint32_t len, const t_sfm_type *part)
+{
+    /** Variables **/
+    const uint32_t  uint32Sec = part->uint32FlashTopoSectorSizeByte;    // sector size
+    const uint32_t  uint32Hdr = 1u + part->uint8FlashTopoAdrBytes;      // instruction and address
+    uint32_t        flashAdr = 0;   // address in flash
+    uint32_t        uint32Seg;      // bytes in current sector
+    const uint8_t*  uint8PtrSec;    // sector storage
+
+    /* spi packet to address */
+    for ( uint8_t i = 0; i < part->uint8FlashTopoAdrBytes; i++ ) {
+        flashAdr = (flashAdr << 8) | spi[1 + i];
+    }
+    flashAdr &= part->uint32FlashTopoTotalSizeByte - 1;
+    /* clear start of spi packet */
+    memset(spi, 0, uint32Hdr);
+    spi += uint32Hdr;
+    len -= uint32Hdr;
+    /* fetch out the data, segments end at latest on sector end, then address overroll */
+    while ( len > 0 ) {
+        uint32Seg = sfm_min_uint32(len, uint32Sec - (flashAdr % uint32Sec));
+        uint8PtrSec = sfm_mem_sector(self, flashAdr / uint32Sec, 0);
+        if ( NULL == uint8PtrSec ) {
+            memset(spi, 0xff, uint32Seg);
+        } else {
+            memcpy(spi, uint8PtrSec + (flashAdr % uint32Sec), uint32Seg);
+        }
+        flashAdr = (flashAdr + uint32Seg) & (part->uint32FlashTopoTotalSizeByte - 1);
+        spi += uint32Seg;
+        len -= uint32Seg;
+    }
+}
+
+
+
+/** @brief sfm_part
+ *
+ *  #sfm specialized for one flash type. Opcodes and geometry of part are compile
+ *  time constants, Read Status Register, Read Data and Write Enable are
+ *  processed without descriptor lookup. Handles of other flash types, enabled
+ *  messages and all other instructions take the generic path
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  *spi            spi packet, request and response in same packet
+ *  @param[in]      len             spi packet length
+ *  @param[in]      part            #SPI_FLASH entry, constant
+ *  @return         int             state, @see #sfm
+ *
+ */
+static SFM_INLINE int sfm_part (t_sfm *self, uint8_t* spi, uint32_t len, const t_sfm_type *part)
+{
+    /** Variables **/
+    int         intRet;     // return value
+    uint8_t     ist;        // instruction
+    uint8_t     hdl;        // instruction handler
+    uint32_t    uint32Adr;  // traced address
+
+    /* generic path */
+    if ( (part != self->flashType) || (0 != self->intMsgLevel) || (0 == len) || (0 == sfm_mem_ready(self)) ) {
+        return sfm(self, spi, len);
+    }
+    /* dispatch instruction */
+    ist = spi[0];
+    uint32Adr = sfm_trace_start(self, spi, len);
+    if ( (part->uint8FlashIstRdStateReg == ist) && (2 == len) ) {
+        sfm_bus_charge_hdr(self, SFM_HDL_RD_STATE_REG, 1, len);
+        spi[0] = 0;
+        spi[1] = sfm_wip_poll(self);
+        intRet = SFM_OK;
+    } else if ( (part->uint8FlashIstRdData == ist) && (len >= 1u + part->uint8FlashTopoAdrBytes) && (part->uint8FlashTopoAdrBytes == self->desc.uint8AdrBytes) ) {
+        sfm_bus_charge_hdr(self, SFM_HDL_RD_DATA, 1u + part->uint8FlashTopoAdrBytes, len);
+        sfm_part_rd_data(self, spi, len, part);
+        intRet = SFM_OK;
+    } else if ( (part->uint8FlashIstWrEnable == ist) && (1 == len) ) {
+        sfm_bus_charge_hdr(self, SFM_HDL_WR_ENA, 1, len);
+        self->uint8StatusReg1 |= part->uint8FlashMngWrEnaMsk;
+        spi[0] = 0;
+        intRet = SFM_OK;
+    } else {
+        hdl = self->desc.uint8IstHdl[ist];
+        sfm_bus_charge(self, hdl, len);
+        intRet = SFM_IST_HDL[hdl](self, spi, len);
+    }
+    sfm_stats_ist(self, ist, len, intRet);
+    sfm_trace_pkt(self, ist, uint32Adr, spi, len, intRet);
+    return intRet;
+}
+
+
+
+/**
+ *  sfm_<part>
+ *    access SPI Flash Model, specialized entry point of #SFM_PARTS
+ */
+#define SFM_PART_ENTRY(part, idx)                                   \
+    int sfm_##part (t_sfm *self, uint8_t* spi, uint32_t len)        \
+    {                                                               \
+        return sfm_part(self, spi, len, &SPI_FLASH[idx]);           \
+    }
+SFM_PARTS(SFM_PART_ENTRY)
+#undef SFM_PART_ENTRY
+
+
+
+/** @brief sfm_batch_poll
+ *
+ *  executes run of Read Status Register packets in one go
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  pkts            spi packets, first packet is a Read Status Register
+ *  @param[in]      num             number of packets
+ *  @return         uint32_t        number of processed packets
+ *
+ */
+static uint32_t sfm_batch_poll (t_sfm *self, t_sfm_pkt pkts[], uint32_t num)
+{
+    /** Variables **/
+    uint32_t    i;      // iterator
+    uint8_t     ist;    // instruction
+
+    ist = pkts[0].uint8PtrSpi[0];
+    for ( i = 0; (i < num) && (2 == pkts[i].uint32Len) && (ist == pkts[i].uint8PtrSpi[0]); i++ ) {
+        sfm_trace_start(self, pkts[i].uint8PtrSpi, 2);
+        sfm_bus_charge(self, SFM_HDL_RD_STATE_REG, 2);
+        pkts[i].uint8PtrSpi[0] = 0;
+        pkts[i].uint8PtrSpi[1] = sfm_wip_poll(self);   // state reg 1 has WIP flag
+        pkts[i].intRet = SFM_OK;
+        sfm_stats_ist(self, ist, 2, SFM_OK);
+        sfm_trace_pkt(self, ist, 0, pkts[i].uint8PtrSpi, 2, SFM_OK);
+    }
+    return i;
+}
+
+
+
+/** @brief sfm_batch_fused
+ *
+ *  executes write sequence Write Enable, Page Program/Erase and Read Status Register polls as one operation
+ *
+ *  @param[in,out]  self            handle
+ *  @param[in,out]  pkts            spi packets
+ *  @param[in]      num             number of packets
+ *  @return         uint32_t        number of processed packets, 0: no write sequence
+ *
+ */
+static uint32_t sfm_batch_fused (t_sfm *self, t_sfm_pkt pkts[], uint32_t num)
+{
+    /** Variables **/
+    uint8_t     hdl;        // write instruction handler
+    uint8_t     ist;        // write instruction
+    uint32_t    uint32Adr;  // traced address
+    uint32_t    i = 2;      // processed packets
+
+    /* Write Enable followed by write instruction */
+    if ( (2 > num) || (1 != pkts[0].uint32Len) || (SFM_HDL_WR_ENA != self->desc.uint8IstHdl[pkts[0].uint8PtrSpi[0]]) || (0 == pkts[1].uint32Len) ) {
+        return 0;
+    }
+    hdl = self->desc.uint8IstHdl[pkts[1].uint8PtrSpi[0]];
+    if ( (0 == sfm_hdl_wr_page(hdl)) && (SFM_HDL_ERASE_SECTOR != hdl) && (SFM_HDL_ERASE_SECTOR_4B != hdl) && (SFM_HDL_ERASE_BLOCK != hdl)
+         && (SFM_HDL_ERASE_BLOCK_4B != hdl) && (SFM_HDL_ERASE_BULK != hdl) ) {
+        return 0;
+    }
+    /* write enable */
+    sfm_trace_start(self, pkts[0].uint8PtrSpi, 1);
+    sfm_bus_charge(self, SFM_HDL_WR_ENA, 1);
+    sfm_stats_ist(self, pkts[0].uint8PtrSpi[0], 1, SFM_OK);
+    sfm_trace_pkt(self, pkts[0].uint8PtrSpi[0], 0, pkts[0].uint8PtrSpi, 1, SFM_OK);
+    self->uint8StatusReg1 |= self->flashType->uint8FlashMngWrEnaMsk;
+    pkts[0].uint8PtrSpi[0] = 0;
+    pkts[0].intRet = SFM_OK;
+    /* write */
+    ist = pkts[1].uint8PtrSpi[0];
+    uint32Adr = sfm_trace_start(self, pkts[1].uint8PtrSpi, pkts[1].uint32Len);
+    sfm_bus_charge(self, hdl, pkts[1].uint32Len);
+    pkts[1].intRet = SFM_IST_HDL[hdl](self, pkts[1].uint8PtrSpi, pkts[1].uint32Len);
+    sfm_stats_ist(self, ist, pkts[1].uint32Len, pkts[1].intRet);
+    sfm_trace_pkt(self, ist, uint32Adr, pkts[1].uint8PtrSpi, pkts[1].uint32Len, pkts[1].intRet);
+    /* wait until ready */
+    if ( (i < num) && (0 != pkts[i].uint32Len) && (SFM_HDL_RD_STATE_REG == self->desc.uint8IstHdl[pkts[i].uint8PtrSpi[0]]) ) {
+        i += sfm_batch_poll(self, pkts + i, num - i);
+    }
+    return i;
+}
+
+
+
+/**
+ *  sfm_batch
+ *    processes sequence of spi packets
+ */
+int sfm_batch (t_sfm *self, t_sfm_pkt pkts[], uint32_t num)
+{
+    /** Variables **/
+    int         intRet = SFM_OK;    // return value
+    uint32_t    i, j;               // iterator
+    uint8_t     hdl;                // instruction handler
+    uint8_t     ist;                // instruction
+    uint32_t    uint32Adr;          // traced address
+
+    /* messages per packet */
+    if ( 0 != self->intMsgLevel ) {
+        for ( i = 0; i < num; i++ ) {
+            pkts[i].intRet = sfm(self, pkts[i].uint8PtrSpi, pkts[i].uint32Len);
+            intRet |= pkts[i].intRet;
+        }
+        return intRet;
+    }
+
+    /* flash type selected and memory allocated */
+    if ( NULL == self->flashType ) {
+        intRet = SFM_E_NO_FLASH;
+    } else if ( 0 == sfm_mem_ready(self) ) {
+        intRet = SFM_E_MALLOC;
+    }
+    if ( SFM_OK != intRet ) {
+        for ( i = 0; i < num; i++ ) {
+            pkts[i].intRet = intRet;
+        }
+        return intRet;
+    }
+
+    /* process packets */
+    for ( i = 0; i < num; i += j ) {
+        /* empty SPI packet */
+        if ( 0 == pkts[i].uint32Len ) {
+            pkts[i].intRet = SFM_OK;
+            j = 1;
+            continue;
+        }
+        /* fused sequences */
+        hdl = self->desc.uint8IstHdl[pkts[i].uint8PtrSpi[0]];
+        if ( SFM_HDL_WR_ENA == hdl ) {
+            j = sfm_batch_fused(self, pkts + i, num - i);
+        } else if ( SFM_HDL_RD_STATE_REG == hdl ) {
+            j = sfm_batch_poll(self, pkts + i, num - i);
+        } else {
+            j = 0;
+        }
+        /* single packet */
+        if ( 0 == j ) {
+            ist = pkts[i].uint8PtrSpi[0];
+            uint32Adr = sfm_trace_start(self, pkts[i].uint8PtrSpi, pkts[i].uint32Len);
+            sfm_bus_charge(self, hdl, pkts[i].uint32Len);
+            pkts[i].intRet = SFM_IST_HDL[hdl](self, pkts[i].uint8PtrSpi, pkts[i].uint32Len);
+            sfm_stats_ist(self, ist, pkts[i].uint32Len, pkts[i].intRet);
+            sfm_trace_pkt(self, ist, uint32Adr, pkts[i].uint8PtrSpi, pkts[i].uint32Len, pkts[i].intRet);
+            j = 1;
+        }
+        for ( uint32_t k = i; k < i + j; k++ ) {
+            intRet |= pkts[k].intRet;
+        }
+    }
+    return intRet;
+}
+
+
+
+
+/** @brief sfm_iov_gather
+ *
+ *  copies start of scattered spi packet into contiguous buffer
+ *
+ *  @param[in]      iov             spi packet segments
+ *  @param[in]      num             number of segments
+ *  @param[out]     *buf            contiguous buffer
+ *  @param[in]      len             number of bytes to copy
+ *
+ */
+static void sfm_iov_gather (const t_sfm_iov iov[], uint32_t num, uint8_t *buf, uint32_t len)
+{
+    /** Variables **/
+    t_sfm_iov_cur   cur = {iov, num, 0, 0}; // segment cursor
+    uint8_t*        uint8PtrPiece;          // piece start
+    uint32_t        uint32Piece;            // piece length
+
+    while ( (len > 0) && (NULL != (uint8PtrPiece = sfm_iov_next(&cur, len, &uint32Piece))) ) {
+        memcpy(buf, uint8PtrPiece, uint32Piece);
+        buf += uint32Piece;
+        len -= uint32Piece;
+    }
+}
+
+
+
+/** @brief sfm_iov_scatter
+ *
+ *  copies contiguous buffer back into scattered spi packet
+ *
+ *  @param[in,out]  iov             spi packet segments
+ *  @param[in]      num             number of segments
+ *  @param[in]      *buf            contiguous buffer
+ *  @param[in]      len             number of bytes to copy
+ *
+ */
+static void sfm_iov_scatter (const t_sfm_iov iov[], uint32_t num, const uint8_t *buf, uint32_t len)
+{
+    /** Variables **/
+    t_sfm_iov_cur   cur = {iov, num, 0, 0}; // segment cursor
+    uint8_t*        uint8PtrPiece;          // piece start
+    uint32_t        uint32Piece;            // piece length
+
+    while ( (len > 0) && (NULL != (uint8PtrPiece = sfm_iov_next(&cur, len, &uint32Piece))) ) {
+        memcpy(uint8PtrPiece, buf, uint32Piece);
+        buf += uint32Piece;
+        len -= uint32Piece;
+    }
+}
+
+
+
+/**
+ *  sfm_iov
+ *    access SPI Flash Model with scattered packet
+ */
+int sfm_iov (t_sfm *self, const t_sfm_iov iov[], uint32_t num)
+{
+    /** Variables **/
+    int             intRet;                 // return value
+    uint32_t        uint32Len = 0;          // packet length
+    uint32_t        i;                      // iterator
+    uint8_t         ist;                    // instruction
+    uint8_t         hdl;                    // instruction handler
+    uint8_t         uint8Hdr[SFM_IOV_HDR];  // instruction and address bytes
+    uint8_t*        uint8PtrBounce;         // contiguous packet copy
+    const uint8_t*  uint8PtrTrc = NULL;     // processed packet for trace, NULL: scattered
+    uint32_t        uint32Adr;              // traced address
+    t_sfm_iov_cur   cur = {iov, num, 0, 0}; // segment cursor
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* flash type selected */
+    if ( NULL == self->flashType) {
+        printf("  ERROR:%s: no flash selected\n", __FUNCTION__);
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+        return SFM_E_MALLOC;
+    }
+
+    /* packet length */
+    for ( i = 0; i < num; i++ ) {
+        uint32Len += iov[i].uint32Len;
+    }
+    if ( 0 == uint32Len ) {
+        return SFM_OK;
+    }
+
+    /* instruction and address */
+    sfm_iov_gather(iov, num, uint8Hdr, sfm_min_uint32(uint32Len, SFM_IOV_HDR));
+    ist = uint8Hdr[0];
+    hdl = self->desc.uint8IstHdl[ist];
+    uint32Adr = sfm_trace_start(self, uint8Hdr, uint32Len);
+    sfm_bus_charge(self, hdl, uint32Len);
+
+    /* data phase in place */
+    if ( 0 != sfm_hdl_rd(hdl) ) {
+        intRet = sfm_rd_data(self, uint8Hdr, uint32Len, &cur);
+    } else if ( 0 != sfm_hdl_wr_page(hdl) ) {
+        intRet = sfm_wr_page(self, uint8Hdr, uint32Len, &cur, &cur);
+
+    /* short packet, status/id/erase */
+    } else if ( uint32Len <= SFM_IOV_HDR ) {
+        intRet = SFM_IST_HDL[hdl](self, uint8Hdr, uint32Len);
+        sfm_iov_scatter(iov, num, uint8Hdr, uint32Len);
+        uint8PtrTrc = uint8Hdr;
+
+    /* long packet, bounce buffer */
+    } else {
+        uint8PtrBounce = malloc(uint32Len);
+        if ( NULL == uint8PtrBounce ) {
+            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: bounce buffer allocation failed\n", __FUNCTION__); }
+            return SFM_E_MALLOC;
+        }
+        sfm_iov_gather(iov, num, uint8PtrBounce, uint32Len);
+        intRet = SFM_IST_HDL[hdl](self, uint8PtrBounce, uint32Len);
+        sfm_iov_scatter(iov, num, uint8PtrBounce, uint32Len);
+        free(uint8PtrBounce);
+    }
+    sfm_stats_ist(self, ist, uint32Len, intRet);
+    sfm_trace_pkt(self, ist, uint32Adr, uint8PtrTrc, uint32Len, intRet);
+    return intRet;
+}
+
+
+
+/**
+ *  sfm_xfer
+ *    access SPI Flash Model full-duplex
+ */
+int sfm_xfer (t_sfm *self, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    /** Variables **/
+    int             intRet;                         // return value
+    uint8_t         ist;                            // instruction
+    uint8_t         hdl;                            // instruction handler
+    uint8_t         uint8Hdr[SFM_IOV_HDR];          // instruction and address bytes
+    uint8_t*        uint8PtrPkt;                    // in place packet for remaining instructions
+    uint32_t        uint32Adr;                      // traced address
+    t_sfm_iov       iovTx = {(uint8_t*) tx, len};   // request, only read
+    t_sfm_iov       iovRx = {rx, len};              // response
+    t_sfm_iov_cur   curTx = {&iovTx, 1, 0, 0};      // request cursor
+    t_sfm_iov_cur   curRx = {&iovRx, 1, 0, 0};      // response cursor
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* flash type selected */
+    if ( NULL == self->flashType) {
+        printf("  ERROR:%s: no flash selected\n", __FUNCTION__);
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+        return SFM_E_MALLOC;
+    }
+
+    /* empty SPI packet */
+    if ( 0 == len ) {
+        return SFM_OK;
+    }
+
+    /* instruction and address, without tx is MOSI idle high */
+    if ( NULL != tx ) {
+        memcpy(uint8Hdr, tx, sfm_min_uint32(len, SFM_IOV_HDR));
+    } else {
+        memset(uint8Hdr, 0xff, SFM_IOV_HDR);
     }
+    ist = uint8Hdr[0];
+    hdl = self->desc.uint8IstHdl[ist];
+    uint32Adr = sfm_trace_start(self, uint8Hdr, len);
+    sfm_bus_charge(self, hdl, len);
 
-    /* check desired file extension */
-    charPtrFileExt = strrchr(fileName, '.') + 1;
-    /* no file extension */
-    if ( !charPtrFileExt ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: No file name\n", __FUNCTION__); }
+    /* data phase without request copy */
+    if ( (0 != sfm_hdl_data(hdl)) && (NULL != tx) ) {
+        if ( 0 != sfm_hdl_rd(hdl) ) {
+            intRet = sfm_rd_data(self, uint8Hdr, len, (NULL != rx) ? &curRx : NULL);
+        } else if ( tx == rx ) {
+            intRet = sfm_wr_page(self, uint8Hdr, len, &curTx, &curTx);
+        } else {
+            intRet = sfm_wr_page(self, uint8Hdr, len, &curTx, (NULL != rx) ? &curRx : NULL);
+        }
+        /* rejected request is returned unchanged, like in place */
+        if ( (SFM_OK != intRet) && (NULL != rx) && (tx != rx) ) {
+            memcpy(rx, tx, len);
+        }
+        sfm_stats_ist(self, ist, len, intRet);
+        sfm_trace_pkt(self, ist, uint32Adr, (0 != sfm_hdl_wr_page(hdl)) ? tx : rx, len, intRet);
+        return intRet;
+    }
+
+    /* remaining instructions work in place, response buffer or scratch */
+    if ( NULL != rx ) {
+        uint8PtrPkt = rx;
+    } else if ( len <= SFM_IOV_HDR ) {
+        uint8PtrPkt = uint8Hdr;
+    } else {
+        uint8PtrPkt = malloc(len);
+        if ( NULL == uint8PtrPkt ) {
+            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: scratch buffer allocation failed\n", __FUNCTION__); }
+            return SFM_E_MALLOC;
+        }
+    }
+    if ( NULL == tx ) {
+        memset(uint8PtrPkt, 0xff, len);
+    } else if ( tx != uint8PtrPkt ) {
+        memmove(uint8PtrPkt, tx, len);
+    }
+    intRet = SFM_IST_HDL[hdl](self, uint8PtrPkt, len);
+    sfm_stats_ist(self, ist, len, intRet);
+    sfm_trace_pkt(self, ist, uint32Adr, uint8PtrPkt, len, intRet);
+    if ( (uint8PtrPkt != rx) && (uint8PtrPkt != uint8Hdr) ) {
+        free(uint8PtrPkt);
+    }
+    return intRet;
+}
+
+
+
+/** @brief sfm_cs_miso
+ *
+ *  response of frame byte outside Read Data and Page Program data phase
+ *
+ *  @param[in]      self            handle
+ *  @param[in]      pos             byte position in frame
+ *  @return         uint8_t         response byte
+ *
+ */
+static uint8_t sfm_cs_miso (const t_sfm *self, uint32_t pos)
+{
+    /** Variables **/
+    uint32_t    uint32IdPos;    // first ID byte in frame
+
+    if ( (SFM_HDL_RD_STATE_REG == self->cs.uint8Hdl) && (1 == pos) ) {
+        /* same status as sfm_ist_rd_state_reg, poll counter is updated on release */
+        if ( 0 != sfm_wip_busy(self) ) {
+            return (uint8_t) (self->uint8StatusReg1 | self->flashType->uint8FlashMngWipMsk);
+        }
+        return (uint8_t) (self->uint8StatusReg1 & ~self->flashType->uint8FlashMngWipMsk);
+    }
+    if ( SFM_HDL_RD_ID == self->cs.uint8Hdl ) {
+        uint32IdPos = self->desc.uint32RdIdLen - self->desc.uint8IdLen;
+        if ( (pos >= uint32IdPos) && (pos < self->desc.uint32RdIdLen) ) {
+            return self->desc.uint8Id[pos - uint32IdPos];
+        }
+    }
+    return 0;
+}
+
+
+
+/** @brief sfm_cs_data_start
+ *
+ *  instruction and address of Read Data or Page Program are complete, prepares data phase
+ *
+ *  @param[in,out]  self            handle
+ *
+ */
+static void sfm_cs_data_start (t_sfm *self)
+{
+    /** Variables **/
+    uint32_t    flashAdr;   // address in flash
+
+    flashAdr = sfm_spi_to_adr (self->cs.uint8Pkt+1, sfm_hdl_adr_bytes(self, self->cs.uint8Hdl));
+    if ( 0 != sfm_hdl_rd(self->cs.uint8Hdl) ) {
+        if ( (SFM_HDL_RD_QUAD_IO == self->cs.uint8Hdl) && (0x20 == (self->cs.uint8Pkt[self->desc.uint32AdrIstLen] & 0x30)) ) {
+            if ( 0 != self->intMsgLevel ) {
+                printf("  ERROR:sfm: Continuous read mode not supported, mode=0x%02x\n", self->cs.uint8Pkt[self->desc.uint32AdrIstLen]);
+            }
+            self->cs.intRet = SFM_E_IST_FLASH;
+        }
+        self->cs.uint32Adr = flashAdr & self->desc.uint32TotalMsk;
+        return;
+    }
+    /* Page Program, checks like sfm_ist_wr_page */
+    if ( 0 == (self->uint8StatusReg1 & self->flashType->uint8FlashMngWrEnaMsk) ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Page Program while write protection\n");
+        }
+        self->cs.intRet = SFM_E_WP_FLASH;
+        return;
+    }
+    if ( SFM_OK != sfm_wip_check(self) ) {
+        self->cs.intRet = SFM_E_WIP_FLASH;
+        return;
+    }
+    flashAdr &= self->desc.uint32TotalMsk;  // upper address bits ignored
+    self->cs.uint32Base = flashAdr & ~self->desc.uint32PageMsk;
+    self->cs.uint32Adr = flashAdr & self->desc.uint32PageMsk;
+    if ( (NULL == sfm_mem_sector(self, self->cs.uint32Base >> self->desc.uint8SectorShift, 1)) || (NULL == sfm_wear_prog(self, self->cs.uint32Base)) ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Sector allocation failed\n");
+        }
+        self->cs.intRet = SFM_E_MALLOC;
+    }
+}
+
+
+
+/**
+ *  sfm_cs_low
+ *    assert chip select
+ */
+int sfm_cs_low (t_sfm *self)
+{
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* flash type selected */
+    if ( NULL == self->flashType) {
+        printf("  ERROR:%s: no flash selected\n", __FUNCTION__);
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* memory allocated */
+    if ( 0 == sfm_mem_ready(self) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+        return SFM_E_MALLOC;
+    }
+
+    /* frame open */
+    if ( 0 != self->cs.intActive ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: chip select already asserted\n", __FUNCTION__); }
+        return SFM_E_CS;
+    }
+
+    /* new frame */
+    self->cs.intActive = 1;
+    self->cs.intRet = SFM_OK;
+    self->cs.uint8Hdl = SFM_HDL_UNKNOWN;
+    self->cs.uint32Len = 0;
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_cs_xfer
+ *    clock bytes of chip select frame
+ */
+int sfm_cs_xfer (t_sfm *self, const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    /** Variables **/
+    uint8_t     uint8Mosi;      // request byte
+    uint32_t    uint32Piece;    // bytes in contiguous piece
+    uint8_t*    uint8PtrPage;   // page storage
+    int         intData;        // frame is in data phase
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* frame open */
+    if ( 0 == self->cs.intActive ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: chip select not asserted\n", __FUNCTION__); }
+        return SFM_E_CS;
+    }
+
+    /* instruction, address and short instructions, byte wise */
+    intData = (0 != sfm_hdl_data(self->cs.uint8Hdl)) && (self->cs.uint32Len >= sfm_hdl_hdr_len(self, self->cs.uint8Hdl));
+    while ( (len > 0) && (0 == intData) ) {
+        uint8Mosi = (NULL != tx) ? *(tx++) : 0xff;
+        if ( self->cs.uint32Len < SFM_CS_PKT_MAX ) {
+            self->cs.uint8Pkt[self->cs.uint32Len] = uint8Mosi;
+        }
+        if ( 0 == self->cs.uint32Len ) {
+            self->cs.uint8Hdl = self->desc.uint8IstHdl[uint8Mosi];
+        }
+        if ( NULL != rx ) {
+            *(rx++) = sfm_cs_miso(self, self->cs.uint32Len);
+        }
+        if ( UINT32_MAX != self->cs.uint32Len ) {
+            self->cs.uint32Len++;
+        }
+        len--;
+        intData = (0 != sfm_hdl_data(self->cs.uint8Hdl)) && (self->cs.uint32Len == sfm_hdl_hdr_len(self, self->cs.uint8Hdl));
+        if ( 0 != intData ) {
+            sfm_cs_data_start(self);
+        }
+    }
+    if ( 0 == len ) {
+        return SFM_OK;
+    }
+    self->cs.uint32Len = (len > UINT32_MAX - self->cs.uint32Len) ? UINT32_MAX : (self->cs.uint32Len + len);
+
+    /* Read Data, pieces end at latest on flash end, rejected read drives zeros */
+    if ( 0 != sfm_hdl_rd(self->cs.uint8Hdl) ) {
+        if ( (NULL != rx) && (SFM_OK != self->cs.intRet) ) {
+            memset(rx, 0, len);
+            return SFM_OK;
+        }
+        while ( (NULL != rx) && (len > 0) ) {
+            uint32Piece = sfm_min_uint32(len, self->flashType->uint32FlashTopoTotalSizeByte - self->cs.uint32Adr);
+            sfm_mem_rd(self, self->cs.uint32Adr, rx, uint32Piece);
+            self->cs.uint32Adr = (self->cs.uint32Adr + uint32Piece) & self->desc.uint32TotalMsk;
+            rx += uint32Piece;
+            len -= uint32Piece;
+        }
+        return SFM_OK;
+    }
+
+    /* Page Program, response echoes request like sfm */
+    if ( NULL != rx ) {
+        if ( NULL != tx ) {
+            memcpy(rx, tx, len);
+        } else {
+            memset(rx, 0xff, len);
+        }
+    }
+    if ( (SFM_OK != self->cs.intRet) || (NULL == tx) ) {  // rejected or idle line, 1s do not program
+        return SFM_OK;
+    }
+    uint8PtrPage = sfm_mem_sector(self, self->cs.uint32Base >> self->desc.uint8SectorShift, 1) + (self->cs.uint32Base & self->desc.uint32SectorMsk);
+    while ( len > 0 ) {
+        uint32Piece = sfm_min_uint32(len, self->flashType->uint32FlashTopoPageSizeByte - self->cs.uint32Adr);
+        sfm_and_uint8(uint8PtrPage + self->cs.uint32Adr, tx, uint32Piece);
+        self->cs.uint32Adr = (self->cs.uint32Adr + uint32Piece) & self->desc.uint32PageMsk;
+        tx += uint32Piece;
+        len -= uint32Piece;
+    }
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_cs_high
+ *    release chip select, execute instruction
+ */
+int sfm_cs_high (t_sfm *self)
+{
+    /** Variables **/
+    int             intRet;             // return value
+    uint8_t         ist;                // instruction
+    uint32_t        uint32Adr;          // traced address
+    const uint8_t*  uint8PtrTrc = NULL; // processed packet for trace, NULL: streamed
+    uint32_t*       uint32PtrProg;      // program cycles of page
+
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* frame open */
+    if ( 0 == self->cs.intActive ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: chip select not asserted\n", __FUNCTION__); }
+        return SFM_E_CS;
+    }
+    self->cs.intActive = 0;
+
+    /* empty frame */
+    if ( 0 == self->cs.uint32Len ) {
+        return SFM_OK;
+    }
+    ist = self->cs.uint8Pkt[0];
+    uint32Adr = sfm_trace_start(self, self->cs.uint8Pkt, sfm_min_uint32(self->cs.uint32Len, SFM_CS_PKT_MAX));
+    sfm_bus_charge(self, self->cs.uint8Hdl, self->cs.uint32Len);
+
+    /* streamed data phase */
+    if ( (0 != sfm_hdl_data(self->cs.uint8Hdl)) && (self->cs.uint32Len >= sfm_hdl_hdr_len(self, self->cs.uint8Hdl)) ) {
+        if ( (0 != sfm_hdl_wr_page(self->cs.uint8Hdl)) && (SFM_OK == self->cs.intRet) && (NULL != (uint32PtrProg = sfm_wear_prog(self, self->cs.uint32Base))) ) {
+            (*uint32PtrProg)++;
+            sfm_wip_start(self, self->flashType->uint32FlashTimePageProgUs);
+        }
+        intRet = self->cs.intRet;
+
+    /* short instruction, executed on frame buffer */
+    } else if ( self->cs.uint32Len > SFM_CS_PKT_MAX ) {
+        if ( 0 != self->intMsgLevel ) {
+            printf("  ERROR:sfm: Malformed instruction '0x%02x', frame length %u\n", ist, self->cs.uint32Len);
+        }
+        intRet = SFM_E_IST_FLASH;
+    } else {
+        intRet = SFM_IST_HDL[self->cs.uint8Hdl](self, self->cs.uint8Pkt, self->cs.uint32Len);
+        uint8PtrTrc = self->cs.uint8Pkt;
+    }
+    sfm_stats_ist(self, ist, self->cs.uint32Len, intRet);
+    sfm_trace_pkt(self, ist, uint32Adr, uint8PtrTrc, self->cs.uint32Len, intRet);
+    return intRet;
+}
+
+
+
+/**
+ *  sfm_time_mode
+ *    select busy time emulation
+ */
+int sfm_time_mode (t_sfm *self, int mode)
+{
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* flash type selected */
+    if ( NULL == self->flashType) {
+        printf("  ERROR:%s: no flash selected\n", __FUNCTION__);
+        return SFM_E_NO_FLASH;;
+    }
+
+    /* switch, pending write in progress is done */
+    self->intTimeMode = (SFM_TIME_VIRTUAL == mode) ? SFM_TIME_VIRTUAL : SFM_TIME_POLL;
+    self->uint8WipRdAfterWriteCnt = 0;
+    self->uint64WipDoneNs = self->uint64TimeNs;
+    return SFM_OK;
+}
+
+
+
+/**
+ *  sfm_time_advance
+ *    advance virtual clock
+ */
+void sfm_time_advance (t_sfm *self, uint64_t ns)
+{
+    self->uint64TimeNs += ns;
+}
+
+
+
+/**
+ *  sfm_time_next
+ *    advance virtual clock to next event
+ */
+uint64_t sfm_time_next (t_sfm *self)
+{
+    /** Variables **/
+    uint64_t    uint64Skip; // skipped time
+
+    if ( (SFM_TIME_VIRTUAL != self->intTimeMode) || (self->uint64TimeNs >= self->uint64WipDoneNs) ) {
+        return 0;
+    }
+    uint64Skip = self->uint64WipDoneNs - self->uint64TimeNs;
+    self->uint64TimeNs = self->uint64WipDoneNs;
+    return uint64Skip;
+}
+
+
+
+/**
+ *  sfm_bus_cfg
+ *    SPI clock of bus time accounting
+ */
+int sfm_bus_cfg (t_sfm *self, uint32_t sckHz)
+{
+    /* Function Call Message */
+    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+
+    /* check clock */
+    if ( 0 == sckHz ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: SPI clock of 0Hz\n", __FUNCTION__); }
         return SFM_E_ACCESS;
+    }
+    /* new clock, accounting restarts */
+    self->bus.uint32SckHz = sckHz;
+    self->bus.uint64NsPerCycle = (1000000000ULL << 32) / sckHz;
+    self->bus.uint64CycFast = (UINT64_MAX - 0xffffffffULL) / self->bus.uint64NsPerCycle;
+    sfm_bus_reset(self);
+    return SFM_OK;
+}
 
-    /* dif extension */
-    } else if ( 0 == strcasecmp("dif", charPtrFileExt) ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
-        /* File write */
-        if ( 0 != sfm_write_dif ( self->uint8PtrMem,
-                                  self->flashType->uint32FlashTopoTotalSizeByte,
-                                  fileName
-                                )
-        ) {
-            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: failed to open file '%s'\n", __FUNCTION__, fileName); }
+
+
+/**
+ *  sfm_bus_reset
+ *    clear bus time accounting
+ */
+void sfm_bus_reset (t_sfm *self)
+{
+    self->bus.uint64Cycles = 0;
+    self->bus.uint64DataByte = 0;
+    memset(self->bus.uint64LaneByte, 0, sizeof(self->bus.uint64LaneByte));
+}
+
+
+
+/**
+ *  sfm_bus_ns
+ *    accumulated bus time
+ */
+uint64_t sfm_bus_ns (const t_sfm *self)
+{
+    return sfm_bus_cycles_ns(self, self->bus.uint64Cycles);
+}
+
+
+
+/**
+ *  sfm_bus_mbps
+ *    effective data rate on bus
+ */
+double sfm_bus_mbps (const t_sfm *self)
+{
+    /** Variables **/
+    uint64_t    uint64Ns;   // bus time
+
+    uint64Ns = sfm_bus_ns(self);
+    if ( 0 == uint64Ns ) {
+        return 0;
+    }
+    return (double) self->bus.uint64DataByte * 1000.0 / (double) uint64Ns;  // byte/ns -> MB/s
+}
+
+
+
+#if SFM_STATS
+/**
+ *  sfm_stats_snapshot
+ *    copy instrumentation counters
+ */
+void sfm_stats_snapshot (const t_sfm *self, t_sfm_stats *snap)
+{
+    memcpy(snap, &self->stats, sizeof(*snap));
+}
+
+
+
+/**
+ *  sfm_stats_reset
+ *    clear instrumentation counters
+ */
+void sfm_stats_reset (t_sfm *self)
+{
+    memset(&self->stats, 0, sizeof(self->stats));
+}
+
+
+
+/** @brief sfm_stats_line
+ *
+ *  writes one counter line
+ *
+ *  @param[in]      fp              output
+ *  @param[in]      csv             0: text, otherwise comma separated
+ *  @param[in]      name            counter name
+ *  @param[in]      cnt             counter
+ *
+ */
+static void sfm_stats_line (FILE *fp, int csv, const char *name, const t_sfm_stats_cnt *cnt)
+{
+    /** Variables **/
+    double  avg;    // average request length
+
+    if ( 0 == cnt->uint64Calls ) {
+        return;
+    }
+    avg = (double) cnt->uint64Bytes / (double) cnt->uint64Calls;
+    if ( 0 != csv ) {
+        fprintf(fp, "%s,%llu,%llu,%llu,%u,%.1f,%u\n", name, (unsigned long long) cnt->uint64Calls, (unsigned long long) cnt->uint64Bytes,
+                (unsigned long long) cnt->uint64Errors, cnt->uint32LenMin, avg, cnt->uint32LenMax);
+    } else {
+        fprintf(fp, "  %-10s %12llu %14llu %10llu %10u %12.1f %10u\n", name, (unsigned long long) cnt->uint64Calls, (unsigned long long) cnt->uint64Bytes,
+                (unsigned long long) cnt->uint64Errors, cnt->uint32LenMin, avg, cnt->uint32LenMax);
+    }
+}
+
+
+
+/**
+ *  sfm_stats_dump
+ *    writes instrumentation counters as text or csv
+ */
+int sfm_stats_dump (const t_sfm_stats *stats, char fileName[])
+{
+    /** Variables **/
+    FILE*   fp = stdout;    // output
+    int     csv = 0;        // comma separated output
+    char*   charPtrFileExt; // file extension
+    char    name[16];       // counter name
+
+    /* output */
+    if ( NULL != fileName ) {
+        charPtrFileExt = sfm_file_ext(fileName);
+        csv = (NULL != charPtrFileExt) && (0 == strcasecmp("csv", charPtrFileExt));
+        fp = fopen(fileName, "w");
+        if ( NULL == fp ) {
             return SFM_E_ACCESS;
         }
-
-    /* Unknown file extension */
-    } else {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: unsupported file type '%s'\n", __FUNCTION__, charPtrFileExt); }
-        return SFM_E_ACCESS;
     }
-
-    /* finish function */
+    /* counters */
+    if ( 0 != csv ) {
+        fprintf(fp, "name,calls,bytes,errors,len_min,len_avg,len_max\n");
+    } else {
+        fprintf(fp, "  %-10s %12s %14s %10s %10s %12s %10s\n", "name", "calls", "bytes", "errors", "len_min", "len_avg", "len_max");
+    }
+    for ( uint32_t i = 0; i < 256; i++ ) {
+        snprintf(name, sizeof(name), "ist_0x%02x", i);
+        sfm_stats_line(fp, csv, name, &stats->ist[i]);
+    }
+    for ( uint32_t i = 0; i < SFM_STATS_FILE_NUM; i++ ) {
+        sfm_stats_line(fp, csv, SFM_STATS_FILE_NAME[i], &stats->file[i]);
+    }
+    /* rejected requests */
+    for ( uint32_t i = 0; i < SFM_STATS_ERR_NUM; i++ ) {
+        if ( 0 == stats->uint64Err[i] ) {
+            continue;
+        }
+        if ( 0 != csv ) {
+            fprintf(fp, "%s,%llu,,,,,\n", SFM_STATS_ERR_NAME[i], (unsigned long long) stats->uint64Err[i]);
+        } else {
+            fprintf(fp, "  %-16s %6llu\n", SFM_STATS_ERR_NAME[i], (unsigned long long) stats->uint64Err[i]);
+        }
+    }
+    /* close */
+    if ( stdout != fp ) {
+        fclose(fp);
+    }
     return SFM_OK;
 }
+#endif
 
 
 
 /**
- *  sfm_load
- *    loads file into flash
- *    .dif -> difference to empty flash, full initialised with 0xff
+ *  sfm_wear_limit
+ *    sets erase endurance
  */
-int sfm_load (t_sfm *self, char fileName[])
+int sfm_wear_limit (t_sfm *self, uint32_t cycles)
 {
-    /** Variables **/
-    char*       charPtrFileExt;         // pointer to file extension
-    uint8_t*    uint8PtrLdBuf = NULL;   // load buffer
+    /* flash type selected */
+    if ( NULL == self->flashType ) {
+        return SFM_E_NO_FLASH;
+    }
+    self->wear.uint32Limit = cycles;
+    return SFM_OK;
+}
 
 
-    /* Function Call Message */
-    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
 
-    /* flash type selected */
+/**
+ *  sfm_wear_reset
+ *    clears erase and program cycles
+ */
+void sfm_wear_reset (t_sfm *self)
+{
     if ( NULL == self->flashType ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); }
-        return SFM_E_NO_FLASH;;
+        return;
     }
-
-    /* memory allocated */
-    uint8PtrLdBuf = (uint8_t*) malloc(self->flashType->uint32FlashTopoTotalSizeByte);   // allocate intermediate buffer
-    if ( (NULL == self->uint8PtrMem) || (NULL == uint8PtrLdBuf) ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
-        return SFM_E_MALLOC;
+    if ( NULL != self->wear.uint32PtrErase ) {
+        memset(self->wear.uint32PtrErase, 0, self->desc.uint32SectorNum * sizeof(uint32_t));
     }
+    sfm_wear_prog_free(self);
+    self->wear.uint32EraseChip = 0;
+    self->wear.uint32EraseMax = 0;
+}
 
-    /* check desired file extension */
-    charPtrFileExt = strrchr(fileName, '.') + 1;
-    /* no file extension */
-    if ( !charPtrFileExt ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: No file name\n", __FUNCTION__); }
-        return SFM_E_ACCESS;
 
-    /* dif extension */
-    } else if ( 0 == strcasecmp("dif", charPtrFileExt) ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
-        /* File read */
-        if ( 0 != sfm_read_dif ( uint8PtrLdBuf,
-                                 self->flashType->uint32FlashTopoTotalSizeByte,
-                                 fileName
-                               )
-        ) {
-            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: failed to open file '%s'\n", __FUNCTION__, fileName); }
-            return SFM_E_ACCESS;
+
+/**
+ *  sfm_wear_hot
+ *    sectors with most erase cycles
+ */
+int sfm_wear_hot (const t_sfm *self, t_sfm_wear_sec hot[], uint32_t max, uint32_t *num)
+{
+    /** Variables **/
+    uint32_t    uint32Erase;    // erase cycles of sector
+    uint32_t    uint32Pages;    // pages per sector
+    uint32_t*   uint32PtrProg;  // program cycles of sector pages
+    uint32_t    j;              // insert position
+
+    /* flash type selected */
+    if ( (NULL == self->flashType) || (NULL == self->wear.uint32PtrErase) ) {
+        return SFM_E_NO_FLASH;
+    }
+    /* sorted insert, hot[*num-1] is coldest kept sector */
+    *num = 0;
+    for ( uint32_t i = 0; i < self->desc.uint32SectorNum; i++ ) {
+        uint32Erase = self->wear.uint32PtrErase[i] + self->wear.uint32EraseChip;
+        if ( (*num == max) && ((0 == max) || (uint32Erase <= hot[max-1].uint32Erase)) ) {
+            continue;   // colder than kept sectors
+        }
+        if ( *num < max ) {
+            (*num)++;
         }
-        /* write back to spi flash */
-        memcpy( self->uint8PtrMem, uint8PtrLdBuf, self->flashType->uint32FlashTopoTotalSizeByte );
+        for ( j = *num - 1; (j > 0) && (hot[j-1].uint32Erase < uint32Erase); j-- ) {
+            hot[j] = hot[j-1];
+        }
+        hot[j].uint32Sector = i;
+        hot[j].uint32Erase = uint32Erase;
+    }
+    /* most programmed page of kept sectors */
+    uint32Pages = (uint32_t) 1 << (self->desc.uint8SectorShift - self->desc.uint8PageShift);
+    for ( uint32_t i = 0; i < *num; i++ ) {
+        uint32PtrProg = self->wear.uint32PtrProg[hot[i].uint32Sector];
+        hot[i].uint32ProgMax = 0;
+        for ( uint32_t k = 0; (NULL != uint32PtrProg) && (k < uint32Pages); k++ ) {
+            if ( uint32PtrProg[k] > hot[i].uint32ProgMax ) {
+                hot[i].uint32ProgMax = uint32PtrProg[k];
+            }
+        }
+    }
+    return SFM_OK;
+}
 
-    /* Unknown file extension */
-    } else {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: unsupported file type '%s'\n", __FUNCTION__, charPtrFileExt); }
+
+
+/**
+ *  sfm_wear_hist
+ *    erase cycle histogram
+ */
+int sfm_wear_hist (const t_sfm *self, uint32_t hist[], uint32_t bins, uint32_t *width)
+{
+    /* flash type selected */
+    if ( (NULL == self->flashType) || (NULL == self->wear.uint32PtrErase) ) {
+        return SFM_E_NO_FLASH;
+    }
+    if ( 0 == bins ) {
         return SFM_E_ACCESS;
     }
-
-    /* finish function */
-    free(uint8PtrLdBuf);
+    /* bin width, covers most erased sector */
+    *width = (uint32_t) (((uint64_t) self->wear.uint32EraseMax + self->wear.uint32EraseChip) / bins + 1);
+    /* count sectors */
+    memset(hist, 0, bins * sizeof(uint32_t));
+    for ( uint32_t i = 0; i < self->desc.uint32SectorNum; i++ ) {
+        hist[(self->wear.uint32PtrErase[i] + self->wear.uint32EraseChip) / *width]++;
+    }
     return SFM_OK;
 }
 
 
 
 /**
- *  sfm_cmp
- *    compares file with internal spi buffer
+ *  sfm_wear_dump
+ *    writes erase cycle histogram and hottest sectors
  */
-int sfm_cmp (t_sfm *self, char fileName[])
+int sfm_wear_dump (const t_sfm *self, char fileName[], uint32_t bins)
 {
     /** Variables **/
-    char*       charPtrFileExt;         // pointer to file extension
-    uint8_t*    uint8PtrLdBuf = NULL;   // load buffer
-
-
-    /* Function Call Message */
-    if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
+    FILE*           fp = stdout;    // output
+    int             csv = 0;        // comma separated output
+    char*           charPtrFileExt; // file extension
+    uint32_t*       uint32PtrHist;  // histogram
+    uint32_t        uint32Width;    // erase cycles per bin
+    t_sfm_wear_sec  hot[8];         // hottest sectors
+    uint32_t        uint32HotNum;   // used hot entries
+    int             intRet;         // return value
 
-    /* flash type selected */
-    if ( NULL == self->flashType ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); }
-        return SFM_E_NO_FLASH;;
+    /* histogram */
+    if ( 0 == bins ) {
+        return SFM_E_ACCESS;
     }
-
-    /* memory allocated */
-    uint8PtrLdBuf = (uint8_t*) malloc(self->flashType->uint32FlashTopoTotalSizeByte);   // allocate intermediate buffer
-    if ( (NULL == self->uint8PtrMem) || (NULL == uint8PtrLdBuf) ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+    uint32PtrHist = (uint32_t*) malloc(bins * sizeof(uint32_t));
+    if ( NULL == uint32PtrHist ) {
         return SFM_E_MALLOC;
     }
-
-    /* check desired file extension */
-    charPtrFileExt = strrchr(fileName, '.') + 1;
-    /* no file extension */
-    if ( !charPtrFileExt ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: No file name\n", __FUNCTION__); }
-        return SFM_E_ACCESS;
-
-    /* dif extension */
-    } else if ( 0 == strcasecmp("dif", charPtrFileExt) ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) { printf("  INFO:%s: '.%s' file type used\n", __FUNCTION__, charPtrFileExt); }
-        /* File read */
-        if ( 0 != sfm_read_dif ( uint8PtrLdBuf,
-                                 self->flashType->uint32FlashTopoTotalSizeByte,
-                                 fileName
-                               )
-        ) {
-            if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: failed to open file '%s'\n", __FUNCTION__, fileName); }
+    intRet = sfm_wear_hist(self, uint32PtrHist, bins, &uint32Width);
+    if ( SFM_OK == intRet ) {
+        intRet = sfm_wear_hot(self, hot, sizeof(hot)/sizeof(hot[0]), &uint32HotNum);
+    }
+    if ( SFM_OK != intRet ) {
+        free(uint32PtrHist);
+        return intRet;
+    }
+    /* output */
+    if ( NULL != fileName ) {
+        charPtrFileExt = sfm_file_ext(fileName);
+        csv = (NULL != charPtrFileExt) && (0 == strcasecmp("csv", charPtrFileExt));
+        fp = fopen(fileName, "w");
+        if ( NULL == fp ) {
+            free(uint32PtrHist);
             return SFM_E_ACCESS;
         }
-
-    /* Unknown file extension */
+    }
+    /* erase cycles histogram */
+    if ( 0 != csv ) {
+        fprintf(fp, "erase_min,erase_max,sectors\n");
     } else {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: unsupported file type '%s'\n", __FUNCTION__, charPtrFileExt); }
-        return SFM_E_ACCESS;
+        fprintf(fp, "  %10s %10s %10s\n", "erase_min", "erase_max", "sectors");
     }
-
-    /* compare memory content */
-    for ( uint32_t i = 0; i < self->flashType->uint32FlashTopoTotalSizeByte; i++ ) {
-        if ( self->uint8PtrMem[i] != uint8PtrLdBuf[i] ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: mismatch at 0x%x: is=0x%02x, exp=0x%02x\n", __FUNCTION__, i, self->uint8PtrMem[i], uint8PtrLdBuf[i]);
-                printf("  ERROR:%s: IS dump\n", __FUNCTION__);
-                sfm_hexdump_uint8 (self->uint8PtrMem, sfm_subtract_uint32(i, 16), sfm_min_uint32(i+16, self->flashType->uint32FlashTopoTotalSizeByte), "    ");
-                printf("  ERROR:%s: EXP dump\n", __FUNCTION__);
-                sfm_hexdump_uint8 (uint8PtrLdBuf, sfm_subtract_uint32(i, 16), sfm_min_uint32(i+16, self->flashType->uint32FlashTopoTotalSizeByte), "    ");
-                free(uint8PtrLdBuf);    // free memory
-            }
-            return SFM_E_CMP;   // mismatch to file
+    for ( uint32_t i = 0; i < bins; i++ ) {
+        if ( 0 != csv ) {
+            fprintf(fp, "%llu,%llu,%u\n", (unsigned long long) i * uint32Width, (unsigned long long) (i + 1) * uint32Width - 1, uint32PtrHist[i]);
+        } else {
+            fprintf(fp, "  %10llu %10llu %10u\n", (unsigned long long) i * uint32Width, (unsigned long long) (i + 1) * uint32Width - 1, uint32PtrHist[i]);
         }
     }
-
-    /* finish function */
-    free(uint8PtrLdBuf);
+    /* hottest sectors */
+    if ( 0 != csv ) {
+        fprintf(fp, "\nsector,erase,prog_max\n");
+    } else {
+        fprintf(fp, "\n  %10s %10s %10s\n", "sector", "erase", "prog_max");
+    }
+    for ( uint32_t i = 0; i < uint32HotNum; i++ ) {
+        if ( 0 != csv ) {
+            fprintf(fp, "%u,%u,%u\n", hot[i].uint32Sector, hot[i].uint32Erase, hot[i].uint32ProgMax);
+        } else {
+            fprintf(fp, "  %10u %10u %10u\n", hot[i].uint32Sector, hot[i].uint32Erase, hot[i].uint32ProgMax);
+        }
+    }
+    /* close */
+    if ( stdout != fp ) {
+        fclose(fp);
+    }
+    free(uint32PtrHist);
     return SFM_OK;
 }
 
 
 
+#if SFM_TRACE
 /**
- *  sfm
- *    access SPI Flash Model
+ *  sfm_trace_open
+ *    starts binary transaction trace
  */
-int sfm (t_sfm *self, uint8_t* spi, uint32_t len)
+int sfm_trace_open (t_sfm *self, char fileName[], uint32_t ringByte, int mode)
 {
     /** Variables **/
-    uint32_t    uint32ExpLen;   // expected length of packet
-    uint32_t    i;              // iterator
-    uint32_t    spiCur = 0;     // current spi position
-    uint8_t     hexId[10];      // buffer variable for hexID
-    uint32_t    hexIdLen;       // length of hex id
-    uint32_t    flashAdr;       // address in flash
-    uint32_t    flashAdrBase;   // address in flash
-
+    t_sfm_trace*        trc;        // trace recorder
+    t_sfm_trace_hdr     hdr;        // trace file header
+    uint64_t            uint64Size; // ring buffer size
 
     /* Function Call Message */
     if ( 0 != self->intMsgLevel ) { printf("__FUNCTION__ = %s\n", __FUNCTION__); };
 
     /* flash type selected */
-    if ( NULL == self->flashType) {
-        printf("  ERROR:%s: no flash selected\n", __FUNCTION__);
-        return SFM_E_NO_FLASH;;
+    if ( NULL == self->flashType ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no flash selected\n", __FUNCTION__); }
+        return SFM_E_NO_FLASH;
     }
-
-    /* memory allocated */
-    if ( NULL == self->uint8PtrMem ) {
-        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: no memory for flash emulation allocated\n", __FUNCTION__); }
+    /* restart */
+    sfm_trace_close(self);
+    /* ring buffer, power of two holds at least some records */
+    uint64Size = 4096;
+    while ( uint64Size < ((0 == ringByte) ? SFM_TRACE_RING_BYTE : ringByte) ) {
+        uint64Size <<= 1;
+    }
+    trc = (t_sfm_trace*) aligned_alloc(_Alignof(t_sfm_trace), sizeof(t_sfm_trace));   // tail on own cache line
+    if ( NULL == trc ) {
         return SFM_E_MALLOC;
     }
-
-    /* empty SPI packet */
-    if ( 0 == len ) {
-        return SFM_OK;
+    memset(trc, 0, sizeof(t_sfm_trace));
+    trc->uint8PtrRing = (uint8_t*) malloc((size_t) uint64Size);
+    if ( NULL == trc->uint8PtrRing ) {
+        free(trc);
+        return SFM_E_MALLOC;
     }
-
-    /* Read Manufacturer / Device ID */
-    if ( spi[0] == self->flashType->uint8FlashIstRdID ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) {
-            printf("  INFO:%s: IST=0x%02x, Read Manufacturer / Device ID\n", __FUNCTION__, self->flashType->uint8FlashIstRdID);
-        }
-        /* check length */
-        uint32ExpLen = (uint32_t) (1 + self->flashType->uint8FlashTopoRdIdDummyByte + (int) strlen(self->flashType->charFlashIdHex)/2);
-        if ( len != uint32ExpLen ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Malformed 'Read Manufacturer / Device ID' instruction, expLen=%d, isLen=%d\n", __FUNCTION__, uint32ExpLen, len);
-            }
-            return SFM_E_IST_FLASH; // malformed instruction
-        }
-        /* convert to hex id */
-        if ( 0 != sfm_asciihex_to_uint8 (self->flashType->charFlashIdHex, hexId, &hexIdLen, sizeof(hexId)/sizeof(hexId[0])) ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Convert %s\n", __FUNCTION__, self->flashType->charFlashIdHex);
-            }
-            return SFM_E_MALLOC;
-        }
-        /* response */
-        spiCur = 0;
-        spi[spiCur++] = 0;  // first assign and then increment
-        for ( i = 0; i < self->flashType->uint8FlashTopoRdIdDummyByte; i++ ) {
-            spi[spiCur++] = 0;
-        }
-        /* copy hex values */
-        for ( i = 0; i < hexIdLen; i++ ) {
-            spi[spiCur++] = hexId[i];
+    trc->uint64Msk = uint64Size - 1;
+    atomic_init(&trc->uint64Head, 0);
+    atomic_init(&trc->uint64Tail, 0);
+    trc->intMode = mode;
+    /* trace file */
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.charMagic, "SFMTRACE", sizeof(hdr.charMagic));
+    hdr.uint32Version = 1;
+    hdr.uint32RecByte = sizeof(t_sfm_trace_rec);
+    hdr.uint32Mode = (uint32_t) mode;
+    hdr.uint32TimeMode = (uint32_t) self->intTimeMode;
+    hdr.uint32SckHz = self->bus.uint32SckHz;
+    strncpy(hdr.charFlash, self->flashType->charFlashName, sizeof(hdr.charFlash) - 1);
+    trc->intFd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if ( (0 > trc->intFd) || (SFM_OK != sfm_fd_wr(trc->intFd, (const uint8_t*) &hdr, sizeof(hdr))) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: trace file '%s' not writable\n", __FUNCTION__, fileName); }
+        if ( 0 <= trc->intFd ) {
+            close(trc->intFd);
         }
-        /* exit */
-        return SFM_OK;
+        free(trc->uint8PtrRing);
+        free(trc);
+        return SFM_E_ACCESS;
+    }
+    /* flush thread */
+    pthread_mutex_init(&trc->mutex, NULL);
+    pthread_cond_init(&trc->cond, NULL);
+    if ( 0 != pthread_create(&trc->thread, NULL, sfm_trace_flush, trc) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: flush thread creation failed\n", __FUNCTION__); }
+        pthread_cond_destroy(&trc->cond);
+        pthread_mutex_destroy(&trc->mutex);
+        close(trc->intFd);
+        free(trc->uint8PtrRing);
+        free(trc);
+        return SFM_E_MALLOC;
+    }
+    self->trace = trc;
+    return SFM_OK;
+}
 
-    /* Write Enable (06h) */
-    } else if ( spi[0] == self->flashType->uint8FlashIstWrEnable ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) {
-            printf("  INFO:%s: IST=0x%02x, Write Enable\n", __FUNCTION__, self->flashType->uint8FlashIstWrEnable);
-        }
-        /* check length */
-        if ( 1 != len ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Malformed 'Write Enable' instruction, expLen=1, isLen=%d\n", __FUNCTION__, len);
-            }
-            return SFM_E_IST_FLASH; // malformed instruction
-        }
-        /* set write enable */
-        self->uint8StatusReg1 |= self->flashType->uint8FlashMngWrEnaMsk;
-        /* spi response */
-        memset(spi, 0, len);
-        /* exit */
-        return SFM_OK;
 
-    /* Write Disable (04h) */
-    } else if ( spi[0] == self->flashType->uint8FlashIstWrDisable ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) {
-            printf("  INFO:%s: IST=0x%02x, Write Disable\n", __FUNCTION__, self->flashType->uint8FlashIstWrDisable);
-        }
-        /* check length */
-        if ( 1 != len ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Malformed 'Write Disable' instruction, expLen=1, isLen=%d\n", __FUNCTION__, len);
-            }
-            return SFM_E_IST_FLASH; // malformed instruction
-        }
-        /* clear write enable */
-        self->uint8StatusReg1 &= (uint8_t) ~(self->flashType->uint8FlashMngWrEnaMsk);
-        /* spi response */
-        memset(spi, 0, len);
-        /* exit */
-        return SFM_OK;
 
-    /* Chip Erase */
-    } else if ( spi[0] == self->flashType->uint8FlashIstEraseBulk ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) {
-            printf("  INFO:%s: IST=0x%02x, Chip Erase\n", __FUNCTION__, self->flashType->uint8FlashIstEraseBulk);
-        }
-        /* check length */
-        if ( 1 != len ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Malformed 'Chip Erase' instruction, expLen=1, isLen=%d\n", __FUNCTION__, len);
-            }
-            return SFM_E_IST_FLASH; // malformed instruction
-        }
-        /* check for write enable */
-        if ( 0 == (self->uint8StatusReg1 & self->flashType->uint8FlashMngWrEnaMsk) ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Chip erase while write protection\n", __FUNCTION__);
-            }
-            return SFM_E_WP_FLASH;  // write protected
-        }
-        /* Write in progress? */
-        if ( 0 != self->uint8WipRdAfterWriteCnt ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: WIP still in progress, read %i times for write access\n", __FUNCTION__, self->uint8WipRdAfterWriteCnt);
-            }
-            return SFM_E_WIP_FLASH; // Write in progress
-        }
-        /* erase */
-        memset(self->uint8PtrMem, 0xff, self->flashType->uint32FlashTopoTotalSizeByte);
-        /* clear write enable */
-        self->uint8StatusReg1 &= (uint8_t) ~(self->flashType->uint8FlashMngWrEnaMsk);
-        /* spi response */
-        memset(spi, 0, len);
-        /* set wait for write in progres */
-        self->uint8WipRdAfterWriteCnt = SFM_WIP_RETRY_IDLE;
-        /* exit */
-        return SFM_OK;
+/**
+ *  sfm_trace_close
+ *    flushes and stops binary transaction trace
+ */
+int sfm_trace_close (t_sfm *self)
+{
+    /** Variables **/
+    t_sfm_trace*    trc = self->trace;  // trace recorder
+    int             intRet = SFM_OK;    // return value
 
-    /* Sector Erase */
-    } else if ( spi[0] == self->flashType->uint8FlashIstEraseSector ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) {
-            printf("  INFO:%s: IST=0x%02x, Sector Erase\n", __FUNCTION__, self->flashType->uint8FlashIstEraseSector);
-        }
-        /* check length */
-        uint32ExpLen = (uint32_t) (1 + self->flashType->uint8FlashTopoAdrBytes);
-        if ( uint32ExpLen != len ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Malformed 'Sector Erase' instruction, expLen=%d, isLen=%d\n", __FUNCTION__, uint32ExpLen, len);
-            }
-            return SFM_E_IST_FLASH; // malformed instruction
-        }
-        /* check for write enable */
-        if ( 0 == (self->uint8StatusReg1 & self->flashType->uint8FlashMngWrEnaMsk) ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Sector erase while write protection\n", __FUNCTION__);
-            }
-            return SFM_E_WP_FLASH;  // write protected
-        }
-        /* Write in progress? */
-        if ( 0 != self->uint8WipRdAfterWriteCnt ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: WIP still in progress, read %i times for write access\n", __FUNCTION__, self->uint8WipRdAfterWriteCnt);
-            }
-            return SFM_E_WIP_FLASH; // Write in progress
-        }
-        /* assemble address */
-        flashAdr = sfm_spi_to_adr (spi+1, self->flashType->uint8FlashTopoAdrBytes);      // spi packet to address
-        flashAdr &= (uint32_t) ~(self->flashType->uint32FlashTopoSectorSizeByte - 1);    // align to sector
-        /* in memory? */
-        if ( self->flashType->uint32FlashTopoTotalSizeByte < flashAdr + self->flashType->uint32FlashTopoSectorSizeByte ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Address (0x%x) exceeds flash size (0x%x)\n", __FUNCTION__, flashAdr, self->flashType->uint32FlashTopoTotalSizeByte);
-            }
-            return SFM_E_ACCESS;    // address exceeds flash
-        }
-        /* erase */
-        memset(self->uint8PtrMem+flashAdr, 0xff, self->flashType->uint32FlashTopoSectorSizeByte);
-        /* clear write enable */
-        self->uint8StatusReg1 &= (uint8_t) ~(self->flashType->uint8FlashMngWrEnaMsk);
-        /* spi response */
-        memset(spi, 0, len);
-        /* set wait for write in progres */
-        self->uint8WipRdAfterWriteCnt = SFM_WIP_RETRY_IDLE;
-        /* exit */
+    /* no trace */
+    if ( NULL == trc ) {
         return SFM_OK;
+    }
+    /* stop flush thread, writes remaining transactions */
+    pthread_mutex_lock(&trc->mutex);
+    trc->intStop = 1;
+    pthread_cond_signal(&trc->cond);
+    pthread_mutex_unlock(&trc->mutex);
+    pthread_join(trc->thread, NULL);
+    if ( (0 != trc->intErr) || (0 != close(trc->intFd)) ) {
+        if ( 0 != self->intMsgLevel ) { printf("  ERROR:%s: trace file write failed\n", __FUNCTION__); }
+        intRet = SFM_E_ACCESS;
+    }
+    if ( (0 != self->intMsgLevel) && (0 != trc->uint64Drop) ) {
+        printf("  INFO:%s: %llu transactions dropped\n", __FUNCTION__, (unsigned long long) trc->uint64Drop);
+    }
+    pthread_cond_destroy(&trc->cond);
+    pthread_mutex_destroy(&trc->mutex);
+    free(trc->uint8PtrRing);
+    free(trc);
+    self->trace = NULL;
+    return intRet;
+}
 
-    /* Read Status Register-1 (05h) */
-    } else if ( spi[0] == self->flashType->uint8FlashIstRdStateReg ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) {
-            printf("  INFO:%s: IST=0x%02x, Read Status Register\n", __FUNCTION__, self->flashType->uint8FlashIstRdStateReg);
-        }
-        /* check length */
-        if ( 2 != len ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Malformed 'Read Status Register' instruction, expLen=2, isLen=%d\n", __FUNCTION__, len);
-            }
-            return SFM_E_IST_FLASH; // malformed instruction
-        }
-        /* state reg 1 has WIP flag */
-        if ( 0 < self->uint8WipRdAfterWriteCnt ) {  // no write (erase/page programm) possible, more WIP polls are necessary
-            --(self->uint8WipRdAfterWriteCnt);
-            self->uint8StatusReg1 |= (uint8_t) (self->flashType->uint8FlashMngWipMsk);  // set WIP
-        } else {    // no WIP
-            self->uint8StatusReg1 &= (uint8_t) ~(self->flashType->uint8FlashMngWipMsk); // clear WIP flag
-        }
-        /* response */
-        spi[0] = 0;
-        spi[1] = self->uint8StatusReg1;
-        /* exit */
-        return SFM_OK;
 
-    /* Read Data */
-    } else if ( spi[0] == self->flashType->uint8FlashIstRdData ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) {
-            printf("  INFO:%s: IST=0x%02x, Read Data\n", __FUNCTION__, self->flashType->uint8FlashIstRdData);
-        }
-        /* check length */
-        if ( len < (uint32_t) (self->flashType->uint8FlashTopoAdrBytes + 1)) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Malformed 'Read Data' instruction, expLen>%d, isLen=%d\n", __FUNCTION__, self->flashType->uint8FlashTopoAdrBytes + 1, len);
-            }
-            return SFM_E_IST_FLASH; // malformed instruction
-        }
-        /* spi packet to address */
-        flashAdr = sfm_spi_to_adr (spi+1, self->flashType->uint8FlashTopoAdrBytes);
-        /* clear start of spi packet */
-        spiCur = (uint32_t) self->flashType->uint8FlashTopoAdrBytes + 1;
-        memset(spi, 0, (size_t) spiCur);
-        /* fetch out the data */
-        for ( i = spiCur; i < len; i++ ) {
-            spi[spiCur++] = self->uint8PtrMem[flashAdr];
-            flashAdr++;
-            flashAdr &= (uint32_t) (self->flashType->uint32FlashTopoTotalSizeByte - 1);  // address overoll
-        }
-        /* exit */
-        return SFM_OK;
 
-    /* Page Program */
-    } else if ( spi[0] == self->flashType->uint8FlashIstWrPage ) {
-        /* entry message */
-        if ( 0 != self->intMsgLevel ) {
-            printf("  INFO:%s: IST=0x%02x, Page Program\n", __FUNCTION__, self->flashType->uint8FlashIstWrPage);
-        }
-        /* check length */
-        if ( len < (uint32_t) (self->flashType->uint8FlashTopoAdrBytes + 1)) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Malformed 'Page Program' instruction, expLen>%d, isLen=%d\n", __FUNCTION__, self->flashType->uint8FlashTopoAdrBytes + 1, len);
-            }
-            return SFM_E_IST_FLASH; // malformed instruction
-        }
-        /* check for write enable */
-        if ( 0 == (self->uint8StatusReg1 & self->flashType->uint8FlashMngWrEnaMsk) ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: Page Program while write protection\n", __FUNCTION__);
-            }
-            return SFM_E_WP_FLASH;  // write protected
-        }
-        /* Write in progress? */
-        if ( 0 != self->uint8WipRdAfterWriteCnt ) {
-            if ( 0 != self->intMsgLevel ) {
-                printf("  ERROR:%s: WIP still in progress, read %i times for write access\n", __FUNCTION__, self->uint8WipRdAfterWriteCnt);
-            }
-            return SFM_E_WIP_FLASH; // Write in progress
-        }
-        /* spi packet to address */
-        flashAdr     = sfm_spi_to_adr (spi+1, self->flashType->uint8FlashTopoAdrBytes);
-        flashAdrBase = flashAdr;
-        flashAdrBase &= (uint32_t) ~(self->flashType->uint32FlashTopoPageSizeByte - 1);  // base address, aligned to pages
-        flashAdr     &= (uint32_t) self->flashType->uint32FlashTopoPageSizeByte - 1;     // in page address
-        /* clear start of spi packet */
-        spiCur = (uint32_t) self->flashType->uint8FlashTopoAdrBytes + 1;
-        memset(spi, 0, (size_t) spiCur);
-        /* page write */
-        for ( i = spiCur; i < len; i++ ) {
-            self->uint8PtrMem[flashAdrBase+flashAdr] &= spi[i]; // in flash can only bits swapped from 1s -> 0s, otherwise erase
-            flashAdr++;
-            flashAdr &= (uint32_t) self->flashType->uint32FlashTopoPageSizeByte - 1; // page overroll
-        }
-        /* set wait for write in progres */
-        self->uint8WipRdAfterWriteCnt = SFM_WIP_RETRY_IDLE;
-        /* exit */
-        return SFM_OK;
+/**
+ *  sfm_trace_drops
+ *    transactions dropped on full ring buffer
+ */
+uint64_t sfm_trace_drops (const t_sfm *self)
+{
+    return (NULL != self->trace) ? self->trace->uint64Drop : 0;
+}
 
-    /* default */
-    } else {
-        if ( 0 != self->intMsgLevel ) {
-            printf("  ERROR:%s: Unknown Instruction '0x%02x'\n", __FUNCTION__, spi[0]);
-        };
-        return SFM_E_IST_FLASH; // malformed instruction
-    }
 
-    /* finish function */
-    return SFM_OK;
+
+/**
+ *  sfm_trace_hash
+ *    data phase hash, 64bit multiply-xorshift on words folded to 32bit
+ */
+uint32_t sfm_trace_hash (const uint8_t *data, uint32_t len)
+{
+    /** Variables **/
+    uint64_t    uint64Hash = 0xcbf29ce484222325ULL ^ len;   // hash state
+    uint64_t    uint64Word;                                 // data word
+
+    for ( ; len >= 8; len -= 8, data += 8 ) {
+        memcpy(&uint64Word, data, sizeof(uint64Word));
+        uint64Hash = (uint64Hash ^ uint64Word) * 0x9e3779b97f4a7c15ULL;
+        uint64Hash ^= uint64Hash >> 32;
+    }
+    for ( ; len > 0; len--, data++ ) {
+        uint64Hash = (uint64Hash ^ *data) * 0x100000001b3ULL;
+    }
+    uint64Hash ^= uint64Hash >> 29;
+    return (uint32_t) (uint64Hash ^ (uint64Hash >> 32));
 }
+#endif
@@ -36,6 +36,8 @@
 #define SFM_E_WP_FLASH      (1<<4)  /**< Flash: write protection active */
 #define SFM_E_WIP_FLASH     (1<<5)  /**< Flash: Write in progress, poll several times more the State register */
 #define SFM_E_CMP           (1<<6)  /**< compare error, mismatch */
+#define SFM_E_CS            (1<<7)  /**< chip select framing violated, f.e. transfer without #sfm_cs_low */
+#define SFM_E_WEAR          (1<<8)  /**< Flash: erase endurance limit of sector exceeded, @see #sfm_wear_limit */
 /** @} */   // SFM_E
 
 
@@ -50,10 +52,91 @@
 #ifndef SFM_WIP_RETRY_IDLE
     #define SFM_WIP_RETRY_IDLE  (3)     /**<  Number of WIP registers poll until after Page write / Erase the SFM is ready for new requests */
 #endif
+#ifndef SFM_SCK_HZ
+    #define SFM_SCK_HZ          (50000000)  /**<  Default SPI clock of bus time accounting in Hz, @see #sfm_bus_cfg */
+#endif
+#ifndef SFM_STATS
+    #define SFM_STATS           (1)         /**<  Instrumentation counters, 0: compiled out */
+#endif
+#ifndef SFM_TRACE
+    #define SFM_TRACE           (1)         /**<  Binary transaction trace, 0: compiled out */
+#endif
+#ifndef SFM_TRACE_RING_BYTE
+    #define SFM_TRACE_RING_BYTE (1<<20)     /**<  Default trace ring buffer size, @see #sfm_trace_open */
+#endif
+#ifndef SFM_IO_CHUNK_BYTE
+    #define SFM_IO_CHUNK_BYTE   (1<<20) /**<  Block size of file read/write, rounded down to multiples of flash sector size */
+#endif
+#ifndef SFM_FLAT_MAX_BYTE
+    #define SFM_FLAT_MAX_BYTE   (1<<24) /**<  Largest flash held in one block by #sfm_init, larger flashes get sparse sectors like #sfm_init_sparse */
+#endif
 /** @} */
 
 
 
+/**
+ *  @defgroup SFM_PARTS
+ *  flash types with compile time specialized entry point sfm_<part>, f.e. #sfm_W25Q16JV.
+ *  X(part, index in #SPI_FLASH), drivers of one known part can reduce the list
+ *  @{
+ */
+#ifndef SFM_PARTS
+    #define SFM_PARTS(X)    \
+        X(W25Q16JV, 0)
+#endif
+/** @} */   // SFM_PARTS
+
+
+
+/**
+ *  @defgroup SFM_MMAP
+ *  mapping modes of #sfm_init_mmap
+ *  @{
+ */
+#define SFM_MMAP_SHARED     (0)     /**< flash changes are written through to the image file */
+#define SFM_MMAP_PRIVATE    (1)     /**< copy-on-write, image file stays unchanged */
+/** @} */   // SFM_MMAP
+
+
+
+/**
+ *  @defgroup SFM_TIME
+ *  busy time emulation modes of #sfm_time_mode
+ *  @{
+ */
+#define SFM_TIME_POLL       (0)     /**< write in progress lasts #SFM_WIP_RETRY_IDLE status register reads */
+#define SFM_TIME_VIRTUAL    (1)     /**< write in progress lasts flash timing on virtual clock, @see #sfm_time_advance */
+/** @} */   // SFM_TIME
+
+
+
+/**
+ *  @defgroup SFM_STATS_FILE
+ *  file operation counters of #t_sfm_stats
+ *  @{
+ */
+#define SFM_STATS_LOAD      (0)     /**< #sfm_load */
+#define SFM_STATS_STORE     (1)     /**< #sfm_store */
+#define SFM_STATS_CMP       (2)     /**< #sfm_cmp, #sfm_cmp_ranges */
+#define SFM_STATS_FILE_NUM  (3)     /**< number of file operation counters */
+#define SFM_STATS_ERR_NUM   (9)     /**< number of counted #SFM_E bits */
+/** @} */   // SFM_STATS_FILE
+
+
+
+/**
+ *  @defgroup SFM_TRACE_MODE
+ *  recorded content of #sfm_trace_open
+ *  @{
+ */
+#define SFM_TRACE_META      (0)     /**< instruction, address, length and status */
+#define SFM_TRACE_HASH      (1<<0)  /**< additional hash of data phase, @see #sfm_trace_hash */
+#define SFM_TRACE_DATA      (1<<1)  /**< additional data phase bytes after record */
+#define SFM_TRACE_REC_DATA  (1<<0)  /**< #t_sfm_trace_rec flag: data phase captured, hash and bytes valid */
+/** @} */   // SFM_TRACE_MODE
+
+
+
 /* C++ compatibility */
 #ifdef __cplusplus
 extern "C"
@@ -67,7 +150,8 @@ extern "C"
  *
  *  @brief  Emulated SPI Flash
  *
- *  Defines Instruction set and topology of emulated flash
+ *  Defines Instruction set and topology of emulated flash, member order is the column
+ *  order of catalog files, keep SFM_CAT_* in spi_flash_model.c in sync
  *
  *  @since  December 18, 2022
  *  @author Andreas Kaeberlein
@@ -83,17 +167,235 @@ typedef struct t_sfm_type {
     uint8_t     uint8FlashIstRdStateReg;        /**<  Flash IST: Read status reg                        */
     uint8_t     uint8FlashIstRdData;            /**<  Flash IST: Read data from flash                   */
     uint8_t     uint8FlashIstWrPage;            /**<  Flash IST: Write page                             */
-    uint8_t     uint8FlashTopoAdrBytes;         /**<  Flash Topo: Number of address bytes               */
+    uint8_t     uint8FlashIstRdFast;            /**<  Flash IST: Fast Read, 1-1-1, 0: not supported    */
+    uint8_t     uint8FlashIstRdDualOut;         /**<  Flash IST: Fast Read Dual Output, 1-1-2          */
+    uint8_t     uint8FlashIstRdQuadOut;         /**<  Flash IST: Fast Read Quad Output, 1-1-4          */
+    uint8_t     uint8FlashIstRdQuadIo;          /**<  Flash IST: Fast Read Quad I/O, 1-4-4, mode bits   */
+    uint8_t     uint8FlashIstEraseBlock;        /**<  Flash IST: Block Erase, 0: not supported         */
+    uint8_t     uint8FlashIstAdr4BEnter;        /**<  Flash IST: Enter 4-Byte Address Mode              */
+    uint8_t     uint8FlashIstAdr4BExit;         /**<  Flash IST: Exit 4-Byte Address Mode               */
+    uint8_t     uint8FlashIstRdData4B;          /**<  Flash IST: Read Data with 4-Byte Address          */
+    uint8_t     uint8FlashIstWrPage4B;          /**<  Flash IST: Page Program with 4-Byte Address       */
+    uint8_t     uint8FlashIstEraseSector4B;     /**<  Flash IST: Sector Erase with 4-Byte Address       */
+    uint8_t     uint8FlashIstEraseBlock4B;      /**<  Flash IST: Block Erase with 4-Byte Address        */
+    uint8_t     uint8FlashTopoAdrBytes;         /**<  Flash Topo: Number of address bytes after power up */
     uint32_t    uint32FlashTopoSectorSizeByte;  /**<  Flash Topo: Flash Sector Size in Byte             */
+    uint32_t    uint32FlashTopoBlockSizeByte;   /**<  Flash Topo: Flash Block Size in Byte, 0: no Block Erase */
     uint32_t    uint32FlashTopoPageSizeByte;    /**<  Flash Topo: Flash Page Size in Byte               */
     uint32_t    uint32FlashTopoTotalSizeByte;   /**<  Flash Topo: Total Flash Size in Byte              */
     uint8_t     uint8FlashTopoRdIdDummyByte;    /**<  Flash Topo: Number of Dummy bytes after RD ID IST */
+    uint8_t     uint8FlashTopoRdFastDummyCyc;   /**<  Flash Topo: Dummy clocks of Fast/Dual/Quad Output Read, multiple of 8 */
+    uint8_t     uint8FlashTopoRdQuadIoDummyCyc; /**<  Flash Topo: Dummy clocks after mode bits of Quad I/O Read, even */
     uint8_t     uint8FlashMngWipMsk;            /**<  Flash MNG: Write-in-progress                      */
     uint8_t     uint8FlashMngWrEnaMsk;          /**<  Flash MNG: Write enable latch, 1: set, 0: clear   */
+    uint32_t    uint32FlashTimePageProgUs;      /**<  Flash Time: tPP, Page Program in us               */
+    uint32_t    uint32FlashTimeSectorEraseUs;   /**<  Flash Time: tSE, Sector Erase in us               */
+    uint32_t    uint32FlashTimeBlockEraseUs;    /**<  Flash Time: tBE, Block Erase in us                 */
+    uint32_t    uint32FlashTimeChipEraseUs;     /**<  Flash Time: tCE, Chip Erase in us                 */
 } t_sfm_type;
 
 
 
+/**
+ *  @typedef t_sfm_desc
+ *
+ *  @brief  Runtime flash descriptor
+ *
+ *  Compiled from selected #SPI_FLASH entry by #sfm_init, enables constant time
+ *  instruction dispatch and packet validation
+ *
+ *  @since  April 2, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint8_t     uint8IstHdl[256];           /**<  Instruction to handler index, 0: unknown instruction */
+    uint8_t     uint8Id[10];                /**<  Manufacturer / Device ID, binary */
+    uint8_t     uint8IdLen;                 /**<  Number of bytes in uint8Id */
+    uint8_t     uint8PageShift;             /**<  log2 of page size */
+    uint8_t     uint8SectorShift;           /**<  log2 of sector size */
+    uint8_t     uint8AdrBytes;              /**<  Address bytes of address mode, changed by Enter/Exit 4-Byte Address Mode */
+    uint32_t    uint32RdIdLen;              /**<  Packet length of 'Read Manufacturer / Device ID' */
+    uint32_t    uint32AdrIstLen;            /**<  Packet length of instruction and address in address mode */
+    uint32_t    uint32RdFastLen;            /**<  Packet length of instruction, address and dummy bytes of Fast/Dual/Quad Output Read */
+    uint32_t    uint32RdQuadIoLen;          /**<  Packet length of instruction, address, mode and dummy bytes of Quad I/O Read */
+    uint32_t    uint32PageMsk;              /**<  In page address mask */
+    uint32_t    uint32SectorMsk;            /**<  In sector address mask */
+    uint32_t    uint32TotalMsk;             /**<  Flash address mask, address roll over */
+    uint32_t    uint32SectorNum;            /**<  Number of sectors in flash */
+    uint32_t    uint32BlockMsk;             /**<  In block address mask */
+} t_sfm_desc;
+
+
+
+/** Frame buffer of #t_sfm_cs, holds instruction, address and complete short instructions **/
+#define SFM_CS_PKT_MAX      (16)
+
+
+
+/**
+ *  @typedef t_sfm_cs
+ *
+ *  @brief  chip select frame
+ *
+ *  decoder state of a transfer between #sfm_cs_low and #sfm_cs_high
+ *
+ *  @since  April 19, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    int         intActive;                  /**<  chip select asserted */
+    int         intRet;                     /**<  frame state, first error is latched */
+    uint8_t     uint8Hdl;                   /**<  instruction handler index of frame */
+    uint8_t     uint8Pkt[SFM_CS_PKT_MAX];   /**<  first frame bytes */
+    uint32_t    uint32Len;                  /**<  number of clocked bytes, saturates */
+    uint32_t    uint32Adr;                  /**<  data phase, Read Data: flash address, Page Program: in page address */
+    uint32_t    uint32Base;                 /**<  data phase, Page Program: page base address */
+} t_sfm_cs;
+
+
+
+/**
+ *  @typedef t_sfm_bus
+ *
+ *  @brief  bus time accounting
+ *
+ *  SCK cycles of all transactions, data bytes are payload of Read Data variants and Page Program
+ *
+ *  @since  April 21, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint32_t    uint32SckHz;    /**<  SPI clock in Hz */
+    uint64_t    uint64Cycles;   /**<  accumulated SCK cycles */
+    uint64_t    uint64DataByte; /**<  accumulated data bytes */
+    uint64_t    uint64LaneByte[3];  /**<  accumulated data bytes by data phase lanes, index: 0: single, 1: dual, 2: quad */
+    uint64_t    uint64NsPerCycle;   /**<  SCK period, 32.32 fixed point ns */
+    uint64_t    uint64NsFrac;       /**<  virtual clock, fraction of ns not yet advanced */
+    uint64_t    uint64CycFast;      /**<  virtual clock, most cycles of one transaction advanced in fixed point without overflow */
+} t_sfm_bus;
+
+
+
+#if SFM_STATS
+/**
+ *  @typedef t_sfm_stats_cnt
+ *
+ *  @brief  request counter
+ *
+ *  @since  April 22, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint64_t    uint64Calls;    /**<  number of requests */
+    uint64_t    uint64Bytes;    /**<  transferred bytes, spi packet or file size */
+    uint64_t    uint64Errors;   /**<  rejected requests */
+    uint32_t    uint32LenMin;   /**<  shortest request */
+    uint32_t    uint32LenMax;   /**<  longest request */
+} t_sfm_stats_cnt;
+
+
+
+/**
+ *  @typedef t_sfm_stats
+ *
+ *  @brief  instrumentation counters
+ *
+ *  counts spi packets per instruction and file operations, compiled out with SFM_STATS=0
+ *
+ *  @since  April 22, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    t_sfm_stats_cnt     ist[256];                   /**<  per instruction opcode */
+    t_sfm_stats_cnt     file[SFM_STATS_FILE_NUM];   /**<  per file operation, #SFM_STATS_FILE */
+    uint64_t            uint64Err[SFM_STATS_ERR_NUM];   /**<  rejected requests per error bit, #SFM_E */
+} t_sfm_stats;
+#endif
+
+
+
+/**
+ *  @typedef t_sfm_wear
+ *
+ *  @brief  endurance tracking
+ *
+ *  one counter per sector and page, page counters are allocated per sector on first Page Program,
+ *  Chip Erase is counted once for all sectors
+ *
+ *  @since  April 23, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint32_t*   uint32PtrErase;     /**<  Erase cycles per sector, without Chip Erase */
+    uint32_t**  uint32PtrProg;      /**<  Program cycles per page, sector directory, NULL entry: no page of sector programmed */
+    uint32_t    uint32ProgAlloc;    /**<  Number of sectors with allocated program counters */
+    uint32_t    uint32EraseChip;    /**<  Chip Erase cycles, applies to all sectors */
+    uint32_t    uint32EraseMax;     /**<  Highest entry of uint32PtrErase */
+    uint32_t    uint32Limit;        /**<  Erase cycles per sector until #SFM_E_WEAR, 0: unlimited */
+} t_sfm_wear;
+
+
+
+#if SFM_TRACE
+/**
+ *  @typedef t_sfm_trace_hdr
+ *
+ *  @brief  trace file header
+ *
+ *  followed by #t_sfm_trace_rec, each record by its uint32Data bytes padded to 8 bytes
+ *
+ *  @since  April 24, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    char        charMagic[8];       /**<  "SFMTRACE" */
+    uint32_t    uint32Version;      /**<  file format version, 1 */
+    uint32_t    uint32RecByte;      /**<  size of #t_sfm_trace_rec */
+    uint32_t    uint32Mode;         /**<  recorded content, #SFM_TRACE_MODE */
+    uint32_t    uint32TimeMode;     /**<  busy time emulation at trace start, #SFM_TIME */
+    uint32_t    uint32SckHz;        /**<  SPI clock at trace start, @see #sfm_bus_cfg */
+    uint32_t    uint32Rsvd;         /**<  reserved, 0 */
+    char        charFlash[32];      /**<  traced flash type, #t_sfm_type::charFlashName */
+} t_sfm_trace_hdr;
+
+
+
+/**
+ *  @typedef t_sfm_trace_rec
+ *
+ *  @brief  traced transaction
+ *
+ *  data phase starts after instruction, address and dummy bytes, f.e. read data or page data
+ *
+ *  @since  April 24, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint64_t    uint64TimeNs;       /**<  virtual clock at transaction start, before bus time */
+    uint32_t    uint32Seq;          /**<  transaction number, gap: records dropped on full ring buffer */
+    uint32_t    uint32Adr;          /**<  flash address, 0 for instructions without address */
+    uint32_t    uint32Len;          /**<  spi packet length */
+    uint32_t    uint32Hash;         /**<  hash of data phase, #SFM_TRACE_HASH */
+    uint32_t    uint32Data;         /**<  data phase bytes following the record, #SFM_TRACE_DATA */
+    uint16_t    uint16Ret;          /**<  transaction state, #SFM_E */
+    uint8_t     uint8Ist;           /**<  instruction */
+    uint8_t     uint8Flags;         /**<  #SFM_TRACE_REC_DATA */
+} t_sfm_trace_rec;
+
+
+
+/**
+ *  @typedef t_sfm_trace
+ *
+ *  @brief  trace recorder
+ *
+ *  ring buffer and flush thread, internal to spi_flash_model.c
+ */
+typedef struct t_sfm_trace t_sfm_trace;
+#endif
+
+
+
 /**
  *  @typedef t_sfm
  *
@@ -106,21 +408,112 @@ typedef struct t_sfm_type {
  */
 typedef struct {
     int                 intMsgLevel;                /**<  Message Level, 0: no messages */
-    uint8_t*            uint8PtrMem;                /**<  Flash memory, allocated memory corresponds to flash size */
+    uint8_t*            uint8PtrMem;                /**<  Flash memory, allocated memory corresponds to flash size, NULL in sparse mode */
+    uint8_t**           uint8PtrSector;             /**<  Sparse mode: sector directory, NULL entry is an unwritten sector and reads as 0xff */
+    uint32_t*           uint32PtrSecUsed;           /**<  Flat mode: sector state bitmap, bit set: sector contains programmed bytes, clear: sector is blank and skipped by whole flash operations */
+    uint32_t            uint32SectorAlloc;          /**<  Number of written sectors, sparse mode: allocated sectors */
+    uint32_t*           uint32PtrSecGen;            /**<  Erase generation of sector, sector content differing from uint32EraseGen is erased by pending Chip Erase */
+    uint32_t            uint32EraseGen;             /**<  Erase generation, incremented by Chip Erase */
+    int                 intMmap;                    /**<  uint8PtrMem is mapped, -1: no mapping, otherwise #SFM_MMAP */
     const t_sfm_type*   flashType;                  /**<  Flash type */
     uint8_t             uint8StatusReg1;            /**<  Status Register */
     uint8_t             uint8WipRdAfterWriteCnt;    /**<  Number of WIP Flag Reads until new write i spossible, emulates timing behaviour of flash */
+    int                 intTimeMode;                /**<  Busy time emulation, #SFM_TIME */
+    uint64_t            uint64TimeNs;               /**<  Virtual clock in ns */
+    uint64_t            uint64WipDoneNs;            /**<  Virtual clock: end of write in progress */
+    t_sfm_bus           bus;                        /**<  bus time accounting, advances virtual clock */
+    t_sfm_desc          desc;                       /**<  Runtime descriptor of flashType */
+    t_sfm_cs            cs;                         /**<  chip select frame of incremental transfer */
+    t_sfm_wear          wear;                       /**<  erase and program cycles */
+#if SFM_TRACE
+    t_sfm_trace*        trace;                      /**<  transaction trace recorder, NULL: off */
+#endif
+#if SFM_STATS
+    t_sfm_stats         stats;                      /**<  instrumentation counters */
+#endif
 } t_sfm;
 
 
 
+/**
+ *  @typedef t_sfm_range
+ *
+ *  @brief  address range
+ *
+ *  inclusive flash address range, f.e. mismatch report of #sfm_cmp_ranges
+ *
+ *  @since  April 10, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint32_t    uint32Start;    /**<  First address of range */
+    uint32_t    uint32Stop;     /**<  Last address of range, inclusive */
+} t_sfm_range;
+
+
+
+/**
+ *  @typedef t_sfm_wear_sec
+ *
+ *  @brief  sector wear
+ *
+ *  entry of #sfm_wear_hot
+ *
+ *  @since  April 23, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint32_t    uint32Sector;   /**<  sector number */
+    uint32_t    uint32Erase;    /**<  erase cycles, including Chip Erase */
+    uint32_t    uint32ProgMax;  /**<  program cycles of most programmed page in sector */
+} t_sfm_wear_sec;
+
+
+
+/**
+ *  @typedef t_sfm_pkt
+ *
+ *  @brief  spi packet
+ *
+ *  element of packet sequence for #sfm_batch
+ *
+ *  @since  April 16, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint8_t*    uint8PtrSpi;    /**<  spi packet, request and response in same packet */
+    uint32_t    uint32Len;      /**<  spi packet length */
+    int         intRet;         /**<  packet state, set by #sfm_batch; @see #sfm */
+} t_sfm_pkt;
+
+
+
+/**
+ *  @typedef t_sfm_iov
+ *
+ *  @brief  spi packet segment
+ *
+ *  one segment of a scattered spi packet for #sfm_iov,
+ *  f.e. instruction, address, dummy, data
+ *
+ *  @since  April 17, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint8_t*    uint8PtrBuf;    /**<  segment buffer, request and response in same buffer */
+    uint32_t    uint32Len;      /**<  segment length */
+} t_sfm_iov;
+
+
+
 /**
  *  @brief init
  *
- *  initialises spi flash model
+ *  initialises spi flash model, flashes above #SFM_FLAT_MAX_BYTE get sparse sectors,
+ *  on failure the handle is released and has no flash selected
  *
  *  @param[in,out]  self                handle
- *  @param[in]      flashType           name of emulated flash, see #SPI_FLASH
+ *  @param[in]      flashType           name of emulated flash, see #SPI_FLASH and #sfm_catalog_load
  *  @return         int                 state
  *  @retval         #SFM_OK             @see #SFM_E
  *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
@@ -128,108 +521,731 @@ typedef struct {
  *  @since          2022-12-19
  *  @author         Andreas Kaeberlein
  */
-int sfm_init (t_sfm *self, char flashType[]);
+int sfm_init (t_sfm *self, const char flashType[]);
 
 
 
 /**
- *  @brief dump
+ *  @brief init sparse
  *
- *  dump flash content to console
+ *  initialises spi flash model with sparse memory, sector storage is allocated on first write
  *
  *  @param[in,out]  self                handle
- *  @param[in]      start               start address of dump, aligned to 16byte, -1: default start
- *  @param[in]      stop                stop address of dump, aligned to 16byte, -1: default stop, end of flash
+ *  @param[in]      flashType           name of emulated flash, see #SPI_FLASH and #sfm_catalog_load
  *  @return         int                 state
  *  @retval         #SFM_OK             @see #SFM_E
  *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
  *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
- *  @retval         #SFM_E_ACCESS       provided addresses out of memory range; @see #SFM_E
- *  @since          2022-12-19
+ *  @since          2023-04-08
  *  @author         Andreas Kaeberlein
  */
-int sfm_dump (t_sfm *self, int32_t start, int32_t stop);
+int sfm_init_sparse (t_sfm *self, const char flashType[]);
 
 
 
 /**
- *  @brief store
+ *  @brief init mmap
  *
- *  stores spi flash memory into file
+ *  initialises spi flash model with memory mapped raw flash image file. The flash content
+ *  persists across processes without load and store. A not existing file is created as
+ *  empty flash, a shorter file is padded with 0xff. On failure the handle is released and
+ *  has no flash selected.
  *
  *  @param[in,out]  self                handle
- *  @param[in]      fileName            file name for save
+ *  @param[in]      flashType           name of emulated flash, see #SPI_FLASH and #sfm_catalog_load
+ *  @param[in]      fileName            raw flash image file
+ *  @param[in]      mode                #SFM_MMAP_SHARED, #SFM_MMAP_PRIVATE
  *  @return         int                 state
  *  @retval         #SFM_OK             @see #SFM_E
  *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       memory mapping failed; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       failed to open file, file larger than flash; @see #SFM_E
+ *  @since          2023-04-15
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_init_mmap (t_sfm *self, const char flashType[], char fileName[], int mode);
+
+
+
+/**
+ *  @brief load part catalog
+ *
+ *  adds parts of a text file to the catalog of #sfm_init. One part per line, whitespace
+ *  separated fields in order of #t_sfm_type, numbers decimal or 0x prefixed hex, '#'
+ *  starts a comment. Parts replace earlier parts with same name or ID, the catalog
+ *  stays unchanged on a malformed file. Loaded parts stay allocated until process end.
+ *
+ *  @param[in]      fileName            catalog file
+ *  @return         int                 state
+ *  @retval         #SFM_OK             @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       failed to open file, malformed part; @see #SFM_E
  *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
- *  @retval         #SFM_E_ACCESS       no file name provided, failed to open file; @see #SFM_E
- *  @since          2022-12-25
+ *  @since          2023-04-26
  *  @author         Andreas Kaeberlein
  */
-int sfm_store (t_sfm *self, char fileName[]);
+int sfm_catalog_load (char fileName[]);
 
 
 
 /**
- *  @brief load
+ *  @brief part by ID
+ *
+ *  looks up part by response of 'Read Manufacturer / Device ID', f.e. to select the
+ *  emulated flash from a captured ID
  *
- *  loads file into flash
+ *  @param[in]      id                  binary ID
+ *  @param[in]      len                 number of ID bytes
+ *  @return         const char*         part name for #sfm_init, NULL: unknown ID
+ *  @since          2023-04-26
+ *  @author         Andreas Kaeberlein
+ */
+const char* sfm_catalog_id (const uint8_t id[], uint32_t len);
+
+
+
+/**
+ *  @brief flush
+ *
+ *  applies pending erases to memory, uint8PtrMem reflects flash content afterwards;
+ *  synchronizes memory mapped flash image to file
  *
  *  @param[in,out]  self                handle
- *  @param[in]      fileName            file name for save
  *  @return         int                 state
  *  @retval         #SFM_OK             @see #SFM_E
  *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
- *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
- *  @retval         #SFM_E_ACCESS       no file name provided, failed to open file; @see #SFM_E
- *  @since          2022-12-27
+ *  @retval         #SFM_E_ACCESS       write back to file failed; @see #SFM_E
+ *  @since          2023-04-15
  *  @author         Andreas Kaeberlein
  */
-int sfm_load (t_sfm *self, char fileName[]);
+int sfm_flush (t_sfm *self);
 
 
 
 /**
- *  @brief compare
+ *  @brief free
  *
- *  compares file with flash memory content
+ *  releases flash emulation memory, handle requires new init for further use.
+ *  Shared memory mapped images are synchronized to file.
  *
  *  @param[in,out]  self                handle
- *  @param[in]      fileName            file name for save
+ *  @return         int                 state
+ *  @retval         #SFM_OK             @see #SFM_E
+ *  @since          2023-04-08
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_free (t_sfm *self);
+
+
+
+/**
+ *  @brief memory usage
+ *
+ *  allocated memory for flash emulation
+ *
+ *  @param[in,out]  self                handle
+ *  @param[out]     used                allocated bytes, data and management
  *  @return         int                 state
  *  @retval         #SFM_OK             @see #SFM_E
  *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
- *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
- *  @retval         #SFM_E_ACCESS       no file name provided, failed to open file; @see #SFM_E
- *  @retval         16                  mismatch file/sfm
- *  @since          2022-12-28
+ *  @since          2023-04-08
  *  @author         Andreas Kaeberlein
  */
-int sfm_cmp (t_sfm *self, char fileName[]);
+int sfm_mem_usage (t_sfm *self, size_t *used);
 
 
 
 /**
- *  @brief access flash
+ *  @brief blank check
  *
- *  interacts with flash model
+ *  checks flash range for erased state, unwritten sectors are skipped without reading
  *
  *  @param[in,out]  self                handle
- *  @param[in]      *spi                spi packet, request and response in same packet
- *  @param[in]      len                 spi packet length
+ *  @param[in]      adr                 start address
+ *  @param[in]      len                 number of bytes
+ *  @param[out]     used                first programmed address, NULL: not requested
+ *  @return         int                 state
+ *  @retval         #SFM_OK             range is blank; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       no memory for flash emulation allocated; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       range exceeds flash; @see #SFM_E
+ *  @retval         #SFM_E_CMP          range contains programmed bytes; @see #SFM_E
+ *  @since          2023-04-11
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_blank_check (t_sfm *self, uint32_t adr, uint32_t len, uint32_t *used);
+
+
+
+/**
+ *  @brief dump
+ *
+ *  dump flash content to console
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      start               start address of dump, aligned to 16byte, UINT32_MAX: default start
+ *  @param[in]      stop                stop address of dump, aligned to 16byte, UINT32_MAX: default stop, end of flash
  *  @return         int                 state
  *  @retval         #SFM_OK             @see #SFM_E
  *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
  *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
- *  @retval         #SFM_E_IST_FLASH    unknown instruction, malformed instruction; @see #SFM_E
- *  @retval         8                   conversion error
- *  @retval         #SFM_E_WP_FLASH     write enable bit not set; @see #SFM_E
- *  @retval         #SFM_E_ACCESS       address out of range; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       provided addresses out of memory range; @see #SFM_E
  *  @since          2022-12-19
  *  @author         Andreas Kaeberlein
  */
-int sfm (t_sfm *self, uint8_t* spi, uint32_t len);
+int sfm_dump (t_sfm *self, uint32_t start, uint32_t stop);
+
+
+
+/**
+ *  @brief store
+ *
+ *  stores spi flash memory into file
+ *    .dif -> difference to empty flash in ascii-hex
+ *    .bin -> raw flash image
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      fileName            file name for save
+ *  @return         int                 state
+ *  @retval         #SFM_OK             @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       no file name provided, failed to open file; @see #SFM_E
+ *  @since          2022-12-25
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_store (t_sfm *self, char fileName[]);
+
+
+
+/**
+ *  @brief load
+ *
+ *  loads file into flash, flash locations not part of the file are empty
+ *    .dif -> difference to empty flash in ascii-hex
+ *    .bin -> raw flash image, shorter image is padded with 0xff
+ *  the file is decoded straight into the erased flash, after a failed load the flash
+ *  is erased or partially loaded, previous content is lost
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      fileName            file name for save
+ *  @return         int                 state
+ *  @retval         #SFM_OK             @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       no file name provided, failed to open file; @see #SFM_E
+ *  @since          2022-12-27
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_load (t_sfm *self, char fileName[]);
+
+
+
+/**
+ *  @brief compare
+ *
+ *  compares file with flash memory content
+ *    .dif -> difference to empty flash in ascii-hex
+ *    .bin -> raw flash image, shorter image is padded with 0xff
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      fileName            file name for save
+ *  @return         int                 state
+ *  @retval         #SFM_OK             @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       no file name provided, failed to open file; @see #SFM_E
+ *  @retval         16                  mismatch file/sfm
+ *  @since          2022-12-28
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_cmp (t_sfm *self, char fileName[]);
+
+
+
+/**
+ *  @brief compare with mismatch report
+ *
+ *  compares file with flash memory content and reports all differing address ranges,
+ *  adjacent mismatches are merged into one range. File formats see #sfm_cmp
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      fileName            file name for compare
+ *  @param[out]     ranges              differing address ranges, ascending; NULL: only count ranges
+ *  @param[in]      max                 capacity of ranges, compare stops when full; 0: only count ranges
+ *  @param[out]     num                 number of differing ranges, equal max if report was capped
+ *  @return         int                 state
+ *  @retval         #SFM_OK             @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       no file name provided, failed to open file; @see #SFM_E
+ *  @retval         #SFM_E_CMP          mismatch file/sfm; @see #SFM_E
+ *  @since          2023-04-10
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_cmp_ranges (t_sfm *self, char fileName[], t_sfm_range ranges[], uint32_t max, uint32_t *num);
+
+
+
+/**
+ *  @brief access flash
+ *
+ *  interacts with flash model
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      *spi                spi packet, request and response in same packet
+ *  @param[in]      len                 spi packet length
+ *  @return         int                 state
+ *  @retval         #SFM_OK             @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
+ *  @retval         #SFM_E_IST_FLASH    unknown instruction, malformed instruction; @see #SFM_E
+ *  @retval         8                   conversion error
+ *  @retval         #SFM_E_WP_FLASH     write enable bit not set; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       address out of range; @see #SFM_E
+ *  @since          2022-12-19
+ *  @author         Andreas Kaeberlein
+ */
+int sfm (t_sfm *self, uint8_t* spi, uint32_t len);
+
+
+
+/**
+ *  @brief access flash, specialized part
+ *
+ *  same as #sfm, opcodes and geometry of the #SFM_PARTS entry are folded at
+ *  compile time. Handles of other flash types are processed by #sfm
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      *spi                spi packet, request and response in same packet
+ *  @param[in]      len                 spi packet length
+ *  @return         int                 state, @see #sfm
+ *  @since          2023-04-25
+ *  @author         Andreas Kaeberlein
+ */
+#define SFM_PART_PROTO(part, idx)   int sfm_##part (t_sfm *self, uint8_t* spi, uint32_t len);
+SFM_PARTS(SFM_PART_PROTO)
+#undef SFM_PART_PROTO
+
+
+
+/**
+ *  @brief access flash with packet sequence
+ *
+ *  processes packets in order like consecutive #sfm calls, each packet gets its own state.
+ *  Write Enable, Page Program/Erase and following Read Status Register polls are executed
+ *  as one fused operation
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in,out]  pkts                spi packets, request and response in same packet
+ *  @param[in]      num                 number of packets
+ *  @return         int                 state, bitwise or of all packet states
+ *  @retval         #SFM_OK             all packets successful; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       memory allocation failed; @see #SFM_E
+ *  @retval         others              packet states; @see #sfm
+ *  @since          2023-04-16
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_batch (t_sfm *self, t_sfm_pkt pkts[], uint32_t num);
+
+
+
+/**
+ *  @brief access flash with scattered spi packet
+ *
+ *  behaves like #sfm on the concatenation of all segments. Segments are read and
+ *  written in place, Read Data and Page Program move data without intermediate copy
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in,out]  iov                 spi packet segments, request and response in same segments
+ *  @param[in]      num                 number of segments
+ *  @return         int                 state
+ *  @retval         #SFM_OK             access successful; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       bounce buffer allocation failed; @see #SFM_E
+ *  @retval         others              @see #sfm
+ *  @since          2023-04-17
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_iov (t_sfm *self, const t_sfm_iov iov[], uint32_t num);
+
+
+
+/**
+ *  @brief access flash full-duplex
+ *
+ *  behaves like #sfm, but request and response are in separate buffers. The request
+ *  is not modified, Read Data fetches directly into the response buffer
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      tx                  request, MOSI; NULL: line idle high
+ *  @param[out]     rx                  response, MISO; NULL: response discarded; tx: in place like #sfm
+ *  @param[in]      len                 transfer length
+ *  @return         int                 state
+ *  @retval         #SFM_OK             access successful; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       scratch buffer allocation failed; @see #SFM_E
+ *  @retval         others              @see #sfm
+ *  @since          2023-04-18
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_xfer (t_sfm *self, const uint8_t *tx, uint8_t *rx, uint32_t len);
+
+
+
+/**
+ *  @brief assert chip select
+ *
+ *  starts incremental transfer, bytes are clocked with #sfm_cs_xfer
+ *
+ *  @param[in,out]  self                handle
+ *  @return         int                 state
+ *  @retval         #SFM_OK             frame started; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       no memory for flash emulation allocated; @see #SFM_E
+ *  @retval         #SFM_E_CS           chip select already asserted; @see #SFM_E
+ *  @since          2023-04-19
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_cs_low (t_sfm *self);
+
+
+
+/**
+ *  @brief clock bytes while chip select asserted
+ *
+ *  decodes a chunk of the frame, chunk size is arbitrary. The response is driven
+ *  while clocking, Read Data streams from flash and Page Program writes through,
+ *  so no frame sized buffer is needed
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      tx                  request, MOSI; NULL: line idle high
+ *  @param[out]     rx                  response, MISO; NULL: response discarded
+ *  @param[in]      len                 number of bytes
+ *  @return         int                 state
+ *  @retval         #SFM_OK             bytes clocked; @see #SFM_E
+ *  @retval         #SFM_E_CS           chip select not asserted; @see #SFM_E
+ *  @since          2023-04-19
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_cs_xfer (t_sfm *self, const uint8_t *tx, uint8_t *rx, uint32_t len);
+
+
+
+/**
+ *  @brief release chip select
+ *
+ *  finishes frame, the instruction is executed like #sfm on all clocked bytes. Response
+ *  bytes of rejected frames are already delivered and not reverted
+ *
+ *  @param[in,out]  self                handle
+ *  @return         int                 state
+ *  @retval         #SFM_OK             frame accepted; @see #SFM_E
+ *  @retval         #SFM_E_CS           chip select not asserted; @see #SFM_E
+ *  @retval         others              instruction state; @see #sfm
+ *  @since          2023-04-19
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_cs_high (t_sfm *self);
+
+
+
+/**
+ *  @brief busy time emulation
+ *
+ *  selects how long write in progress lasts after Page Program and Erase, pending write in progress is finished
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      mode                #SFM_TIME_POLL: status register reads; #SFM_TIME_VIRTUAL: flash timing on virtual clock
+ *  @return         int                 state
+ *  @retval         #SFM_OK             mode set; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no memory selected or unknown, add to #SPI_FLASH table; @see #SFM_E
+ *  @since          2023-04-20
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_time_mode (t_sfm *self, int mode);
+
+
+
+/**
+ *  @brief advance virtual clock
+ *
+ *  write in progress ends when the virtual clock passes the deadline of the flash timing
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      ns                  elapsed time in ns
+ *  @since          2023-04-20
+ *  @author         Andreas Kaeberlein
+ */
+void sfm_time_advance (t_sfm *self, uint64_t ns);
+
+
+
+/**
+ *  @brief jump to next event
+ *
+ *  advances virtual clock to the end of the pending write in progress
+ *
+ *  @param[in,out]  self                handle
+ *  @return         uint64_t            skipped time in ns, 0: no pending event
+ *  @since          2023-04-20
+ *  @author         Andreas Kaeberlein
+ */
+uint64_t sfm_time_next (t_sfm *self);
+
+
+
+/**
+ *  @brief SPI clock
+ *
+ *  sets SPI clock of bus time accounting and clears accounting. Every transaction is charged
+ *  with the SCK cycles of instruction, address, dummy and data phase, depending on the lanes
+ *  of the instruction
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      sckHz               SPI clock in Hz
+ *  @return         int                 state
+ *  @retval         #SFM_OK             clock set; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       invalid clock; @see #SFM_E
+ *  @since          2023-04-21
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_bus_cfg (t_sfm *self, uint32_t sckHz);
+
+
+
+/**
+ *  @brief clear bus time accounting
+ *
+ *  @param[in,out]  self                handle
+ *  @since          2023-04-21
+ *  @author         Andreas Kaeberlein
+ */
+void sfm_bus_reset (t_sfm *self);
+
+
+
+/**
+ *  @brief accumulated bus time
+ *
+ *  @param[in]      self                handle
+ *  @return         uint64_t            bus time in ns
+ *  @since          2023-04-21
+ *  @author         Andreas Kaeberlein
+ */
+uint64_t sfm_bus_ns (const t_sfm *self);
+
+
+
+/**
+ *  @brief effective data rate
+ *
+ *  Read Data variants and Page Program payload per accumulated bus time
+ *
+ *  @param[in]      self                handle
+ *  @return         double              data rate in MB/s
+ *  @since          2023-04-21
+ *  @author         Andreas Kaeberlein
+ */
+double sfm_bus_mbps (const t_sfm *self);
+
+
+
+#if SFM_STATS
+/**
+ *  @brief instrumentation snapshot
+ *
+ *  copies counters, f.e. for later dump while the model continues
+ *
+ *  @param[in]      self                handle
+ *  @param[out]     snap                counter copy
+ *  @since          2023-04-22
+ *  @author         Andreas Kaeberlein
+ */
+void sfm_stats_snapshot (const t_sfm *self, t_sfm_stats *snap);
+
+
+
+/**
+ *  @brief clear instrumentation counters
+ *
+ *  @param[in,out]  self                handle
+ *  @since          2023-04-22
+ *  @author         Andreas Kaeberlein
+ */
+void sfm_stats_reset (t_sfm *self);
+
+
+
+/**
+ *  @brief dump instrumentation counters
+ *
+ *  one line per used instruction and file operation with calls, bytes, errors and
+ *  min/avg/max length, followed by rejected requests per error code
+ *
+ *  @param[in]      stats               counters, f.e. from #sfm_stats_snapshot
+ *  @param[in]      fileName            .csv: comma separated, otherwise text; NULL: text on stdout
+ *  @return         int                 state
+ *  @retval         #SFM_OK             dump written; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       file open failed; @see #SFM_E
+ *  @since          2023-04-22
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_stats_dump (const t_sfm_stats *stats, char fileName[]);
+#endif
+
+
+
+/**
+ *  @brief endurance limit
+ *
+ *  Sector and Chip Erase fail with #SFM_E_WEAR on sectors with limit erase cycles
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      cycles              erase cycles per sector, 0: unlimited
+ *  @return         int                 state
+ *  @retval         #SFM_OK             limit set; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no flash selected; @see #SFM_E
+ *  @since          2023-04-23
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_wear_limit (t_sfm *self, uint32_t cycles);
+
+
+
+/**
+ *  @brief clear erase and program cycles
+ *
+ *  @param[in,out]  self                handle
+ *  @since          2023-04-23
+ *  @author         Andreas Kaeberlein
+ */
+void sfm_wear_reset (t_sfm *self);
+
+
+
+/**
+ *  @brief hottest sectors
+ *
+ *  sectors with most erase cycles, descending; equal cycles in ascending sector order
+ *
+ *  @param[in]      self                handle
+ *  @param[out]     hot                 sector wear
+ *  @param[in]      max                 number of elements in hot
+ *  @param[out]     num                 number of used elements in hot
+ *  @return         int                 state
+ *  @retval         #SFM_OK             hot filled; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no flash selected; @see #SFM_E
+ *  @since          2023-04-23
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_wear_hot (const t_sfm *self, t_sfm_wear_sec hot[], uint32_t max, uint32_t *num);
+
+
+
+/**
+ *  @brief erase cycle histogram
+ *
+ *  number of sectors per erase cycle bin, bin i covers i*width to (i+1)*width-1 cycles,
+ *  width is the smallest one covering the most erased sector
+ *
+ *  @param[in]      self                handle
+ *  @param[out]     hist                sectors per bin
+ *  @param[in]      bins                number of elements in hist
+ *  @param[out]     width               erase cycles per bin
+ *  @return         int                 state
+ *  @retval         #SFM_OK             histogram filled; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no flash selected; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       no bins; @see #SFM_E
+ *  @since          2023-04-23
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_wear_hist (const t_sfm *self, uint32_t hist[], uint32_t bins, uint32_t *width);
+
+
+
+/**
+ *  @brief export wear histogram
+ *
+ *  erase cycle histogram, see #sfm_wear_hist, followed by the hottest sectors
+ *
+ *  @param[in]      self                handle
+ *  @param[in]      fileName            .csv: comma separated, otherwise text; NULL: text on stdout
+ *  @param[in]      bins                histogram bins
+ *  @return         int                 state
+ *  @retval         #SFM_OK             histogram written; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no flash selected; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       no bins or file open failed; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       no memory for histogram; @see #SFM_E
+ *  @since          2023-04-23
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_wear_dump (const t_sfm *self, char fileName[], uint32_t bins);
+
+
+
+#if SFM_TRACE
+/**
+ *  @brief start transaction trace
+ *
+ *  every transaction is appended to a preallocated ring buffer, a thread flushes the buffer
+ *  to the trace file. Transactions on a full ring buffer are dropped and counted.
+ *
+ *  @param[in,out]  self                handle
+ *  @param[in]      fileName            trace file, @see #t_sfm_trace_hdr
+ *  @param[in]      ringByte            ring buffer size, rounded up to power of two; 0: #SFM_TRACE_RING_BYTE
+ *  @param[in]      mode                recorded content, #SFM_TRACE_MODE
+ *  @return         int                 state
+ *  @retval         #SFM_OK             trace started; @see #SFM_E
+ *  @retval         #SFM_E_NO_FLASH     no flash selected; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       trace file not writable; @see #SFM_E
+ *  @retval         #SFM_E_MALLOC       ring buffer or thread creation failed; @see #SFM_E
+ *  @since          2023-04-24
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_trace_open (t_sfm *self, char fileName[], uint32_t ringByte, int mode);
+
+
+
+/**
+ *  @brief stop transaction trace
+ *
+ *  flushes ring buffer and closes trace file
+ *
+ *  @param[in,out]  self                handle
+ *  @return         int                 state
+ *  @retval         #SFM_OK             trace complete; @see #SFM_E
+ *  @retval         #SFM_E_ACCESS       trace file write failed; @see #SFM_E
+ *  @since          2023-04-24
+ *  @author         Andreas Kaeberlein
+ */
+int sfm_trace_close (t_sfm *self);
+
+
+
+/**
+ *  @brief dropped transactions
+ *
+ *  @param[in]      self                handle
+ *  @return         uint64_t            transactions not recorded due full ring buffer
+ *  @since          2023-04-24
+ *  @author         Andreas Kaeberlein
+ */
+uint64_t sfm_trace_drops (const t_sfm *self);
+
+
+
+/**
+ *  @brief data phase hash
+ *
+ *  hash of #t_sfm_trace_rec::uint32Hash, words in host byte order
+ *
+ *  @param[in]      data                data phase
+ *  @param[in]      len                 number of bytes
+ *  @return         uint32_t            hash
+ *  @since          2023-04-24
+ *  @author         Andreas Kaeberlein
+ */
+uint32_t sfm_trace_hash (const uint8_t *data, uint32_t len);
+#endif
 
 
 
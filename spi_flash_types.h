@@ -49,16 +49,34 @@ const struct t_sfm_type SPI_FLASH[] = {
     0x05,           // uint8FlashIstRdStateReg              W25Q16JV_Rev_H      p.23, Read Status Register-1 (05h)
     0x03,           // uint8FlashIstRdData                  W25Q16JV_Rev_H      p.26, Read Data (03h)
     0x02,           // uint8FlashIstWrPage                  W25Q16JV_Rev_H      p.33, Page Program (02h)
+    0x0b,           // uint8FlashIstRdFast                  W25Q16JV_Rev_H      Fast Read (0Bh)
+    0x3b,           // uint8FlashIstRdDualOut               W25Q16JV_Rev_H      Fast Read Dual Output (3Bh)
+    0x6b,           // uint8FlashIstRdQuadOut               W25Q16JV_Rev_H      Fast Read Quad Output (6Bh)
+    0xeb,           // uint8FlashIstRdQuadIo                W25Q16JV_Rev_H      Fast Read Quad I/O (EBh)
+    0xd8,           // uint8FlashIstEraseBlock              W25Q16JV_Rev_H      64KB Block Erase (D8h)
+    0,              // uint8FlashIstAdr4BEnter              3-byte address only
+    0,              // uint8FlashIstAdr4BExit
+    0,              // uint8FlashIstRdData4B
+    0,              // uint8FlashIstWrPage4B
+    0,              // uint8FlashIstEraseSector4B
+    0,              // uint8FlashIstEraseBlock4B
     3,              // uint8FlashTopoAdrBytes
     4096,           // uint32FlashTopoSectorSizeByte
+    65536,          // uint32FlashTopoBlockSizeByte         W25Q16JV_Rev_H      64KB Block Erase (D8h)
     256,            // uint32FlashTopoPageSizeByte
     2097152,        // uint32FlashTopoTotalSizeByte
     3,              // uint8FlashTopoRdIdDummyByte          W25Q16JV_Rev_H      p.44, Read Manufacturer / Device ID (90h)
+    8,              // uint8FlashTopoRdFastDummyCyc         W25Q16JV_Rev_H      Fast Read (0Bh), 8 dummy clocks
+    4,              // uint8FlashTopoRdQuadIoDummyCyc       W25Q16JV_Rev_H      Fast Read Quad I/O (EBh), 2 mode and 4 dummy clocks
     0x01,           // uint8FlashMngWipMsk
     0x02,           // uint8FlashMngWrEnaMsk
+    400,            // uint32FlashTimePageProgUs            W25Q16JV_Rev_H      p.67, AC Electrical Characteristics, tPP typ
+    45000,          // uint32FlashTimeSectorEraseUs         W25Q16JV_Rev_H      p.67, AC Electrical Characteristics, tSE typ
+    150000,         // uint32FlashTimeBlockEraseUs          W25Q16JV_Rev_H      p.67, AC Electrical Characteristics, tBE2 typ
+    5000000,        // uint32FlashTimeChipEraseUs           W25Q16JV_Rev_H      p.67, AC Electrical Characteristics, tCE typ
   },
 
-  /* add new entry here ... */
+  /* add new entry here ..., or load the part at runtime with sfm_catalog_load */
 
   /* Protection entry */
   {
@@ -72,13 +90,31 @@ const struct t_sfm_type SPI_FLASH[] = {
     0,      // uint8FlashIstRdStateReg
     0,      // uint8FlashIstRdData
     0,      // uint8FlashIstWrPage
+    0,      // uint8FlashIstRdFast
+    0,      // uint8FlashIstRdDualOut
+    0,      // uint8FlashIstRdQuadOut
+    0,      // uint8FlashIstRdQuadIo
+    0,      // uint8FlashIstEraseBlock
+    0,      // uint8FlashIstAdr4BEnter
+    0,      // uint8FlashIstAdr4BExit
+    0,      // uint8FlashIstRdData4B
+    0,      // uint8FlashIstWrPage4B
+    0,      // uint8FlashIstEraseSector4B
+    0,      // uint8FlashIstEraseBlock4B
     0,      // uint8FlashTopoAdrBytes
     0,      // uint32FlashTopoSectorSizeByte
+    0,      // uint32FlashTopoBlockSizeByte
     0,      // uint32FlashTopoPageSizeByte
     0,      // uint32FlashTopoTotalSizeByte
     0,      // uint8FlashTopoRdIdDummyByte
+    0,      // uint8FlashTopoRdFastDummyCyc
+    0,      // uint8FlashTopoRdQuadIoDummyCyc
     0,      // uint8FlashMngWipMsk
     0,      // uint8FlashMngWrEnaMsk
+    0,      // uint32FlashTimePageProgUs
+    0,      // uint32FlashTimeSectorEraseUs
+    0,      // uint32FlashTimeBlockEraseUs
+    0,      // uint32FlashTimeChipEraseUs
   }
 };
 
@@ -0,0 +1,1029 @@
+/*************************************************************************
+ @author:     Andreas Kaeberlein
+ @copyright:  Copyright 2022
+ @credits:    AKAE
+
+ @license:    BSDv3
+ @maintainer: Andreas Kaeberlein
+ @email:      andreas.kaeberlein@web.de
+
+ @file:       spi_flash_model_bench.c
+ @date:       2023-04-02
+ @see:        https://github.com/akaeba/spi_flash_model
+
+ @brief:      benchmark
+              measures throughput of spi flash model hot paths,
+              optional results file in CSV or JSON format
+*************************************************************************/
+
+
+
+/** Includes **/
+/* Standard libs */
+#include <stdlib.h>     // EXIT codes, malloc
+#include <stdio.h>      // f.e. printf
+#include <stdint.h>     // defines fixed data types: int8_t...
+#include <stddef.h>     // various variable types and macros: size_t, offsetof, NULL, ...
+#include <string.h>     // string operation: memset, memcpy
+#include <time.h>       // clock_gettime
+/* Self */
+#include "spi_flash_model.h"    // function prototypes
+
+
+
+/**
+ *  @defgroup BENCH_HELP constants
+ *  @{
+ */
+#ifndef BENCH_ITERATIONS
+    #define BENCH_ITERATIONS    (2000000)   /**<  Number of SPI packets per measurement */
+#endif
+#ifndef BENCH_INSTANCES
+    #define BENCH_INSTANCES     (256)       /**<  Number of model instances for memory footprint */
+#endif
+#ifndef BENCH_RESULTS
+    #define BENCH_RESULTS       (128)       /**<  Maximum number of recorded measurements */
+#endif
+/** @} */
+
+
+
+/**
+ *  @brief measurement
+ *
+ *  single result row of results file
+ */
+typedef struct t_bench_res
+{
+    char    charGroup[40];  /**<  Group of measurement */
+    char    charName[40];   /**<  Name of measurement */
+    char    charUnit[12];   /**<  Unit of value */
+    double  dblVal;         /**<  Measured value */
+} t_bench_res;
+
+
+
+/**
+ *  @brief results
+ *
+ *  recorded measurements of benchmark run
+ */
+static struct
+{
+    t_bench_res res[BENCH_RESULTS]; /**<  Measurements */
+    uint32_t    uint32Num;          /**<  Number of measurements */
+    char        charGroup[40];      /**<  Current group */
+} benchLog;
+
+
+
+/** @brief bench_now_ns
+ *
+ *  monotonic time stamp
+ *
+ *  @return         double          time in nanoseconds
+ *
+ */
+static double bench_now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+
+
+/** @brief bench_group
+ *
+ *  starts new group of measurements
+ *
+ *  @param[in]      *group          group name
+ *
+ */
+static void bench_group (const char *group)
+{
+    snprintf(benchLog.charGroup, sizeof(benchLog.charGroup), "%s", group);
+    printf("INFO:main: %s\n", group);
+}
+
+
+
+/** @brief bench_report
+ *
+ *  prints measurement and records it for the results file
+ *
+ *  @param[in]      *name           name of measurement
+ *  @param[in]      val             measured value
+ *  @param[in]      *unit           unit of value
+ *
+ */
+static void bench_report (const char *name, double val, const char *unit)
+{
+    /** Variables **/
+    t_bench_res*    res;    // recorded measurement
+
+    printf("  %-24s %10.3f %s\n", name, val, unit);
+    if ( benchLog.uint32Num >= BENCH_RESULTS ) {
+        return;
+    }
+    res = &benchLog.res[benchLog.uint32Num++];
+    snprintf(res->charGroup, sizeof(res->charGroup), "%s", benchLog.charGroup);
+    snprintf(res->charName, sizeof(res->charName), "%s", name);
+    snprintf(res->charUnit, sizeof(res->charUnit), "%s", unit);
+    res->dblVal = val;
+}
+
+
+
+/** @brief bench_write
+ *
+ *  writes recorded measurements, extension '.json' selects JSON otherwise CSV
+ *
+ *  @param[in]      fileName[]      results file
+ *  @param[in]      *flash          name of benchmarked flash
+ *  @return         int             0: OKAY, 1: FAIL
+ *
+ */
+static int bench_write (char fileName[], const char *flash)
+{
+    /** Variables **/
+    FILE*           fp;     // results file
+    const char*     ext;    // file extension
+    t_bench_res*    res;    // recorded measurement
+
+    fp = fopen(fileName, "w");
+    if ( NULL == fp ) {
+        return 1;
+    }
+    ext = strrchr(fileName, '.');
+    if ( (NULL != ext) && (0 == strcmp(ext, ".json")) ) {
+        fprintf(fp, "{\n  \"flash\": \"%s\",\n  \"iterations\": %u,\n  \"results\": [\n", flash, (uint32_t) BENCH_ITERATIONS);
+        for ( uint32_t i = 0; i < benchLog.uint32Num; i++ ) {
+            res = &benchLog.res[i];
+            fprintf(fp, "    {\"group\": \"%s\", \"name\": \"%s\", \"value\": %.6g, \"unit\": \"%s\"}%s\n", res->charGroup, res->charName, res->dblVal, res->charUnit, (i + 1 < benchLog.uint32Num) ? "," : "");
+        }
+        fprintf(fp, "  ]\n}\n");
+    } else {
+        fprintf(fp, "flash,group,name,value,unit\n");
+        for ( uint32_t i = 0; i < benchLog.uint32Num; i++ ) {
+            res = &benchLog.res[i];
+            fprintf(fp, "%s,\"%s\",\"%s\",%.6g,%s\n", flash, res->charGroup, res->charName, res->dblVal, res->charUnit);
+        }
+    }
+    if ( 0 != fclose(fp) ) {
+        return 1;
+    }
+    return 0;
+}
+
+
+
+/** @brief bench_packet
+ *
+ *  measures single SPI packet, packet is rebuild before every access
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      entry           model entry point, #sfm or specialized part
+ *  @param[in]      *name           printed name of measurement
+ *  @param[in]      *pkt            SPI packet
+ *  @param[in]      len             SPI packet length
+ *  @return         double          nanoseconds per packet
+ *
+ */
+static double bench_packet (t_sfm *spiFlash, int (*entry)(t_sfm*, uint8_t*, uint32_t), const char *name, const uint8_t *pkt, uint32_t len)
+{
+    /** Variables **/
+    uint8_t     spi[64];    // SPI buffer
+    double      t0, t1;     // time stamps
+
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < BENCH_ITERATIONS; i++ ) {
+        memcpy(spi, pkt, len);
+        entry(spiFlash, spi, len);
+    }
+    t1 = bench_now_ns();
+    bench_report(name, (t1 - t0) / BENCH_ITERATIONS, "ns/packet");
+    return (t1 - t0) / BENCH_ITERATIONS;
+}
+
+
+
+#if SFM_TRACE
+/** @brief bench_trace
+ *
+ *  measures single SPI packet with transaction trace
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      *name           printed name of measurement
+ *  @param[in]      mode            recorded content, #SFM_TRACE_MODE
+ *  @param[in]      *pkt            SPI packet
+ *  @param[in]      len             SPI packet length
+ *
+ */
+static void bench_trace (t_sfm *spiFlash, const char *name, int mode, const uint8_t *pkt, uint32_t len)
+{
+    /** Variables **/
+    uint64_t    drops;      // not recorded packets
+    char        drop[40];   // measurement name
+
+    if ( SFM_OK != sfm_trace_open(spiFlash, "./bench.trc", 0, mode) ) {
+        printf("ERROR:%s:sfm_trace_open\n", __FUNCTION__);
+        return;
+    }
+    bench_packet(spiFlash, sfm, name, pkt, len);
+    drops = sfm_trace_drops(spiFlash);
+    sfm_trace_close(spiFlash);
+    remove("./bench.trc");
+    snprintf(drop, sizeof(drop), "%s, dropped", name);
+    bench_report(drop, 100.0 * (double) drops / BENCH_ITERATIONS, "%");
+}
+#endif
+
+
+
+/** @brief bench_batch
+ *
+ *  Page Program sequence WREN, PP, WIP polls processed by sfm_batch
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @return         double          nanoseconds per packet
+ *
+ */
+static double bench_batch (t_sfm *spiFlash)
+{
+    /** Variables **/
+    t_sfm_pkt   pkts[64 * (2 + SFM_WIP_RETRY_IDLE)];    // packet sequence
+    uint8_t     spi[64][2 + 8 + 2 * SFM_WIP_RETRY_IDLE];// packet buffers
+    uint32_t    num;                                    // number of packets
+    uint32_t    pos;                                    // position in packet buffer
+    double      t0, t1;                                 // time stamps
+
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < BENCH_ITERATIONS / 64; i++ ) {
+        num = 0;
+        for ( uint32_t j = 0; j < 64; j++ ) {
+            pos = 0;
+            spi[j][pos] = 0x06;
+            pkts[num].uint8PtrSpi = &spi[j][pos];
+            pkts[num++].uint32Len = 1;
+            pos += 1;
+            spi[j][pos+0] = 0x02;
+            spi[j][pos+1] = 0x00;
+            spi[j][pos+2] = 0x20;
+            spi[j][pos+3] = (uint8_t) (j << 2);
+            memset(&spi[j][pos+4], 0xa5, 4);
+            pkts[num].uint8PtrSpi = &spi[j][pos];
+            pkts[num++].uint32Len = 8;
+            pos += 8;
+            for ( uint8_t k = 0; k < SFM_WIP_RETRY_IDLE; k++ ) {
+                spi[j][pos] = 0x05;
+                pkts[num].uint8PtrSpi = &spi[j][pos];
+                pkts[num++].uint32Len = 2;
+                pos += 2;
+            }
+        }
+        sfm_batch(spiFlash, pkts, num);
+    }
+    t1 = bench_now_ns();
+    bench_report("Page Program, sfm_batch", (t1 - t0) / ((BENCH_ITERATIONS / 64) * 64 * (2.0 + SFM_WIP_RETRY_IDLE)), "ns/packet");
+    return (t1 - t0) / ((BENCH_ITERATIONS / 64) * 64 * (2.0 + SFM_WIP_RETRY_IDLE));
+}
+
+
+
+/** @brief bench_bulk
+ *
+ *  measures Read Data or Page Program burst, Page Program includes Write Enable and WIP polls are excluded
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      *name           printed name of measurement
+ *  @param[in]      ist             instruction, 0x03: Read Data, 0x02: Page Program
+ *  @param[in]      adr             flash start address
+ *  @param[in]      num             number of data bytes
+ *  @return         double          nanoseconds per data byte
+ *
+ */
+static double bench_bulk (t_sfm *spiFlash, const char *name, uint8_t ist, uint32_t adr, uint32_t num)
+{
+    /** Variables **/
+    uint8_t*    spi;        // SPI buffer
+    double      t0, t1;     // time stamps
+    double      ns = 0;     // accumulated packet time
+    uint32_t    rep;        // number of repetitions
+
+    spi = (uint8_t*) malloc(num + 4);
+    if ( NULL == spi ) {
+        return 0;
+    }
+    rep = (BENCH_ITERATIONS / 16 * 64) / num + 1;
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        if ( 0x02 == ist ) {
+            spi[0] = 0x06;
+            sfm(spiFlash, spi, 1);
+        }
+        spi[0] = ist;
+        spi[1] = (uint8_t) (adr >> 16);
+        spi[2] = (uint8_t) (adr >> 8);
+        spi[3] = (uint8_t) adr;
+        memset(spi+4, (int) (i & 0xff), num);
+        t0 = bench_now_ns();
+        sfm(spiFlash, spi, num + 4);
+        t1 = bench_now_ns();
+        ns += t1 - t0;
+        for ( uint8_t j = 0; (0x02 == ist) && (j < SFM_WIP_RETRY_IDLE); j++ ) {
+            spi[0] = 0x05;
+            sfm(spiFlash, spi, 2);
+        }
+    }
+    free(spi);
+    bench_report(name, ns / rep / num, "ns/byte");
+    return ns / rep / num;
+}
+
+
+
+/** @brief bench_lanes
+ *
+ *  measures Read Data and fast read variants, model time and emulated bus data rate per variant
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      num             number of data bytes
+ *  @return         void
+ *
+ */
+static void bench_lanes (t_sfm *spiFlash, uint32_t num)
+{
+    /** Variables **/
+    uint8_t*    spi;        // SPI buffer
+    double      t0, t1;     // time stamps
+    uint32_t    rep;        // number of repetitions
+    uint32_t    hdr;        // instruction, address, mode and dummy bytes
+    char        name[40];   // measurement name
+    const struct {
+        const char* name;   // variant
+        uint8_t     ist;    // instruction
+    } var[] = { {"Read Data", spiFlash->flashType->uint8FlashIstRdData}, {"Fast Read", spiFlash->flashType->uint8FlashIstRdFast},
+                {"Dual Output", spiFlash->flashType->uint8FlashIstRdDualOut}, {"Quad Output", spiFlash->flashType->uint8FlashIstRdQuadOut},
+                {"Quad I/O", spiFlash->flashType->uint8FlashIstRdQuadIo} };
+
+    spi = (uint8_t*) malloc(num + SFM_CS_PKT_MAX);
+    if ( NULL == spi ) {
+        return;
+    }
+    rep = (BENCH_ITERATIONS / 16 * 64) / num + 1;
+    for ( uint32_t i = 0; i < sizeof(var)/sizeof(var[0]); i++ ) {
+        if ( 0 == var[i].ist ) {
+            continue;   // not supported by part
+        }
+        hdr = (0 == i) ? spiFlash->desc.uint32AdrIstLen : ((4 == i) ? spiFlash->desc.uint32RdQuadIoLen : spiFlash->desc.uint32RdFastLen);
+        sfm_bus_reset(spiFlash);
+        t0 = bench_now_ns();
+        for ( uint32_t j = 0; j < rep; j++ ) {
+            memset(spi, 0, hdr);    // address zero, Quad I/O mode bits without continuous read
+            spi[0] = var[i].ist;
+            sfm(spiFlash, spi, num + hdr);
+        }
+        t1 = bench_now_ns();
+        snprintf(name, sizeof(name), "%s %u B", var[i].name, num);
+        bench_report(name, (t1 - t0) / rep / num, "ns/byte");
+        snprintf(name, sizeof(name), "%s, bus", var[i].name);
+        bench_report(name, sfm_bus_mbps(spiFlash), "MB/s");
+    }
+    sfm_bus_reset(spiFlash);
+    free(spi);
+}
+
+
+
+/** @brief bench_iov
+ *
+ *  Read Data with command header and data in separate buffers,
+ *  copy through bounce buffer into #sfm compared with #sfm_iov and #sfm_xfer
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      num             number of data bytes
+ *
+ */
+static void bench_iov (t_sfm *spiFlash, uint32_t num)
+{
+    /** Variables **/
+    uint8_t     hdr[4] = {0x03, 0x00, 0x10, 0x00};  // command header
+    uint8_t*    dat;        // data buffer
+    uint8_t*    bounce;     // contiguous packet
+    t_sfm_iov   iov[2];     // scattered packet
+    double      t0, t1;     // time stamps
+    uint32_t    rep;        // number of repetitions
+
+    dat = (uint8_t*) malloc(num);
+    bounce = (uint8_t*) malloc(num + sizeof(hdr));
+    if ( (NULL == dat) || (NULL == bounce) ) {
+        free(dat);
+        free(bounce);
+        return;
+    }
+    rep = (BENCH_ITERATIONS / 16 * 64) / num + 1;
+    /* bounce buffer */
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        memcpy(bounce, hdr, sizeof(hdr));
+        memcpy(bounce + sizeof(hdr), dat, num);
+        sfm(spiFlash, bounce, num + (uint32_t) sizeof(hdr));
+        memcpy(dat, bounce + sizeof(hdr), num);
+    }
+    t1 = bench_now_ns();
+    bench_report("Read Data bounce buffer", (t1 - t0) / rep / num, "ns/byte");
+    /* in place */
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        hdr[0] = 0x03;
+        hdr[2] = 0x10;
+        iov[0].uint8PtrBuf = hdr;
+        iov[0].uint32Len = sizeof(hdr);
+        iov[1].uint8PtrBuf = dat;
+        iov[1].uint32Len = num;
+        sfm_iov(spiFlash, iov, 2);
+    }
+    t1 = bench_now_ns();
+    bench_report("Read Data sfm_iov", (t1 - t0) / rep / num, "ns/byte");
+    /* full-duplex, const request */
+    memset(bounce, 0, num + sizeof(hdr));
+    memcpy(bounce, hdr, sizeof(hdr));
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        sfm_xfer(spiFlash, bounce, dat, num + (uint32_t) sizeof(hdr));
+    }
+    t1 = bench_now_ns();
+    bench_report("Read Data sfm_xfer", (t1 - t0) / rep / num, "ns/byte");
+    free(dat);
+    free(bounce);
+}
+
+
+
+/** @brief bench_cs
+ *
+ *  Read Data as chip select frame, clocked in chunks like a DMA controller
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      num             number of data bytes
+ *  @param[in]      chunk           bytes per #sfm_cs_xfer
+ *
+ */
+static void bench_cs (t_sfm *spiFlash, uint32_t num, uint32_t chunk)
+{
+    /** Variables **/
+    const uint8_t   hdr[4] = {0x03, 0x00, 0x00, 0x00};  // command header
+    uint8_t*        dat;        // chunk buffer
+    double          t0, t1;     // time stamps
+    uint32_t        rep;        // number of repetitions
+    char            name[32];   // measurement name
+
+    dat = (uint8_t*) malloc(chunk);
+    if ( NULL == dat ) {
+        return;
+    }
+    rep = (BENCH_ITERATIONS / 16 * 64) / num + 1;
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        sfm_cs_low(spiFlash);
+        sfm_cs_xfer(spiFlash, hdr, NULL, sizeof(hdr));
+        for ( uint32_t j = 0; j < num; j += chunk ) {
+            sfm_cs_xfer(spiFlash, NULL, dat, chunk);
+        }
+        sfm_cs_high(spiFlash);
+    }
+    t1 = bench_now_ns();
+    snprintf(name, sizeof(name), "Read Data cs %u B chunk", chunk);
+    bench_report(name, (t1 - t0) / rep / num, "ns/byte");
+    free(dat);
+}
+
+
+
+/** @brief bench_wait
+ *
+ *  polls status register until write in progress is done
+ *
+ *  @param[in,out]  spiFlash        flash model
+ *
+ */
+static void bench_wait (t_sfm *spiFlash)
+{
+    /** Variables **/
+    uint8_t     spi[2];     // SPI buffer
+
+    for ( uint8_t k = 0; k < SFM_WIP_RETRY_IDLE; k++ ) {
+        spi[0] = 0x05;
+        sfm(spiFlash, spi, 2);
+    }
+}
+
+
+
+/** @brief bench_two_pages
+ *
+ *  programs 32 bytes into first and second half of flash
+ *
+ *  @param[in,out]  spiFlash        flash model
+ *
+ */
+static void bench_two_pages (t_sfm *spiFlash)
+{
+    /** Variables **/
+    uint8_t     spi[64];    // SPI buffer
+
+    for ( uint32_t j = 0; j < 2; j++ ) {
+        spi[0] = 0x06;
+        sfm(spiFlash, spi, 1);
+        spi[0] = 0x02;
+        spi[1] = (uint8_t) (j << 4);
+        spi[2] = 0x00;
+        spi[3] = 0x00;
+        memset(spi+4, 0x5a, 32);
+        sfm(spiFlash, spi, 36);
+        bench_wait(spiFlash);
+    }
+}
+
+
+
+/** @brief bench_erase
+ *
+ *  Sector or Chip Erase of flash with two programmed pages, erases first programmed page
+ *
+ *  @param[in,out]  spiFlash        flash model
+ *  @param[in]      *name           name of measurement
+ *  @param[in]      ist             instruction, 0x20: Sector Erase, 0xc7: Chip Erase
+ *  @param[in]      rep             number of repetitions
+ *
+ */
+static void bench_erase (t_sfm *spiFlash, const char *name, uint8_t ist, uint32_t rep)
+{
+    /** Variables **/
+    double      t0, t1;     // time stamps
+    double      ns = 0;     // accumulated erase time
+    uint8_t     spi[4];     // SPI buffer
+    uint32_t    len;        // packet length
+
+    len = (0x20 == ist) ? 4 : 1;
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        bench_two_pages(spiFlash);
+        spi[0] = 0x06;
+        sfm(spiFlash, spi, 1);
+        spi[0] = ist;
+        spi[1] = 0x00;
+        spi[2] = 0x00;
+        spi[3] = 0x00;
+        t0 = bench_now_ns();
+        sfm(spiFlash, spi, len);
+        t1 = bench_now_ns();
+        bench_wait(spiFlash);
+        ns += t1 - t0;
+    }
+    bench_report(name, ns / rep, "ns/packet");
+}
+
+
+
+/** @brief bench_read
+ *
+ *  Read Data packet of given size, only the command header is rebuild before every access
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      num             number of data bytes
+ *
+ */
+static void bench_read (t_sfm *spiFlash, uint32_t num)
+{
+    /** Variables **/
+    uint8_t*    spi;        // SPI buffer
+    double      t0, t1;     // time stamps
+    uint32_t    rep;        // number of repetitions
+    char        name[40];   // measurement name
+
+    spi = (uint8_t*) calloc(num + 4, 1);
+    if ( NULL == spi ) {
+        return;
+    }
+    rep = BENCH_ITERATIONS;
+    if ( num > 64 ) {
+        rep = (uint32_t) (((uint64_t) BENCH_ITERATIONS * 64) / num);
+    }
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        spi[0] = 0x03;
+        spi[1] = 0x00;
+        spi[2] = 0x10;
+        spi[3] = 0x00;
+        sfm(spiFlash, spi, num + 4);
+    }
+    t1 = bench_now_ns();
+    snprintf(name, sizeof(name), "Read Data %u B", num);
+    bench_report(name, (t1 - t0) / rep, "ns/packet");
+    free(spi);
+}
+
+
+
+/** @brief bench_image
+ *
+ *  writes raw image with given density of programmed 16 byte lines and loads it into flash
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      fileName[]      raw image file
+ *  @param[in]      density         programmed lines in percent
+ *  @return         int             0: OKAY, 1: FAIL
+ *
+ */
+static int bench_image (t_sfm *spiFlash, char fileName[], uint32_t density)
+{
+    /** Variables **/
+    FILE*       fp;     // raw image file
+    uint32_t    line;   // 16 byte line
+
+    fp = fopen(fileName, "wb");
+    if ( NULL == fp ) {
+        return 1;
+    }
+    for ( uint32_t i = 0; i < spiFlash->flashType->uint32FlashTopoTotalSizeByte; i++ ) {
+        line = i >> 4;
+        if ( ((line * 2654435761u) >> 8) % 100 < density ) {
+            fputc((uint8_t) (i * 7), fp);
+        } else {
+            fputc(0xff, fp);
+        }
+    }
+    fclose(fp);
+    return sfm_load(spiFlash, fileName);
+}
+
+
+
+/** @brief bench_footprint
+ *
+ *  memory footprint of many model instances with two programmed pages
+ *
+ *  @param[in]      sparse          0: flat memory, 1: sparse memory
+ *  @return         size_t          allocated bytes of all instances
+ *
+ */
+static size_t bench_footprint (int sparse)
+{
+    /** Variables **/
+    t_sfm*      spiFlash;       // model instances
+    size_t      used;           // allocated bytes of instance
+    size_t      total = 0;      // allocated bytes of all instances
+
+    spiFlash = (t_sfm*) malloc(BENCH_INSTANCES * sizeof(t_sfm));
+    if ( NULL == spiFlash ) {
+        return 0;
+    }
+    for ( uint32_t i = 0; i < BENCH_INSTANCES; i++ ) {
+        if ( 0 != sparse ) {
+            sfm_init_sparse(&spiFlash[i], "W25Q16JV");
+        } else {
+            sfm_init(&spiFlash[i], "W25Q16JV");
+        }
+        bench_two_pages(&spiFlash[i]);
+        sfm_mem_usage(&spiFlash[i], &used);
+        total += used;
+    }
+    for ( uint32_t i = 0; i < BENCH_INSTANCES; i++ ) {
+        sfm_free(&spiFlash[i]);
+    }
+    free(spiFlash);
+    return total;
+}
+
+
+
+/** @brief bench_init
+ *
+ *  init, two programmed pages and free of one part, large parts get sparse sectors in sfm_init
+ *
+ *  @param[in]      *part           flash type
+ *  @return         void
+ *
+ */
+static void bench_init (const char *part)
+{
+    /** Variables **/
+    t_sfm       spiFlash;       // model instance
+    size_t      used = 0;       // allocated bytes of instance
+    double      t0, t1;         // time stamps
+    char        name[40];       // measurement name
+    const uint32_t  rep = 16;   // number of repetitions
+
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        if ( 0 != sfm_init(&spiFlash, part) ) {
+            printf("  ERROR:%s: sfm_init '%s'\n", __FUNCTION__, part);
+            sfm_free(&spiFlash);
+            return;
+        }
+        bench_two_pages(&spiFlash);
+        sfm_mem_usage(&spiFlash, &used);
+        sfm_free(&spiFlash);
+    }
+    t1 = bench_now_ns();
+    snprintf(name, sizeof(name), "%s", part);
+    bench_report(name, (t1 - t0) / rep / 1e3, "us/init");
+    snprintf(name, sizeof(name), "%s, memory", part);
+    bench_report(name, (double) used / (1024.0 * 1024.0), "MiB");
+}
+
+
+
+/** @brief bench_legacy_read_dif
+ *
+ *  sscanf based dif reader of release v0.1.0, reference for parser throughput
+ *
+ *  @param[out]     *buf            read in buffer
+ *  @param[in]      len             number of elements in buffer
+ *  @param[in]      fileName[]      file name to file
+ *  @return         int             0: OKAY, 1: FAIL
+ *
+ */
+static int bench_legacy_read_dif (uint8_t *buf, uint32_t len, char fileName[])
+{
+    /** Variables **/
+    FILE*       fp;             // file pointer
+    char        *line = NULL;   // read buffer line
+    char        *sep = NULL;    // separated
+    size_t      lineLen = 0;    // number of elements in read buffer
+    uint8_t     vals[16];       // read values in line
+    uint32_t    adr;            // start address
+    uint32_t    i, j;           // iterator
+    int         intTemp;        // helper variable for sscanf
+    int         intNumChr;      // number read chars
+
+    fp = fopen(fileName, "r");
+    if ( NULL == fp ) {
+        return 1;
+    }
+    memset(buf, 0xff, len);
+    while( -1 != getline(&line, &lineLen, fp) ) {
+        sep = line;
+        intNumChr = 0;
+        sscanf(sep, "%x:%n", &intTemp, &intNumChr);
+        sep += intNumChr;
+        adr = (uint32_t) intTemp;
+        memset(vals, 0xff, sizeof(vals)/sizeof(vals[0]));
+        for ( i = 0; i < sizeof(vals)/sizeof(vals[0]); i++ ) {
+            if ( 0 == strlen(sep) ) {
+                break;
+            }
+            sscanf(sep, "%x%n", &intTemp, &intNumChr);
+            sep += intNumChr;
+            vals[i] = (uint8_t) (intTemp & 0xFF);
+        }
+        if ( adr + i < len ) {
+            for ( j = 0; j < i; j++ ) {
+                buf[adr+j] = vals[j];
+            }
+        }
+    }
+    free(line);
+    fclose(fp);
+    return 0;
+}
+
+
+
+/** @brief bench_file
+ *
+ *  measures store, load and compare throughput of a file format
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      fileName        file name, extension selects format
+ *  @param[in]      rep             number of repetitions
+ *
+ */
+static void bench_file (t_sfm *spiFlash, char fileName[], uint32_t rep)
+{
+    /** Variables **/
+    double      t0, t1;     // time stamps
+    double      mb;         // processed megabytes
+    int         intRet = 0; // return values
+
+    mb = (double) rep * (double) spiFlash->flashType->uint32FlashTopoTotalSizeByte / 1e6;
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        intRet |= sfm_store(spiFlash, fileName);
+    }
+    t1 = bench_now_ns();
+    bench_report("sfm_store", mb / ((t1 - t0) / 1e9), "MB/s");
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        intRet |= sfm_load(spiFlash, fileName);
+    }
+    t1 = bench_now_ns();
+    bench_report("sfm_load", mb / ((t1 - t0) / 1e9), "MB/s");
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        intRet |= sfm_cmp(spiFlash, fileName);
+    }
+    t1 = bench_now_ns();
+    bench_report("sfm_cmp", mb / ((t1 - t0) / 1e9), "MB/s");
+    if ( 0 != intRet ) {
+        printf("  ERROR: file access failed\n");
+    }
+    remove(fileName);
+}
+
+
+
+/** @brief bench_dif_parser
+ *
+ *  dif parser throughput of sfm_load against sscanf based reference
+ *
+ *  @param[in,out]  *spiFlash       SFM handle
+ *  @param[in]      fileName        dif file name
+ *  @param[in]      rep             number of repetitions
+ *
+ */
+static void bench_dif_parser (t_sfm *spiFlash, char fileName[], uint32_t rep)
+{
+    /** Variables **/
+    double      t0, t1;     // time stamps
+    double      mb;         // processed megabytes
+    FILE*       fp;         // dif file
+    uint8_t*    buf;        // reference load buffer
+
+    if ( 0 != sfm_store(spiFlash, fileName) ) {
+        return;
+    }
+    fp = fopen(fileName, "r");
+    if ( NULL == fp ) {
+        return;
+    }
+    fseek(fp, 0, SEEK_END);
+    mb = (double) rep * (double) ftell(fp) / 1e6;
+    fclose(fp);
+    buf = (uint8_t*) malloc(spiFlash->flashType->uint32FlashTopoTotalSizeByte);
+    if ( NULL == buf ) {
+        return;
+    }
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        bench_legacy_read_dif(buf, spiFlash->flashType->uint32FlashTopoTotalSizeByte, fileName);
+    }
+    t1 = bench_now_ns();
+    bench_report("sscanf reference", mb / ((t1 - t0) / 1e9), "MB/s");
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < rep; i++ ) {
+        sfm_load(spiFlash, fileName);
+    }
+    t1 = bench_now_ns();
+    bench_report("sfm_load", mb / ((t1 - t0) / 1e9), "MB/s");
+    if ( 0 != memcmp(buf, spiFlash->uint8PtrMem, spiFlash->flashType->uint32FlashTopoTotalSizeByte - 16) ) {   // reference drops last flash line
+        printf("  ERROR: sfm_load differs from reference\n");
+    }
+    free(buf);
+    remove(fileName);
+}
+
+
+
+/**
+ *  Main
+ *  ----
+ */
+int main (int argc, char *argv[])
+{
+    /** Variables **/
+    t_sfm       spiFlash;       // handle to SPI Flash
+    uint8_t     spi[64];        // spi buffer
+    double      t0, t1;         // time stamps
+    size_t      memFlat;        // memory footprint flat instances
+    size_t      memSparse;      // memory footprint sparse instances
+    char        group[40];      // measurement group
+    const uint32_t  density[]   = {100, 50, 10, 1};
+    const uint32_t  rdSize[]    = {1, 16, 256, 4096};
+    const uint8_t   pktRdId[]   = {0x90, 0x00, 0x00, 0x00, 0x00, 0x00};
+    const uint8_t   pktWrEna[]  = {0x06};
+    const uint8_t   pktWrDis[]  = {0x04};
+    const uint8_t   pktRdSr[]   = {0x05, 0x00};
+    const uint8_t   pktRdDat[]  = {0x03, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+
+    /* entry message */
+    printf("INFO:%s: benchmark started\n", __FUNCTION__);
+
+    /* sfm_init */
+    if ( 0 != sfm_init( &spiFlash, "W25Q16JV" ) ) {
+        printf("ERROR:%s:sfm_init\n", __FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    /* single packets */
+    bench_group("sfm per packet");
+    bench_packet(&spiFlash, sfm, "Read ID", pktRdId, sizeof(pktRdId));
+    bench_packet(&spiFlash, sfm, "Write Enable", pktWrEna, sizeof(pktWrEna));
+    bench_packet(&spiFlash, sfm, "Write Disable", pktWrDis, sizeof(pktWrDis));
+    bench_packet(&spiFlash, sfm, "Read Status Register", pktRdSr, sizeof(pktRdSr));
+    bench_packet(&spiFlash, sfm, "Read Data (4 byte)", pktRdDat, sizeof(pktRdDat));
+    for ( uint32_t i = 0; i < sizeof(rdSize)/sizeof(rdSize[0]); i++ ) {
+        bench_read(&spiFlash, rdSize[i]);
+    }
+    bench_packet(&spiFlash, sfm_W25Q16JV, "Write Enable, part", pktWrEna, sizeof(pktWrEna));
+    bench_packet(&spiFlash, sfm_W25Q16JV, "Read Status Reg., part", pktRdSr, sizeof(pktRdSr));
+    bench_packet(&spiFlash, sfm_W25Q16JV, "Read Data (4 byte), part", pktRdDat, sizeof(pktRdDat));
+
+    /* Page Program sequence: WREN, PP, WIP polls */
+    t0 = bench_now_ns();
+    for ( uint32_t i = 0; i < BENCH_ITERATIONS; i++ ) {
+        spi[0] = 0x06;
+        sfm(&spiFlash, spi, 1);
+        spi[0] = 0x02;
+        spi[1] = 0x00;
+        spi[2] = 0x20;
+        spi[3] = (uint8_t) (i & 0xf0);
+        memset(spi+4, 0xa5, 4);
+        sfm(&spiFlash, spi, 8);
+        for ( uint8_t j = 0; j < SFM_WIP_RETRY_IDLE; j++ ) {
+            spi[0] = 0x05;
+            sfm(&spiFlash, spi, 2);
+        }
+    }
+    t1 = bench_now_ns();
+    bench_report("Page Program sequence", (t1 - t0) / (BENCH_ITERATIONS * (2.0 + SFM_WIP_RETRY_IDLE)), "ns/packet");
+    bench_batch(&spiFlash);
+#if SFM_TRACE
+    bench_trace(&spiFlash, "Read Data, trace", SFM_TRACE_META, pktRdDat, sizeof(pktRdDat));
+    bench_trace(&spiFlash, "Read Data, trace data", SFM_TRACE_HASH | SFM_TRACE_DATA, pktRdDat, sizeof(pktRdDat));
+#endif
+
+    /* bulk transfers */
+    bench_group("sfm bulk transfer");
+    sfm_bus_reset(&spiFlash);
+    bench_bulk(&spiFlash, "Read Data 4 KiB", 0x03, 0x1000, 4096);
+    bench_bulk(&spiFlash, "Read Data 64 KiB wrap", 0x03, 0x1f8000, 65536);
+    bench_bulk(&spiFlash, "Page Program 256 B", 0x02, 0x3000, 256);
+    bench_bulk(&spiFlash, "Page Program 1 KiB wrap", 0x02, 0x3080, 1024);
+    bench_iov(&spiFlash, 4096);
+    bench_cs(&spiFlash, 65536, 256);
+    bench_report("bus data rate", sfm_bus_mbps(&spiFlash), "MB/s");
+    bench_report("bus SCK", spiFlash.bus.uint32SckHz / 1e6, "MHz");
+
+    /* read variants, data phase on one, two and four lanes */
+    bench_group("sfm read variants");
+    bench_lanes(&spiFlash, 4096);
+
+    /* file formats, images of decreasing density loaded from raw image */
+    for ( uint32_t i = 0; i < sizeof(density)/sizeof(density[0]); i++ ) {
+        if ( 0 != bench_image(&spiFlash, "./bench.bin", density[i]) ) {
+            return EXIT_FAILURE;
+        }
+        snprintf(group, sizeof(group), ".dif, %u %% density", density[i]);
+        bench_group(group);
+        bench_file(&spiFlash, "./bench.dif", 2);
+        if ( 100 == density[i] ) {
+            bench_group(".dif parser, 100 % density");
+            bench_dif_parser(&spiFlash, "./bench.dif", 2);
+        }
+        snprintf(group, sizeof(group), ".bin, %u %% density", density[i]);
+        bench_group(group);
+        bench_file(&spiFlash, "./bench.bin", 20);
+    }
+
+    /* whole flash operations, two programmed pages */
+    bench_group("two programmed pages");
+    bench_erase(&spiFlash, "Sector Erase", 0x20, 2000);
+    bench_erase(&spiFlash, "Chip Erase", 0xc7, 200);
+    bench_two_pages(&spiFlash);
+    bench_file(&spiFlash, "./bench.dif", 200);
+
+    /* memory footprint */
+    memFlat = bench_footprint(0);
+    memSparse = bench_footprint(1);
+    snprintf(group, sizeof(group), "memory footprint, %d instances", BENCH_INSTANCES);
+    bench_group(group);
+    bench_report("flat", (double) memFlat / (1024.0 * 1024.0), "MiB");
+    bench_report("sparse", (double) memSparse / (1024.0 * 1024.0), "MiB");
+    if ( 0 != memFlat ) {
+        bench_report("saving", 100.0 * (1.0 - (double) memSparse / (double) memFlat), "%");
+    }
+
+    /* init of growing parts, 4-byte address parts from catalog */
+    bench_group("sfm_init, two programmed pages, sfm_free");
+    bench_init("W25Q16JV");
+    if ( SFM_OK == sfm_catalog_load("./test/spi_flash_parts.txt") ) {
+        bench_init("W25Q128JV");
+        bench_init("W25Q256JV");
+        bench_init("W25Q01JV");
+    }
+
+    /* results file */
+    if ( argc > 1 ) {
+        if ( 0 != bench_write(argv[1], spiFlash.flashType->charFlashName) ) {
+            printf("ERROR:%s:bench_write\n", __FUNCTION__);
+            exit(EXIT_FAILURE);
+        }
+        printf("INFO:%s: results written to '%s'\n", __FUNCTION__, argv[1]);
+    }
+
+    /* graceful end */
+    printf("INFO:%s: benchmark done\n", __FUNCTION__);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,394 @@
+/*************************************************************************
+ @author:     Andreas Kaeberlein
+ @copyright:  Copyright 2022
+ @credits:    AKAE
+
+ @license:    BSDv3
+ @maintainer: Andreas Kaeberlein
+ @email:      andreas.kaeberlein@web.de
+
+ @file:       spi_flash_model_replay.c
+ @date:       2023-04-25
+ @see:        https://github.com/akaeba/spi_flash_model
+
+ @brief:      trace replay
+              replays a binary transaction trace against a fresh model,
+              checks status codes and read data and reports the replay rate
+*************************************************************************/
+
+
+
+/** Includes **/
+/* Standard libs */
+#include <stdlib.h>     // EXIT codes, malloc
+#include <stdio.h>      // f.e. printf
+#include <stdint.h>     // defines fixed data types: int8_t...
+#include <stddef.h>     // various variable types and macros: size_t, offsetof, NULL, ...
+#include <string.h>     // string operation: memset, memcpy
+#include <time.h>       // clock_gettime
+#include <fcntl.h>      // open
+#include <unistd.h>     // close, getopt
+#include <sys/mman.h>   // mmap, munmap
+#include <sys/stat.h>   // fstat
+/* Self */
+#include "spi_flash_model.h"    // function prototypes
+
+
+
+/**
+ *  @defgroup REPLAY_HELP constants
+ *  @{
+ */
+#ifndef REPLAY_ERR_PRINT
+    #define REPLAY_ERR_PRINT    (10)    /**<  Number of printed mismatches */
+#endif
+/** @} */
+
+
+
+/**
+ *  @typedef t_replay_res
+ *
+ *  @brief  replay result
+ *
+ *  @since  April 25, 2023
+ *  @author Andreas Kaeberlein
+ */
+typedef struct {
+    uint64_t    uint64Pkts;         /**<  replayed transactions */
+    uint64_t    uint64ErrRet;       /**<  status code differs from trace */
+    uint64_t    uint64ErrData;      /**<  read data differs from trace */
+    uint64_t    uint64Checked;      /**<  transactions with checked read data */
+    uint64_t    uint64NoData;       /**<  Page Program without recorded data, replayed with idle line */
+    uint64_t    uint64Dropped;      /**<  transactions missing in trace */
+} t_replay_res;
+
+
+
+/** @brief replay_now_ns
+ *
+ *  monotonic time stamp
+ *
+ *  @return         double          time in nanoseconds
+ *
+ */
+static double replay_now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+
+
+/** @brief replay_ist
+ *
+ *  optional instruction match, 0 marks not supported instruction
+ *
+ *  @param[in]      ist             instruction
+ *  @param[in]      flashIst        instruction of flash type
+ *  @return         int             1: match
+ *
+ */
+static int replay_ist (uint8_t ist, uint8_t flashIst)
+{
+    return (0 != flashIst) && (ist == flashIst);
+}
+
+
+
+/** @brief replay_hdr_len
+ *
+ *  instruction, address and dummy bytes in front of data phase
+ *
+ *  @param[in]      *spiFlash       SFM handle
+ *  @param[in]      ist             instruction
+ *  @param[out]     *adr            address bytes, 0: instruction without address
+ *  @return         uint32_t        header length
+ *
+ */
+static uint32_t replay_hdr_len (const t_sfm *spiFlash, uint8_t ist, uint8_t *adr)
+{
+    const t_sfm_type*   flash = spiFlash->flashType;    // selected flash
+
+    *adr = spiFlash->desc.uint8AdrBytes;    // address mode of model, follows replayed Enter/Exit 4-Byte Address Mode
+    if ( (0 != replay_ist(ist, flash->uint8FlashIstRdData4B)) || (0 != replay_ist(ist, flash->uint8FlashIstWrPage4B))
+         || (0 != replay_ist(ist, flash->uint8FlashIstEraseSector4B)) || (0 != replay_ist(ist, flash->uint8FlashIstEraseBlock4B)) ) {
+        *adr = 4;
+        return 1u + *adr;
+    }
+    if ( (0 != replay_ist(ist, flash->uint8FlashIstRdFast)) || (0 != replay_ist(ist, flash->uint8FlashIstRdDualOut)) || (0 != replay_ist(ist, flash->uint8FlashIstRdQuadOut)) ) {
+        return spiFlash->desc.uint32RdFastLen;
+    }
+    if ( 0 != replay_ist(ist, flash->uint8FlashIstRdQuadIo) ) {
+        return spiFlash->desc.uint32RdQuadIoLen;   // mode bits zero, no continuous read
+    }
+    if ( (ist == flash->uint8FlashIstRdData) || (ist == flash->uint8FlashIstWrPage) || (ist == flash->uint8FlashIstEraseSector) || (0 != replay_ist(ist, flash->uint8FlashIstEraseBlock)) ) {
+        return spiFlash->desc.uint32AdrIstLen;
+    }
+    *adr = 0;
+    if ( ist == flash->uint8FlashIstRdID ) {
+        return spiFlash->desc.uint32RdIdLen - spiFlash->desc.uint8IdLen;
+    }
+    return 1;
+}
+
+
+
+/** @brief replay_is_read
+ *
+ *  instruction with flash response in data phase
+ *
+ *  @param[in]      *spiFlash       SFM handle
+ *  @param[in]      ist             instruction
+ *  @return         int             1: read instruction
+ *
+ */
+static int replay_is_read (const t_sfm *spiFlash, uint8_t ist)
+{
+    const t_sfm_type*   flash = spiFlash->flashType;    // selected flash
+
+    return (ist == flash->uint8FlashIstRdData) || (ist == flash->uint8FlashIstRdID) || (ist == flash->uint8FlashIstRdStateReg)
+           || (0 != replay_ist(ist, flash->uint8FlashIstRdData4B)) || (0 != replay_ist(ist, flash->uint8FlashIstRdFast)) || (0 != replay_ist(ist, flash->uint8FlashIstRdDualOut))
+           || (0 != replay_ist(ist, flash->uint8FlashIstRdQuadOut)) || (0 != replay_ist(ist, flash->uint8FlashIstRdQuadIo));
+}
+
+
+
+/** @brief replay_run
+ *
+ *  replays trace against fresh model, model is left open for image compare
+ *
+ *  @param[in]      *trc            mapped trace file
+ *  @param[in]      len             trace file size
+ *  @param[in]      *init           initial flash image, NULL: empty flash
+ *  @param[out]     *spiFlash       SFM handle
+ *  @param[out]     *res            replay result
+ *  @param[in]      print           print mismatches
+ *  @return         double          replay time in ns, negative: model setup failed
+ *
+ */
+static double replay_run (const uint8_t *trc, size_t len, char *init, t_sfm *spiFlash, t_replay_res *res, int print)
+{
+    /** Variables **/
+    const t_sfm_trace_hdr*  hdr = (const t_sfm_trace_hdr*) trc;    // trace file header
+    const t_sfm_trace_rec*  rec;            // traced transaction
+    const uint8_t*          data;           // recorded data phase
+    uint8_t*                pkt = NULL;     // replayed spi packet
+    uint32_t                pktMax = 0;     // allocated packet size
+    uint32_t                hdrLen;         // bytes in front of data phase
+    uint32_t                seq = 0;        // expected transaction number
+    uint8_t                 adr;            // address bytes of instruction
+    int                     ret;            // replayed status
+    size_t                  pos;            // position in trace
+    double                  t0, t1;         // time stamps
+
+    /* fresh model in traced state */
+    memset(res, 0, sizeof(*res));
+    if ( SFM_OK != sfm_init(spiFlash, (char*) hdr->charFlash) ) {
+        printf("ERROR:%s: flash '%s' not supported\n", __FUNCTION__, hdr->charFlash);
+        return -1;
+    }
+    if ( (NULL != init) && (SFM_OK != sfm_load(spiFlash, init)) ) {
+        printf("ERROR:%s: initial image '%s' not loadable\n", __FUNCTION__, init);
+        return -1;
+    }
+    sfm_time_mode(spiFlash, (int) hdr->uint32TimeMode);
+    sfm_bus_cfg(spiFlash, hdr->uint32SckHz);
+
+    /* replay */
+    t0 = replay_now_ns();
+    for ( pos = sizeof(*hdr); pos + hdr->uint32RecByte <= len; pos += hdr->uint32RecByte + ((rec->uint32Data + 7) & ~7U) ) {
+        rec = (const t_sfm_trace_rec*) (trc + pos);
+        data = trc + pos + hdr->uint32RecByte;
+        if ( pos + hdr->uint32RecByte + rec->uint32Data > len ) {
+            break;  // truncated trace
+        }
+        /* dropped transactions */
+        res->uint64Dropped += (uint32_t) (rec->uint32Seq - seq);
+        seq = rec->uint32Seq + 1;
+        if ( 0 == rec->uint32Len ) {
+            continue;
+        }
+        /* packet buffer */
+        if ( rec->uint32Len > pktMax ) {
+            free(pkt);
+            pktMax = rec->uint32Len;
+            pkt = (uint8_t*) malloc(pktMax);
+            if ( NULL == pkt ) {
+                return -1;
+            }
+        }
+        /* instruction and address */
+        hdrLen = replay_hdr_len(spiFlash, rec->uint8Ist, &adr);
+        if ( hdrLen > rec->uint32Len ) {
+            hdrLen = rec->uint32Len;
+        }
+        memset(pkt, 0, hdrLen);
+        pkt[0] = rec->uint8Ist;
+        for ( uint8_t i = 0; (i < adr) && (1u + i < hdrLen); i++ ) {
+            pkt[1+i] = (uint8_t) (rec->uint32Adr >> (8 * (adr - 1 - i)));
+        }
+        /* data phase from trace, f.e. Page Program data; read data is overwritten by model */
+        if ( rec->uint32Data == rec->uint32Len - hdrLen ) {
+            memcpy(pkt + hdrLen, data, rec->uint32Data);
+        } else if ( (rec->uint8Ist == spiFlash->flashType->uint8FlashIstWrPage) || (0 != replay_ist(rec->uint8Ist, spiFlash->flashType->uint8FlashIstWrPage4B)) ) {
+            memset(pkt + hdrLen, 0xff, rec->uint32Len - hdrLen);    // idle line does not program
+            res->uint64NoData += (rec->uint32Len > hdrLen);
+        } else {
+            memset(pkt + hdrLen, 0, rec->uint32Len - hdrLen);
+        }
+        /* virtual clock at transaction start */
+        if ( (SFM_TIME_VIRTUAL == hdr->uint32TimeMode) && (rec->uint64TimeNs > spiFlash->uint64TimeNs) ) {
+            sfm_time_advance(spiFlash, rec->uint64TimeNs - spiFlash->uint64TimeNs);
+        }
+        /* replay and check */
+        ret = sfm(spiFlash, pkt, rec->uint32Len);
+        res->uint64Pkts++;
+        if ( ret != rec->uint16Ret ) {
+            if ( res->uint64ErrRet + res->uint64ErrData < (uint64_t) print ) {
+                printf("  ERROR:%s: seq=%u, IST=0x%02x, adr=0x%x: status is=0x%x, exp=0x%x\n", __FUNCTION__, rec->uint32Seq, rec->uint8Ist, rec->uint32Adr, ret, rec->uint16Ret);
+            }
+            res->uint64ErrRet++;
+            continue;
+        }
+        if ( (0 == replay_is_read(spiFlash, rec->uint8Ist)) || (SFM_OK != ret) || (0 == (rec->uint8Flags & SFM_TRACE_REC_DATA)) || (rec->uint32Len == hdrLen) ) {
+            continue;   // no read data
+        }
+        if ( rec->uint32Data == rec->uint32Len - hdrLen ) {
+            ret = memcmp(pkt + hdrLen, data, rec->uint32Data);
+        } else if ( 0 != (hdr->uint32Mode & SFM_TRACE_HASH) ) {
+            ret = (sfm_trace_hash(pkt + hdrLen, rec->uint32Len - hdrLen) != rec->uint32Hash);
+        } else {
+            continue;   // only meta data recorded
+        }
+        res->uint64Checked++;
+        if ( 0 != ret ) {
+            if ( res->uint64ErrRet + res->uint64ErrData < (uint64_t) print ) {
+                printf("  ERROR:%s: seq=%u, IST=0x%02x, adr=0x%x: data differs\n", __FUNCTION__, rec->uint32Seq, rec->uint8Ist, rec->uint32Adr);
+            }
+            res->uint64ErrData++;
+        }
+    }
+    t1 = replay_now_ns();
+    free(pkt);
+    return t1 - t0;
+}
+
+
+
+/** @brief replay_usage
+ *
+ *  prints command line help
+ *
+ *  @param[in]      *name           program name
+ *
+ */
+static void replay_usage (const char *name)
+{
+    printf("usage: %s [-c part catalog] [-i initial image] [-e expected image] [-r repeats] trace\n", name);
+    printf("  -c    part catalog file of traced flash, @see sfm_catalog_load\n");
+    printf("  -i    flash image loaded before replay, f.e. '.bin' or '.dif'\n");
+    printf("  -e    flash image compared with sfm_cmp after replay\n");
+    printf("  -r    number of replays for rate measurement, default 1\n");
+}
+
+
+
+int main (int argc, char *argv[])
+{
+    /** Variables **/
+    t_sfm           spiFlash;           // handle to SPI Flash
+    t_replay_res    res;                // replay result
+    char*           init = NULL;        // initial flash image
+    char*           expect = NULL;      // expected flash image
+    uint32_t        repeats = 1;        // number of replays
+    int             opt;                // command line option
+    int             fd;                 // trace file
+    struct stat     st;                 // trace file state
+    uint8_t*        trc;                // mapped trace
+    const t_sfm_trace_hdr*  hdr;        // trace file header
+    double          ns = 0;             // accumulated replay time
+    double          run;                // replay time of one run
+    int             cmp = -1;           // image compare, -1: skipped
+    int             fail;               // replay failed
+
+
+    /* command line */
+    while ( -1 != (opt = getopt(argc, argv, "c:i:e:r:h")) ) {
+        switch ( opt ) {
+            case 'c':
+                if ( SFM_OK != sfm_catalog_load(optarg) ) {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'i':
+                init = optarg;
+                break;
+            case 'e':
+                expect = optarg;
+                break;
+            case 'r':
+                repeats = (uint32_t) strtoul(optarg, NULL, 0);
+                break;
+            default:
+                replay_usage(argv[0]);
+                exit((('h' == opt) ? EXIT_SUCCESS : EXIT_FAILURE));
+        }
+    }
+    if ( (optind + 1 != argc) || (0 == repeats) ) {
+        replay_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    /* map trace */
+    fd = open(argv[optind], O_RDONLY);
+    if ( (0 > fd) || (0 != fstat(fd, &st)) || ((size_t) st.st_size < sizeof(t_sfm_trace_hdr)) ) {
+        printf("ERROR:%s: trace '%s' not readable\n", __FUNCTION__, argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+    trc = (uint8_t*) mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if ( MAP_FAILED == trc ) {
+        printf("ERROR:%s: trace '%s' not mappable\n", __FUNCTION__, argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+    hdr = (const t_sfm_trace_hdr*) trc;
+    if ( (0 != memcmp(hdr->charMagic, "SFMTRACE", sizeof(hdr->charMagic))) || (1 != hdr->uint32Version) || (sizeof(t_sfm_trace_rec) != hdr->uint32RecByte) ) {
+        printf("ERROR:%s: '%s' is no trace of this model version\n", __FUNCTION__, argv[optind]);
+        exit(EXIT_FAILURE);
+    }
+    printf("INFO:%s: replay '%s', %.32s\n", __FUNCTION__, argv[optind], hdr->charFlash);
+
+    /* replay, model of last run is compared */
+    for ( uint32_t i = 0; i < repeats; i++ ) {
+        if ( 0 != i ) {
+            sfm_free(&spiFlash);
+        }
+        run = replay_run(trc, (size_t) st.st_size, init, &spiFlash, &res, (0 == i) ? REPLAY_ERR_PRINT : 0);
+        if ( 0 > run ) {
+            exit(EXIT_FAILURE);
+        }
+        ns += run;
+    }
+    if ( NULL != expect ) {
+        cmp = (SFM_OK == sfm_cmp(&spiFlash, expect)) ? 0 : 1;
+    }
+    sfm_free(&spiFlash);
+    munmap(trc, (size_t) st.st_size);
+
+    /* report */
+    printf("  %-24s %12llu\n", "transactions", (unsigned long long) res.uint64Pkts);
+    printf("  %-24s %12llu\n", "status mismatch", (unsigned long long) res.uint64ErrRet);
+    printf("  %-24s %12llu of %llu checked\n", "read data mismatch", (unsigned long long) res.uint64ErrData, (unsigned long long) res.uint64Checked);
+    printf("  %-24s %12llu\n", "page data not traced", (unsigned long long) res.uint64NoData);
+    printf("  %-24s %12llu\n", "dropped in trace", (unsigned long long) res.uint64Dropped);
+    printf("  %-24s %12.2f Mtransactions/s, %.2f ns/transaction\n", "replay rate", (ns > 0) ? 1e3 * (double) res.uint64Pkts * repeats / ns : 0,
+           (0 != res.uint64Pkts) ? ns / ((double) res.uint64Pkts * repeats) : 0);
+    printf("  %-24s %12s\n", "final image", (0 > cmp) ? "skipped" : ((0 == cmp) ? "match" : "mismatch"));
+
+    /* result */
+    fail = (0 != res.uint64ErrRet) || (0 != res.uint64ErrData) || (0 < cmp);
+    printf("INFO:%s: replay %s\n", __FUNCTION__, (0 == fail) ? "SUCCESSFUL" : "FAILED");
+    exit((0 == fail) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -25,6 +25,7 @@
 #include <stddef.h>     // various variable types and macros: size_t, offsetof, NULL, ...
 #include <string.h>     // string operation: memset, memcpy
 #include <strings.h>    // strcasecmp
+#include <sys/stat.h>   // mkdir
 /* Self */
 #include "spi_flash_model.h"    // function prototypes
 
@@ -38,11 +39,31 @@ int main ()
 {
     /** Variables **/
     t_sfm       spiFlash;       // handle to SPI Flash
+    t_sfm       spiFlashRef;    // reference of specialized entry point
     uint8_t     spi[1024];      // spi buffer
     uint32_t    spiLen;         // spiLen
     FILE        *fp;            // file handle
     size_t      len = 0;        // line length
     char        *line = NULL;   // buffer line
+    size_t      memUsed;        // allocated flash emulation memory
+    t_sfm_range ranges[8];      // mismatch report
+    uint32_t    rangeNum;       // number of mismatch ranges
+    t_sfm_pkt   pkts[16];       // packet sequence
+    t_sfm_iov   iov[4];         // scattered packet
+    uint64_t    timeNs;         // virtual time
+    uint8_t*    uint8PtrBuf;    // large transfer buffer
+    int         intRet;         // return value
+    t_sfm_wear_sec  wearHot[2]; // hottest sectors
+    uint32_t    wearHist[4];    // erase cycles histogram
+    uint32_t    wearWidth;      // erase cycles per histogram bin
+    uint32_t    wearNum;        // used wearHot entries
+#if SFM_TRACE
+    t_sfm_trace_hdr traceHdr;   // trace file header
+    t_sfm_trace_rec traceRec;   // traced transaction
+#endif
+#if SFM_STATS
+    t_sfm_stats stats;          // instrumentation counters
+#endif
 
 
     /* entry message */
@@ -76,6 +97,15 @@ int main ()
     }
     if ( (0xef != spi[4]) || (0x14 != spi[5]) ) {
         printf("ERROR:%s:sfm: Wrong ID %02x%02x\n", __FUNCTION__, spi[4], spi[5]);
+        goto ERO_END;
+    }
+
+    /* sfm: Unknown Instruction */
+    printf("INFO:%s:sfm: Unknown Instruction\n", __FUNCTION__);
+    spiLen = 1;
+    spi[0] = 0xa5;
+    if ( SFM_E_IST_FLASH != sfm(&spiFlash, spi, spiLen) ) {
+        printf("ERROR:%s:sfm: Unknown Instruction accepted\n", __FUNCTION__);
         goto ERO_END;
     }
 
@@ -309,6 +339,863 @@ int main ()
         goto ERO_END;
     }
 
+    /* sfm_cmp_ranges: all mismatches */
+    printf("INFO:%s:sfm_cmp_ranges\n", __FUNCTION__);
+    spiFlash.uint8PtrMem[0x12] = 0;         // merged with 0x11
+    spiFlash.uint8PtrMem[0x105] = 0;        // line content
+    spiLen = 1;
+    spi[0] = 0x06;
+    sfm(&spiFlash, spi, spiLen);
+    spiLen = 5;
+    spi[0] = 0x02;  // last flash byte
+    spi[1] = 0x1f;
+    spi[2] = 0xff;
+    spi[3] = 0xff;
+    spi[4] = 0x00;
+    sfm(&spiFlash, spi, spiLen);
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+        spiLen = 2;
+        spi[0] = 0x05;
+        sfm(&spiFlash, spi, spiLen);
+    }
+    if ( (SFM_E_CMP != sfm_cmp_ranges(&spiFlash, "./test/flash_read.dif", ranges, 8, &rangeNum)) || (3 != rangeNum) ||
+         (0x11 != ranges[0].uint32Start) || (0x12 != ranges[0].uint32Stop) ||
+         (0x105 != ranges[1].uint32Start) || (0x105 != ranges[1].uint32Stop) ||
+         (0x1fffff != ranges[2].uint32Start) || (0x1fffff != ranges[2].uint32Stop) ) {
+        printf("ERROR:%s:sfm_cmp_ranges: unexpected report\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (SFM_E_CMP != sfm_cmp_ranges(&spiFlash, "./test/flash_read.dif", ranges, 2, &rangeNum)) || (2 != rangeNum) ) {
+        printf("ERROR:%s:sfm_cmp_ranges: capped report\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (SFM_E_CMP != sfm_cmp_ranges(&spiFlash, "./test/flash_read.dif", NULL, 0, &rangeNum)) || (3 != rangeNum) ) {
+        printf("ERROR:%s:sfm_cmp_ranges: count only\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    /* descending lines */
+    fp = fopen("./flash_unsorted.dif", "w");
+    if ( NULL == fp ) {
+        printf("ERROR:%s:sfm_cmp_ranges: open file\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    fprintf(fp, "00100: 00 10 20 30 40 50 60 70 80 90 A0 B0 C0 D0 E0 F0\n00000: 00 01 02 03 04 05 06 07 08 09 0A 0B 0C 0D 0E 0F\n");
+    fclose(fp);
+    if ( (SFM_E_CMP != sfm_cmp_ranges(&spiFlash, "./flash_unsorted.dif", ranges, 8, &rangeNum)) || (3 != rangeNum) || (0x105 != ranges[1].uint32Start) ) {
+        printf("ERROR:%s:sfm_cmp_ranges: unsorted file\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    spiFlash.uint8PtrMem[0x11] = 0xff;
+    spiFlash.uint8PtrMem[0x12] = 0xff;
+    spiFlash.uint8PtrMem[0x105] = 0x50;
+    spiFlash.uint8PtrMem[0x1fffff] = 0xff;
+    if ( (0 != sfm_cmp_ranges(&spiFlash, "./flash_unsorted.dif", ranges, 8, &rangeNum)) || (0 != rangeNum) ) {
+        printf("ERROR:%s:sfm_cmp_ranges: unsorted file mismatch\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    remove("./flash_unsorted.dif");
+
+    /* sfm_blank_check */
+    printf("INFO:%s:sfm_blank_check\n", __FUNCTION__);
+    if ( 2 != spiFlash.uint32SectorAlloc ) {
+        printf("ERROR:%s:sfm_blank_check: expected two written sectors, is=%u\n", __FUNCTION__, spiFlash.uint32SectorAlloc);
+        goto ERO_END;
+    }
+    if ( (0 != sfm_blank_check(&spiFlash, 0x110, 0x1ffeef, NULL)) || (SFM_E_CMP != sfm_blank_check(&spiFlash, 0x80, 0x100, &rangeNum)) || (0x100 != rangeNum) ) {
+        printf("ERROR:%s:sfm_blank_check\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( SFM_E_ACCESS != sfm_blank_check(&spiFlash, 0x1fff00, 0x101, NULL) ) {
+        printf("ERROR:%s:sfm_blank_check: range exceeds flash\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+    /* lazy Chip Erase, erase generation wrap */
+    printf("INFO:%s:sfm: Chip erase generation wrap\n", __FUNCTION__);
+    spiFlash.uint32EraseGen = UINT32_MAX - 1;
+    for ( uint32_t i = 0; i < 512; i++ ) {
+        spiFlash.uint32PtrSecGen[i] = UINT32_MAX - 1;
+    }
+    for ( uint8_t j = 0; j < 2; j++ ) {
+        spiLen = 1;
+        spi[0] = 0x06;
+        sfm(&spiFlash, spi, spiLen);
+        spi[0] = 0xc7;
+        sfm(&spiFlash, spi, spiLen);
+        for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+            spiLen = 2;
+            spi[0] = 0x05;
+            sfm(&spiFlash, spi, spiLen);
+        }
+        if ( (0 != sfm_blank_check(&spiFlash, 0, 0x200000, NULL)) || (0 != spiFlash.uint32SectorAlloc) ) {
+            printf("ERROR:%s:sfm: Chip erase, flash not blank\n", __FUNCTION__);
+            goto ERO_END;
+        }
+        spiLen = 1;
+        spi[0] = 0x06;
+        sfm(&spiFlash, spi, spiLen);
+        spiLen = 5;
+        spi[0] = 0x02;
+        spi[1] = 0x00;
+        spi[2] = 0x01;
+        spi[3] = 0x08;
+        spi[4] = 0x55;
+        sfm(&spiFlash, spi, spiLen);
+        for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+            spiLen = 2;
+            spi[0] = 0x05;
+            sfm(&spiFlash, spi, spiLen);
+        }
+        spiLen = 6;
+        spi[0] = 0x03;
+        spi[1] = 0x00;
+        spi[2] = 0x01;
+        spi[3] = 0x07;
+        sfm(&spiFlash, spi, spiLen);
+        if ( (0xff != spi[4]) || (0x55 != spi[5]) || (1 != spiFlash.uint32SectorAlloc) ) {
+            printf("ERROR:%s:sfm: Chip erase, sector not materialized\n", __FUNCTION__);
+            goto ERO_END;
+        }
+    }
+    if ( 1 != spiFlash.uint32EraseGen ) {
+        printf("ERROR:%s:sfm: Chip erase, generation not wrapped\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+    /* sfm_init_sparse */
+    printf("INFO:%s: sfm_init_sparse\n", __FUNCTION__);
+    sfm_free(&spiFlash);
+    if ( 0 != sfm_init_sparse( &spiFlash, "W25Q16JV" ) ) {
+        printf("ERROR:%s:sfm_init_sparse\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    spiFlash.intMsgLevel = 1;
+    if ( (0 != sfm_mem_usage(&spiFlash, &memUsed)) || (0 != spiFlash.uint32SectorAlloc) ) {
+        printf("ERROR:%s:sfm_init_sparse: sectors allocated\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    /* sparse: load, only written sector allocated */
+    if ( 0 != sfm_load(&spiFlash, "./test/flash_read.dif") ) {
+        printf("ERROR:%s:sparse:sfm_load: Failed to read file\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( 1 != spiFlash.uint32SectorAlloc ) {
+        printf("ERROR:%s:sparse:sfm_load: expected one allocated sector, is=%u\n", __FUNCTION__, spiFlash.uint32SectorAlloc);
+        goto ERO_END;
+    }
+    if ( 0 != sfm_cmp(&spiFlash, "./test/flash_read.dif") ) {
+        printf("ERROR:%s:sparse:sfm_cmp: Mismatch\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    /* sparse: Read Data across written and unwritten sector */
+    spiLen = 12;
+    spi[0] = 0x03;
+    spi[1] = 0x1F;  // last sector, wraps to first sector
+    spi[2] = 0xFF;
+    spi[3] = 0xFC;
+    if ( 0 != sfm(&spiFlash, spi, spiLen) ) {
+        printf("ERROR:%s:sparse:sfm: Read Data\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (0xff != spi[4]) || (0xff != spi[7]) || (0x00 != spi[8]) || (0x03 != spi[11]) ) {
+        printf("ERROR:%s:sparse:sfm: Invalid Read Data value\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    /* sparse: Page Program allocates sector */
+    spiLen = 1;
+    spi[0] = 0x06;
+    sfm(&spiFlash, spi, spiLen);
+    spiLen = 6;
+    spi[0] = 0x02;
+    spi[1] = 0x10;
+    spi[2] = 0x00;
+    spi[3] = 0x00;
+    spi[4] = 0x55;
+    spi[5] = 0xaa;
+    if ( (0 != sfm(&spiFlash, spi, spiLen)) || (2 != spiFlash.uint32SectorAlloc) ) {
+        printf("ERROR:%s:sparse:sfm: Page Program\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+        spiLen = 2;
+        spi[0] = 0x05;
+        sfm(&spiFlash, spi, spiLen);
+    }
+    if ( 0 != sfm_dump(&spiFlash, 0x100000, 0x100010) ) {
+        printf("ERROR:%s:sparse:sfm_dump\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    /* sparse: Sector Erase releases sector */
+    spiLen = 1;
+    spi[0] = 0x06;
+    sfm(&spiFlash, spi, spiLen);
+    spiLen = 4;
+    spi[0] = 0x20;
+    spi[1] = 0x10;
+    spi[2] = 0x00;
+    spi[3] = 0x00;
+    if ( (0 != sfm(&spiFlash, spi, spiLen)) || (1 != spiFlash.uint32SectorAlloc) ) {
+        printf("ERROR:%s:sparse:sfm: Sector erase\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    /* sparse: store and compare against flat store */
+    if ( 0 != sfm_store(&spiFlash, "./flash_sparse.dif") ) {
+        printf("ERROR:%s:sparse:sfm_store: Failed to write file\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( 0 != sfm_cmp(&spiFlash, "./flash_sparse.dif") ) {
+        printf("ERROR:%s:sparse:sfm_cmp: Mismatch\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    remove("./flash_sparse.dif");
+    sfm_mem_usage(&spiFlash, &memUsed);
+    sfm_free(&spiFlash);
+
+    /* sfm_init_mmap */
+    printf("INFO:%s: sfm_init_mmap\n", __FUNCTION__);
+    remove("./flash_mmap.bin");
+    if ( 0 != sfm_init_mmap( &spiFlash, "W25Q16JV", "./flash_mmap.bin", SFM_MMAP_SHARED ) ) {
+        printf("ERROR:%s:sfm_init_mmap\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (0xff != spiFlash.uint8PtrMem[0]) || (0xff != spiFlash.uint8PtrMem[0x1FFFFF]) ) {
+        printf("ERROR:%s:sfm_init_mmap: new image not empty\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    spiLen = 1;
+    spi[0] = 0x06;
+    sfm(&spiFlash, spi, spiLen);
+    spiLen = 6;
+    spi[0] = 0x02;
+    spi[1] = 0x00;
+    spi[2] = 0x20;
+    spi[3] = 0x00;
+    spi[4] = 0x12;
+    spi[5] = 0x34;
+    if ( 0 != sfm(&spiFlash, spi, spiLen) ) {
+        printf("ERROR:%s:sfm_init_mmap: Page Program\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( 0 != sfm_flush(&spiFlash) ) {
+        printf("ERROR:%s:sfm_flush\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_free(&spiFlash);
+        // private mapping sees persisted image, changes are not written back
+    if ( 0 != sfm_init_mmap( &spiFlash, "W25Q16JV", "./flash_mmap.bin", SFM_MMAP_PRIVATE ) ) {
+        printf("ERROR:%s:sfm_init_mmap: private\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (0x12 != spiFlash.uint8PtrMem[0x2000]) || (0x34 != spiFlash.uint8PtrMem[0x2001]) ) {
+        printf("ERROR:%s:sfm_init_mmap: image not persisted\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    spiLen = 1;
+    spi[0] = 0x06;
+    sfm(&spiFlash, spi, spiLen);
+    spi[0] = 0xc7;
+    sfm(&spiFlash, spi, spiLen);
+    sfm_flush(&spiFlash);   // apply lazy erase to memory
+    if ( 0xff != spiFlash.uint8PtrMem[0x2000] ) {
+        printf("ERROR:%s:sfm_init_mmap: private chip erase\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_free(&spiFlash);
+    if ( 0 != sfm_init_mmap( &spiFlash, "W25Q16JV", "./flash_mmap.bin", SFM_MMAP_SHARED ) ) {
+        printf("ERROR:%s:sfm_init_mmap: reopen\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( 0x12 != spiFlash.uint8PtrMem[0x2000] ) {
+        printf("ERROR:%s:sfm_init_mmap: private mapping changed image\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_free(&spiFlash);
+    if ( (SFM_E_ACCESS != sfm_init_mmap(&spiFlash, "W25Q16JV", "./test/not_existing/flash.bin", SFM_MMAP_SHARED))
+         || (NULL != spiFlash.flashType) || (NULL != spiFlash.uint32PtrSecGen) || (NULL != spiFlash.wear.uint32PtrProg) ) {
+        printf("ERROR:%s:sfm_init_mmap: failed init not released\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+    /* sfm_load/sfm_store/sfm_cmp: raw binary image */
+    printf("INFO:%s: bin image\n", __FUNCTION__);
+    if ( 0 != sfm_init( &spiFlash, "W25Q16JV" ) ) {
+        printf("ERROR:%s:sfm_init\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    spiFlash.intMsgLevel = 1;
+    if ( (0 != sfm_load(&spiFlash, "./flash_mmap.bin")) || (0x12 != spiFlash.uint8PtrMem[0x2000]) || (0x34 != spiFlash.uint8PtrMem[0x2001]) ) {
+        printf("ERROR:%s:sfm_load: bin\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( 0 != sfm_store(&spiFlash, "./flash.bin") ) {
+        printf("ERROR:%s:sfm_store: bin\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( 0 != sfm_cmp(&spiFlash, "./flash.bin") ) {
+        printf("ERROR:%s:sfm_cmp: bin mismatch\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    spiFlash.uint8PtrMem[0x2001] = 0x00;
+    if ( SFM_E_CMP != sfm_cmp(&spiFlash, "./flash.bin") ) {
+        printf("ERROR:%s:sfm_cmp: bin mismatch expected\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    /* failed load: read error after erase, flash stays erased */
+    mkdir("./flash_dir.dif", 0755);
+    mkdir("./flash_dir.bin", 0755);
+    for ( uint8_t i = 0; i < 2; i++ ) {
+        if ( (0 != sfm_load(&spiFlash, "./flash.bin")) || (SFM_E_ACCESS != sfm_load(&spiFlash, (0 == i) ? "./flash_dir.dif" : "./flash_dir.bin")) ) {
+            printf("ERROR:%s:sfm_load: unreadable file %d\n", __FUNCTION__, i);
+            goto ERO_END;
+        }
+        memcpy(spi, "\x03\x00\x20\x00\x00\x00", 6);
+        sfm(&spiFlash, spi, 6);
+        if ( (0xff != spi[4]) || (0xff != spi[5]) ) {
+            printf("ERROR:%s:sfm_load: failed load not erased %d\n", __FUNCTION__, i);
+            goto ERO_END;
+        }
+    }
+    remove("./flash_dir.dif");
+    remove("./flash_dir.bin");
+    sfm_free(&spiFlash);
+    if ( 0 != sfm_init_sparse( &spiFlash, "W25Q16JV" ) ) {
+        printf("ERROR:%s:sfm_init_sparse\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (0 != sfm_load(&spiFlash, "./flash.bin")) || (1 != spiFlash.uint32SectorAlloc) ) {
+        printf("ERROR:%s:sfm_load: sparse bin\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( 0 != sfm_cmp(&spiFlash, "./flash_mmap.bin") ) {
+        printf("ERROR:%s:sfm_cmp: sparse bin mismatch\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_free(&spiFlash);
+    remove("./flash.bin");
+    remove("./flash_mmap.bin");
+
+    /* sfm_batch: fused write sequence */
+    printf("INFO:%s: sfm_batch\n", __FUNCTION__);
+    if ( 0 != sfm_init( &spiFlash, "W25Q16JV" ) ) {
+        printf("ERROR:%s:sfm_init\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    spiLen = 0;
+    pkts[spiLen].uint8PtrSpi = spi;         // Write Enable
+    pkts[spiLen++].uint32Len = 1;
+    spi[0] = 0x06;
+    pkts[spiLen].uint8PtrSpi = spi + 1;     // Page Program
+    pkts[spiLen++].uint32Len = 6;
+    memcpy(spi + 1, "\x02\x00\x30\x00\x12\x34", 6);
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE + 1; i++ ) {  // Read Status Register
+        pkts[spiLen].uint8PtrSpi = spi + 7 + 2*i;
+        pkts[spiLen++].uint32Len = 2;
+        spi[7 + 2*i] = 0x05;
+    }
+    pkts[spiLen].uint8PtrSpi = spi + 100;   // Read Data
+    pkts[spiLen++].uint32Len = 6;
+    memcpy(spi + 100, "\x03\x00\x30\x00\x00\x00", 6);
+    pkts[spiLen].uint8PtrSpi = spi + 110;   // unknown instruction
+    pkts[spiLen++].uint32Len = 1;
+    spi[110] = 0xa5;
+    if ( SFM_E_IST_FLASH != sfm_batch(&spiFlash, pkts, spiLen) ) {
+        printf("ERROR:%s:sfm_batch: expected instruction error\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE + 1; i++ ) {
+        if ( (SFM_OK != pkts[2+i].intRet) || ((i < SFM_WIP_RETRY_IDLE) != (0 != (spi[8 + 2*i] & 0x01))) ) {
+            printf("ERROR:%s:sfm_batch: status poll %i\n", __FUNCTION__, i);
+            goto ERO_END;
+        }
+    }
+    if ( (SFM_OK != pkts[0].intRet) || (SFM_OK != pkts[1].intRet) || (0x12 != spi[104]) || (0x34 != spi[105]) || (SFM_E_IST_FLASH != pkts[spiLen-1].intRet) ) {
+        printf("ERROR:%s:sfm_batch: packet state\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_free(&spiFlash);
+
+    /* sfm_iov: command, address and data in separate buffers */
+    printf("INFO:%s: sfm_iov\n", __FUNCTION__);
+    if ( 0 != sfm_init( &spiFlash, "W25Q16JV" ) ) {
+        printf("ERROR:%s:sfm_init\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    spi[0] = 0x06;  // Write Enable
+    iov[0].uint8PtrBuf = spi;
+    iov[0].uint32Len = 1;
+    if ( 0 != sfm_iov(&spiFlash, iov, 1) ) {
+        printf("ERROR:%s:sfm_iov: write enable\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    memcpy(spi, "\x02\x00\x40\xfe", 4);   // Page Program, wraps at page end
+    memcpy(spi + 512, "\xa0\xa1\xa2\xa3", 4);
+    iov[0].uint32Len = 1;
+    iov[1].uint8PtrBuf = spi + 1;
+    iov[1].uint32Len = 3;
+    iov[2].uint8PtrBuf = spi + 512;
+    iov[2].uint32Len = 4;
+    if ( (0 != sfm_iov(&spiFlash, iov, 3)) || (0 != spi[0]) || (0 != spi[1]) || (0 != spi[3]) || (0xa3 != spi[515]) ) {
+        printf("ERROR:%s:sfm_iov: page program\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    do {    // Read Status Register until idle
+        spi[0] = 0x05;
+        iov[1].uint32Len = 1;
+        if ( 0 != sfm_iov(&spiFlash, iov, 2) ) {
+            printf("ERROR:%s:sfm_iov: read status register\n", __FUNCTION__);
+            goto ERO_END;
+        }
+    } while ( 0 != (spi[1] & 0x01) );
+    memcpy(spi, "\x03\x00\x40\xfe", 4);   // Read Data, data split in two buffers
+    iov[1].uint32Len = 3;
+    iov[2].uint32Len = 1;
+    iov[3].uint8PtrBuf = spi + 600;
+    iov[3].uint32Len = 3;
+    if ( (0 != sfm_iov(&spiFlash, iov, 4)) || (0 != spi[0]) || (0xa0 != spi[512]) || (0xa1 != spi[600]) || (0xff != spi[601]) ) {
+        printf("ERROR:%s:sfm_iov: read data\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    memcpy(spi, "\x03\x00\x40\x00", 4);
+    memset(spi + 4, 0x55, 4);   // same packet contiguous
+    if ( (0 != sfm(&spiFlash, spi, 8)) || (0xa2 != spi[4]) || (0xa3 != spi[5]) || (0xff != spi[6]) ) {
+        printf("ERROR:%s:sfm_iov: page wrap\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+    /* sfm_xfer: request not modified */
+    printf("INFO:%s: sfm_xfer\n", __FUNCTION__);
+    if ( (0 != sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1)) || (0 == (spiFlash.uint8StatusReg1 & 0x02)) ) {
+        printf("ERROR:%s:sfm_xfer: write enable\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    memcpy(spi, "\x02\x00\x50\x10\x5a\xa5", 6);   // Page Program, response discarded
+    if ( (0 != sfm_xfer(&spiFlash, spi, NULL, 6)) || (0x02 != spi[0]) ) {
+        printf("ERROR:%s:sfm_xfer: page program\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x05\x00", spi + 512, 2);
+    }
+    memcpy(spi, "\x03\x00\x50\x10", 4);  // Read Data, only header transmitted
+    memset(spi + 512, 0x77, 7);
+    if ( (0 != sfm_xfer(&spiFlash, spi, spi + 512, 7)) || (0x03 != spi[0]) || (0 != spi[512]) || (0 != spi[515]) || (0x5a != spi[516]) || (0xa5 != spi[517]) || (0xff != spi[518]) ) {
+        printf("ERROR:%s:sfm_xfer: read data\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x04", NULL, 1);    // Page Program after Write Disable returns request
+    memcpy(spi, "\x02\x00\x50\x10", 4);
+    if ( (SFM_E_WP_FLASH != sfm_xfer(&spiFlash, spi, spi + 512, 4)) || (0 != memcmp(spi, spi + 512, 4)) ) {
+        printf("ERROR:%s:sfm_xfer: write protection\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+    /* chip select framed transfer: byte wise Page Program, Read Data in chunks across flash end */
+    printf("INFO:%s: sfm_cs_low/sfm_cs_xfer/sfm_cs_high\n", __FUNCTION__);
+    if ( SFM_E_CS != sfm_cs_xfer(&spiFlash, spi, NULL, 1) ) {
+        printf("ERROR:%s:sfm_cs_xfer: without chip select\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+    memcpy(spi, "\x02\x1f\xff\xff\x11\x22", 6);
+    if ( 0 != sfm_cs_low(&spiFlash) ) {
+        printf("ERROR:%s:sfm_cs_low\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    for ( uint8_t i = 0; i < 6; i++ ) {
+        sfm_cs_xfer(&spiFlash, spi + i, NULL, 1);
+    }
+    if ( (0 != sfm_cs_high(&spiFlash)) || (0x11 != spiFlash.uint8PtrMem[0x1fffff]) || (0x22 != spiFlash.uint8PtrMem[0x1fff00]) ) {
+        printf("ERROR:%s:sfm_cs_high: page program\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x05\x00", NULL, 2);
+    }
+    memcpy(spi, "\x03\x1f\xff\xfe", 4);
+    sfm_cs_low(&spiFlash);
+    sfm_cs_xfer(&spiFlash, spi, spi + 512, 3);  // address split
+    sfm_cs_xfer(&spiFlash, spi + 3, spi + 515, 2);
+    sfm_cs_xfer(&spiFlash, NULL, spi + 517, 300);
+    if ( (0 != sfm_cs_high(&spiFlash)) || (0 != spi[512]) || (0xff != spi[516]) || (0x11 != spi[517]) || (0xff != spi[518]) || (0xff != spi[816]) ) {
+        printf("ERROR:%s:sfm_cs_high: read data\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+    /* virtual time: Sector Erase busy for tSE */
+    printf("INFO:%s: sfm_time_mode/sfm_time_advance/sfm_time_next\n", __FUNCTION__);
+    if ( 0 != sfm_time_mode(&spiFlash, SFM_TIME_VIRTUAL) ) {
+        printf("ERROR:%s:sfm_time_mode\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+    if ( 0 != sfm_xfer(&spiFlash, (const uint8_t*) "\x20\x00\x50\x00", NULL, 4) ) {
+        printf("ERROR:%s:sfm_time: sector erase\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    timeNs = spiFlash.uint64TimeNs + (uint64_t) spiFlash.flashType->uint32FlashTimeSectorEraseUs * 1000;  // end of erase
+    for ( uint8_t i = 0; i < 2*SFM_WIP_RETRY_IDLE; i++ ) {   // polls do not finish write
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x05\x00", spi, 2);
+        if ( 0 == (spi[1] & 0x01) ) {
+            printf("ERROR:%s:sfm_time: WIP cleared by poll\n", __FUNCTION__);
+            goto ERO_END;
+        }
+    }
+    sfm_time_advance(&spiFlash, (uint64_t) (spiFlash.flashType->uint32FlashTimeSectorEraseUs - 1000) * 1000);  // 1ms left
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+    if ( SFM_E_WIP_FLASH != sfm_xfer(&spiFlash, (const uint8_t*) "\x02\x00\x50\x00\x00", NULL, 5) ) {
+        printf("ERROR:%s:sfm_time: page program while erase\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (0 == sfm_time_next(&spiFlash)) || (0 != sfm_time_next(&spiFlash)) || (timeNs != spiFlash.uint64TimeNs) ) {
+        printf("ERROR:%s:sfm_time_next\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x05\x00", spi, 2);
+    if ( (0 != (spi[1] & 0x01)) || (0xff != spiFlash.uint8PtrMem[0x5010]) ) {
+        printf("ERROR:%s:sfm_time: erase done\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+    /* bus time: Read Data 256 bytes, 260 bytes on one lane */
+    printf("INFO:%s: sfm_bus_cfg/sfm_bus_ns/sfm_bus_mbps\n", __FUNCTION__);
+    if ( (SFM_E_ACCESS != sfm_bus_cfg(&spiFlash, 0)) || (0 != sfm_bus_cfg(&spiFlash, 10000000)) || (0 != sfm_bus_ns(&spiFlash)) ) {
+        printf("ERROR:%s:sfm_bus_cfg\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    timeNs = spiFlash.uint64TimeNs;
+    memcpy(spi, "\x03\x00\x00\x00", 4);
+    sfm(&spiFlash, spi, 260);
+    if ( (2080 != spiFlash.bus.uint64Cycles) || (208000 != sfm_bus_ns(&spiFlash)) || (timeNs + 208000 != spiFlash.uint64TimeNs) || (sfm_bus_mbps(&spiFlash) < 1.23) || (sfm_bus_mbps(&spiFlash) > 1.24) ) {
+        printf("ERROR:%s:sfm_bus: read data\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_bus_reset(&spiFlash);
+    if ( (0 != sfm_bus_ns(&spiFlash)) || (0 != sfm_bus_mbps(&spiFlash)) ) {
+        printf("ERROR:%s:sfm_bus_reset\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+    /* fast read variants: same data as Read Data across flash end, data phase on one, two and four lanes */
+    printf("INFO:%s: Fast Read/Dual Output/Quad Output/Quad I/O\n", __FUNCTION__);
+    memcpy(spi + 512, "\x03\x1f\xff\xf0", 4);
+    sfm(&spiFlash, spi + 512, 260);
+    for ( uint8_t i = 0; i < 4; i++ ) {
+        memset(spi, 0, 263);
+        memcpy(spi, (const uint8_t*) "\x0b\x1f\xff\xf0\x3b\x1f\xff\xf0\x6b\x1f\xff\xf0\xeb\x1f\xff\xf0" + 4*i, 4);
+        spiLen = (3 == i) ? 7 : 5;  // dummy clocks, Quad I/O: mode byte and 4 clocks on four lanes
+        if ( (0 != sfm(&spiFlash, spi, spiLen + 256)) || (0 != memcmp(spi + spiLen, spi + 516, 256)) ) {
+            printf("ERROR:%s:sfm: fast read variant %d\n", __FUNCTION__, i);
+            goto ERO_END;
+        }
+    }
+    if ( (2080 + 2088 + 1064 + 552 + 532 != spiFlash.bus.uint64Cycles) || (512 != spiFlash.bus.uint64LaneByte[0])
+         || (256 != spiFlash.bus.uint64LaneByte[1]) || (512 != spiFlash.bus.uint64LaneByte[2]) ) {
+        printf("ERROR:%s:sfm_bus: fast read lanes\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    memcpy(spi, "\xeb\x00\x00\x00\xa0\x00\x00", 7);  // M5-4 = 10b, continuous read mode
+    if ( SFM_E_IST_FLASH != sfm(&spiFlash, spi, 8) ) {
+        printf("ERROR:%s:sfm: continuous read mode\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    memcpy(spi, "\xeb\x1f\xff\xf0\x00\x00\x00", 7);
+    sfm_cs_low(&spiFlash);
+    sfm_cs_xfer(&spiFlash, spi, spi + 7, 5);    // mode byte in first chunk
+    sfm_cs_xfer(&spiFlash, spi + 5, spi + 12, 2);
+    sfm_cs_xfer(&spiFlash, NULL, spi + 14, 256);
+    if ( (0 != sfm_cs_high(&spiFlash)) || (0 != memcmp(spi + 14, spi + 516, 256)) ) {
+        printf("ERROR:%s:sfm_cs_high: quad i/o read\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_bus_reset(&spiFlash);
+    /* slow SCK: long transaction advances virtual clock by bus time */
+    uint8PtrBuf = (uint8_t*) calloc(1024*1024 + 4, 1);
+    if ( (NULL == uint8PtrBuf) || (0 != sfm_bus_cfg(&spiFlash, 1000000)) ) {
+        printf("ERROR:%s:sfm_bus_cfg: slow clock\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    timeNs = spiFlash.uint64TimeNs;
+    uint8PtrBuf[0] = 0x03;
+    sfm(&spiFlash, uint8PtrBuf, 1024*1024 + 4);
+    free(uint8PtrBuf);
+    if ( (8388640000ULL != sfm_bus_ns(&spiFlash)) || (timeNs + sfm_bus_ns(&spiFlash) != spiFlash.uint64TimeNs) ) {
+        printf("ERROR:%s:sfm_bus: slow clock virtual time\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_bus_cfg(&spiFlash, SFM_SCK_HZ);
+
+#if SFM_STATS
+    /* instrumentation counters: two reads and one unknown instruction */
+    printf("INFO:%s: sfm_stats_reset/sfm_stats_snapshot/sfm_stats_dump\n", __FUNCTION__);
+    sfm_stats_reset(&spiFlash);
+    memcpy(spi, "\x03\x00\x00\x00", 4);
+    sfm(&spiFlash, spi, 260);
+    memcpy(spi, "\x03\x00\x00\x00", 4);
+    sfm(&spiFlash, spi, 10);
+    spi[0] = 0xfe;
+    sfm(&spiFlash, spi, 1);
+    sfm_stats_snapshot(&spiFlash, &stats);
+    if ( (2 != stats.ist[0x03].uint64Calls) || (270 != stats.ist[0x03].uint64Bytes) || (10 != stats.ist[0x03].uint32LenMin) || (260 != stats.ist[0x03].uint32LenMax) || (0 != stats.ist[0x03].uint64Errors) ) {
+        printf("ERROR:%s:sfm_stats: read data\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (1 != stats.ist[0xfe].uint64Errors) || (1 != stats.uint64Err[3]) ) {
+        printf("ERROR:%s:sfm_stats: unknown instruction\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( SFM_OK != sfm_stats_dump(&stats, NULL) ) {
+        printf("ERROR:%s:sfm_stats_dump\n", __FUNCTION__);
+        goto ERO_END;
+    }
+#endif
+
+    /* wear: two Sector Erase and Page Program on sector 3, endurance limit two erase cycles */
+    printf("INFO:%s: sfm_wear_limit/sfm_wear_hot/sfm_wear_hist/sfm_wear_dump\n", __FUNCTION__);
+    sfm_wear_reset(&spiFlash);
+    sfm_wear_limit(&spiFlash, 2);
+    for ( uint8_t i = 0; i < 3; i++ ) {
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+        intRet = sfm_xfer(&spiFlash, (const uint8_t*) "\x20\x00\x30\x00", NULL, 4);
+        sfm_time_next(&spiFlash);
+        if ( ((i < 2) && (SFM_OK != intRet)) || ((2 == i) && (SFM_E_WEAR != intRet)) ) {
+            printf("ERROR:%s:sfm_wear: sector erase %i\n", __FUNCTION__, i);
+            goto ERO_END;
+        }
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x02\x00\x31\x00\x55", NULL, 5);
+        sfm_time_next(&spiFlash);
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+    if ( SFM_E_WEAR != sfm_xfer(&spiFlash, (const uint8_t*) "\xc7", NULL, 1) ) {
+        printf("ERROR:%s:sfm_wear: chip erase\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_wear_limit(&spiFlash, 0);
+    sfm_xfer(&spiFlash, (const uint8_t*) "\xc7", NULL, 1);
+    sfm_time_next(&spiFlash);
+    if ( (SFM_OK != sfm_wear_hot(&spiFlash, wearHot, 2, &wearNum)) || (2 != wearNum) || (3 != wearHot[0].uint32Sector) || (3 != wearHot[0].uint32Erase)
+         || (3 != wearHot[0].uint32ProgMax) || (0 != wearHot[1].uint32Sector) || (1 != wearHot[1].uint32Erase) ) {
+        printf("ERROR:%s:sfm_wear_hot\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (SFM_OK != sfm_wear_hist(&spiFlash, wearHist, 4, &wearWidth)) || (1 != wearWidth) || (511 != wearHist[1]) || (1 != wearHist[3]) ) {
+        printf("ERROR:%s:sfm_wear_hist\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( SFM_OK != sfm_wear_dump(&spiFlash, NULL, 4) ) {
+        printf("ERROR:%s:sfm_wear_dump\n", __FUNCTION__);
+        goto ERO_END;
+    }
+
+#if SFM_TRACE
+    /* trace: Write Enable, Page Program, Read Status Register and Read Data with data phase */
+    printf("INFO:%s: sfm_trace_open/sfm_trace_close\n", __FUNCTION__);
+    if ( SFM_OK != sfm_trace_open(&spiFlash, "./flash.trc", 0, SFM_TRACE_HASH | SFM_TRACE_DATA) ) {
+        printf("ERROR:%s:sfm_trace_open\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm(&spiFlash, (uint8_t*) memcpy(spi, "\x06", 1), 1);
+    sfm(&spiFlash, (uint8_t*) memcpy(spi, "\x02\x00\x32\x00\x11\x22\x33\x44", 8), 8);
+    sfm(&spiFlash, (uint8_t*) memcpy(spi, "\x05\x00", 2), 2);
+    sfm_time_next(&spiFlash);
+    sfm(&spiFlash, (uint8_t*) memcpy(spi, "\x03\x00\x32\x00\x00\x00\x00\x00", 8), 8);
+    if ( (SFM_OK != sfm_trace_close(&spiFlash)) || (NULL != spiFlash.trace) ) {
+        printf("ERROR:%s:sfm_trace_close\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    fp = fopen("./flash.trc", "rb");
+    if ( (NULL == fp) || (1 != fread(&traceHdr, sizeof(traceHdr), 1, fp)) || (0 != memcmp(traceHdr.charMagic, "SFMTRACE", 8))
+         || (sizeof(t_sfm_trace_rec) != traceHdr.uint32RecByte) || (0 != strcmp("W25Q16JV", traceHdr.charFlash)) ) {
+        printf("ERROR:%s:sfm_trace: file header\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    for ( uint32_t i = 0; i < 4; i++ ) {
+        if ( (1 != fread(&traceRec, sizeof(traceRec), 1, fp)) || (i != traceRec.uint32Seq) || (SFM_OK != traceRec.uint16Ret)
+             || (((traceRec.uint32Data + 7) & ~7U) != fread(spi, 1, (traceRec.uint32Data + 7) & ~7U, fp)) ) {
+            printf("ERROR:%s:sfm_trace: record %u\n", __FUNCTION__, i);
+            goto ERO_END;
+        }
+    }
+    fclose(fp);
+    remove("./flash.trc");
+    if ( (0x03 != traceRec.uint8Ist) || (0x3200 != traceRec.uint32Adr) || (8 != traceRec.uint32Len) || (4 != traceRec.uint32Data)
+         || (0 != memcmp(spi, "\x11\x22\x33\x44", 4)) || (sfm_trace_hash(spi, 4) != traceRec.uint32Hash) ) {
+        printf("ERROR:%s:sfm_trace: read data\n", __FUNCTION__);
+        goto ERO_END;
+    }
+#endif
+    sfm_free(&spiFlash);
+
+    /* sfm_W25Q16JV: specialized entry point matches sfm */
+    printf("INFO:%s: sfm_W25Q16JV\n", __FUNCTION__);
+    if ( (0 != sfm_init(&spiFlash, "W25Q16JV")) || (0 != sfm_init_sparse(&spiFlashRef, "W25Q16JV")) ) {
+        printf("ERROR:%s:sfm_init\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    {
+        const char* pkts[] = {  // length prefixed packets
+            "\x01\x06", "\x0c\x02\x1f\xf0\xfc\x11\x22\x33\x44\x55\x66\x77\x88", "\x02\x05\x00", "\x02\x05\x00", "\x02\x05\x00", "\x02\x05\x00",
+            "\x08\x03\x1f\xf0\xfc\x00\x00\x00\x00", "\x08\x03\x1f\xff\xfe\x00\x00\x00\x00", "\x03\x03\x00\x00", "\x02\x06\x00",
+            "\x01\x04", "\x03\x05\x00\x00", "\x06\x90\x00\x00\x00\x00\x00", "\x01\xa5", "\x01\x06", "\x05\x02\xff\xf0\xfc\x00", "\x02\x05\x00", "\x02\x05\x00", "\x02\x05\x00",
+            "\x08\x03\x1f\xf0\xfc\x00\x00\x00\x00"
+        };
+        uint8_t spiRef[16];     // reference packet
+        for ( uint32_t i = 0; i < sizeof(pkts)/sizeof(pkts[0]); i++ ) {
+            spiLen = (uint8_t) pkts[i][0];
+            memcpy(spi, pkts[i] + 1, spiLen);
+            memcpy(spiRef, pkts[i] + 1, spiLen);
+            if ( (sfm(&spiFlashRef, spiRef, spiLen) != sfm_W25Q16JV(&spiFlash, spi, spiLen)) || (0 != memcmp(spi, spiRef, spiLen)) ) {
+                printf("ERROR:%s:sfm_W25Q16JV: packet %u\n", __FUNCTION__, i);
+                goto ERO_END;
+            }
+        }
+    }
+    if ( (0 != memcmp(spi, "\x00\x00\x00\x00\x00\x22\x33\x44", 8)) || (sfm_bus_ns(&spiFlash) != sfm_bus_ns(&spiFlashRef)) ) {
+        printf("ERROR:%s:sfm_W25Q16JV: state\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_free(&spiFlash);
+    sfm_free(&spiFlashRef);
+
+    /* part catalog: lookup by ID, parts from file */
+    printf("INFO:%s: sfm_catalog_id/sfm_catalog_load\n", __FUNCTION__);
+    if ( (NULL == sfm_catalog_id((const uint8_t*) "\xef\x14", 2)) || (0 != strcmp("W25Q16JV", sfm_catalog_id((const uint8_t*) "\xef\x14", 2)))
+         || (NULL != sfm_catalog_id((const uint8_t*) "\xef\x16", 2)) || (SFM_E_NO_FLASH != sfm_init(&spiFlash, "W25Q64JV")) ) {
+        printf("ERROR:%s:sfm_catalog_id: compiled in parts\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (SFM_E_ACCESS != sfm_catalog_load("./test/not_existing.txt")) || (SFM_OK != sfm_catalog_load("./test/spi_flash_parts.txt")) ) {
+        printf("ERROR:%s:sfm_catalog_load\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (0 != sfm_init(&spiFlash, sfm_catalog_id((const uint8_t*) "\xef\x16", 2))) || (8388608 != spiFlash.flashType->uint32FlashTopoTotalSizeByte) ) {
+        printf("ERROR:%s:sfm_init: loaded part\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    memcpy(spi, "\x90\x00\x00\x00\x00\x00", 6);
+    if ( (0 != sfm(&spiFlash, spi, 6)) || (0 != memcmp(spi + 4, "\xef\x16", 2)) ) {
+        printf("ERROR:%s:sfm: loaded part ID\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_free(&spiFlash);
+    /* IDs longer than five bytes, over-long ID is a malformed line */
+    fp = fopen("./flash_parts.txt", "w");
+    if ( NULL == fp ) {
+        printf("ERROR:%s:sfm_catalog_load: open file\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    fprintf(fp, "LONGID ef4015aabbcc 0x90 0x06 0x04 0xc7 0x20 0x05 0x03 0x02 0 0 0 0 0 0 0 0 0 0 0 3 4096 65536 256 2097152 3 8 4 0x01 0x02 400 45000 150000 5000000\n");
+    fclose(fp);
+    if ( (SFM_OK != sfm_catalog_load("./flash_parts.txt")) || (NULL == sfm_catalog_id((const uint8_t*) "\xef\x40\x15\xaa\xbb\xcc", 6))
+         || (0 != strcmp("LONGID", sfm_catalog_id((const uint8_t*) "\xef\x40\x15\xaa\xbb\xcc", 6))) ) {
+        printf("ERROR:%s:sfm_catalog_load: long ID\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    fp = fopen("./flash_parts.txt", "w");
+    if ( NULL == fp ) {
+        printf("ERROR:%s:sfm_catalog_load: open file\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    fprintf(fp, "LONGID2 ef4015aabbccddeeff00 0x90 0x06 0x04 0xc7 0x20 0x05 0x03 0x02 0 0 0 0 0 0 0 0 0 0 0 3 4096 65536 256 2097152 3 8 4 0x01 0x02 400 45000 150000 5000000\n");
+    fclose(fp);
+    if ( (SFM_E_ACCESS != sfm_catalog_load("./flash_parts.txt")) || (SFM_E_NO_FLASH != sfm_init(&spiFlash, "LONGID2")) ) {
+        printf("ERROR:%s:sfm_catalog_load: over-long ID\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    remove("./flash_parts.txt");
+
+    /* 4-byte addressing, 1 Gbit part with sparse sectors */
+    printf("INFO:%s: 4-Byte Address Mode\n", __FUNCTION__);
+    if ( (0 != sfm_init(&spiFlash, "W25Q01JV")) || (NULL != spiFlash.uint8PtrMem) || (0 != spiFlash.uint32SectorAlloc) ) {
+        printf("ERROR:%s:sfm_init: large part\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (0 != sfm_mem_usage(&spiFlash, &memUsed)) || (memUsed > 1024*1024) ) {
+        printf("ERROR:%s:sfm_mem_usage: large part, used=%zu\n", __FUNCTION__, memUsed);
+        goto ERO_END;
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+    memcpy(spi, "\x12\x07\xff\xff\xf0\x11\x22\x33\x44", 9);
+    if ( 0 != sfm(&spiFlash, spi, 9) ) {
+        printf("ERROR:%s:sfm: page program 4-byte address\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x05\x00", NULL, 2);
+    }
+    memcpy(spi, "\x13\x07\xff\xff\xf0\x00\x00\x00\x00", 9);
+    sfm(&spiFlash, spi, 9);
+    memcpy(spi + 16, "\x03\xff\xff\xf0\x00", 5);    // 3-byte address mode, lower 16 MiB
+    sfm(&spiFlash, spi + 16, 5);
+    if ( (0 != memcmp(spi + 5, "\x11\x22\x33\x44", 4)) || (0xff != spi[20]) || (1 != spiFlash.uint32SectorAlloc) ) {
+        printf("ERROR:%s:sfm: read data 4-byte address\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    if ( (0 != sfm_store(&spiFlash, "./flash_4b.dif")) || (0 != sfm_cmp(&spiFlash, "./flash_4b.dif")) ) {
+        printf("ERROR:%s:sfm_store: 4-byte address\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    fp = fopen("./flash_4b.dif", "r");
+    if ( (NULL == fp) || (-1 == getline(&line, &len, fp)) || (0 != strcasecmp(line, "7fffff0: 11 22 33 44 ff ff ff ff ff ff ff ff ff ff ff ff\n")) ) {
+        printf("ERROR:%s:sfm_store: 4-byte address line\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    fclose(fp);
+    remove("./flash_4b.dif");
+    if ( (0 != sfm_dump(&spiFlash, 0x7fffff0, UINT32_MAX)) || (SFM_E_ACCESS != sfm_dump(&spiFlash, 0x8000000, UINT32_MAX)) ) {
+        printf("ERROR:%s:sfm_dump: 4-byte address\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    memcpy(spi, "\xb7\x00", 2);
+    if ( (SFM_E_IST_FLASH != sfm(&spiFlash, spi, 2)) || (0 != sfm(&spiFlash, spi, 1)) ) {
+        printf("ERROR:%s:sfm: enter 4-byte address mode\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    memcpy(spi, "\x03\x07\xff\xff\xf1\x00\x00", 7);
+    sfm(&spiFlash, spi, 7);
+    memcpy(spi + 16, "\xeb\x07\xff\xff\xf2\x00\x00\x00\x00", 9);    // mode byte and 4 dummy clocks
+    sfm(&spiFlash, spi + 16, 9);
+    if ( (0 != memcmp(spi + 5, "\x22\x33", 2)) || (0x33 != spi[24]) ) {
+        printf("ERROR:%s:sfm: read data in 4-byte address mode\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+    memcpy(spi, "\x02\x04\x00\x10\x00\x55", 6);
+    sfm(&spiFlash, spi, 6);
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x05\x00", NULL, 2);
+    }
+    memcpy(spi, "\xe9", 1);
+    sfm(&spiFlash, spi, 1);
+    memcpy(spi, "\x13\x04\x00\x10\x00\x00", 6);
+    sfm(&spiFlash, spi, 6);
+    if ( (0x55 != spi[5]) || (4 != spiFlash.desc.uint32AdrIstLen) ) {
+        printf("ERROR:%s:sfm: exit 4-byte address mode\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+    memcpy(spi, "\xdc\x04\x00\xff\xff", 5);    // 64 KiB block
+    if ( 0 != sfm(&spiFlash, spi, 5) ) {
+        printf("ERROR:%s:sfm: block erase 4-byte address\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    for ( uint8_t i = 0; i < SFM_WIP_RETRY_IDLE; i++ ) {
+        sfm_xfer(&spiFlash, (const uint8_t*) "\x05\x00", NULL, 2);
+    }
+    memcpy(spi, "\x13\x04\x00\x10\x00\x00", 6);
+    sfm(&spiFlash, spi, 6);
+    if ( (0xff != spi[5]) || (1 != spiFlash.wear.uint32PtrErase[0x4000]) || (1 != spiFlash.wear.uint32PtrErase[0x400f]) || (0 != spiFlash.wear.uint32PtrErase[0x4010]) ) {
+        printf("ERROR:%s:sfm: block erase 4-byte address, erased\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_xfer(&spiFlash, (const uint8_t*) "\x06", NULL, 1);
+    memcpy(spi, "\x21\x07\xff\xf0\x00", 5);
+    if ( (0 != sfm(&spiFlash, spi, 5)) || (SFM_OK != sfm_blank_check(&spiFlash, 0x7fff000, 0x1000, NULL)) ) {
+        printf("ERROR:%s:sfm: sector erase 4-byte address\n", __FUNCTION__);
+        goto ERO_END;
+    }
+    sfm_free(&spiFlash);
+
     /* graceful end */
     printf("INFO:%s: Module test SUCCESSFUL :-)\n", __FUNCTION__);
     exit(EXIT_SUCCESS);